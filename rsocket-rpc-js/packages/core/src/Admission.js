@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {ISubscription} from 'rsocket-types';
+
+import {Flowable, Single} from 'rsocket-flowable';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+
+export type Call = {
+  start: () => void,
+  cancelled: boolean,
+};
+
+/**
+ * Decides when calls start: admit() starts a call at once or once there is
+ * room for it, withdraw() drops a call waiting to start, and release() frees
+ * the room of a call that ended. Used by PriorityScheduler and RateLimiter.
+ */
+export type Gate = {
+  admit: (call: Call) => void,
+  withdraw: (call: Call) => void,
+  release: () => void,
+};
+
+/**
+ * Subscribes to the Single returned by `source` once `gate` admits it, and
+ * releases it once it ends or is cancelled
+ */
+export function admitSingle<T>(gate: Gate, source: () => Single<T>): Single<T> {
+  return new Single(subscriber => {
+    let cancel = null;
+    let done = false;
+    const end = () => {
+      if (!done) {
+        done = true;
+        gate.release();
+      }
+    };
+    const call = {
+      cancelled: false,
+      start: () => {
+        let single;
+        try {
+          single = source();
+        } catch (error) {
+          end();
+          subscriber.onError(error);
+          return;
+        }
+        single.subscribe({
+          onComplete: value => {
+            end();
+            subscriber.onComplete(value);
+          },
+          onError: error => {
+            end();
+            subscriber.onError(error);
+          },
+          onSubscribe: _cancel => {
+            cancel = _cancel;
+            // Cancelled once started, before the source could be cancelled
+            if (call.cancelled) {
+              _cancel && _cancel();
+              end();
+            }
+          },
+        });
+      },
+    };
+    subscriber.onSubscribe(() => {
+      if (call.cancelled) {
+        return;
+      }
+      call.cancelled = true;
+      if (cancel) {
+        cancel();
+        end();
+      } else {
+        gate.withdraw(call);
+      }
+    });
+    // Cancelled as the caller subscribed
+    if (!call.cancelled) {
+      gate.admit(call);
+    }
+  });
+}
+
+/**
+ * Subscribes to the Flowable returned by `source` once `gate` admits it,
+ * passing on the demand requested until then, and releases it once it ends
+ * or is cancelled
+ */
+export function admitFlowable<T>(
+  gate: Gate,
+  source: () => Flowable<T>,
+): Flowable<T> {
+  return new Flowable(subscriber => {
+    let subscription: ?ISubscription = null;
+    let requested = 0;
+    let done = false;
+    const end = () => {
+      if (!done) {
+        done = true;
+        gate.release();
+      }
+    };
+    const call = {
+      cancelled: false,
+      start: () => {
+        let flowable;
+        try {
+          flowable = source();
+        } catch (error) {
+          end();
+          subscriber.onError(error);
+          return;
+        }
+        flowable.subscribe({
+          onComplete: () => {
+            end();
+            subscriber.onComplete();
+          },
+          onError: error => {
+            end();
+            subscriber.onError(error);
+          },
+          onNext: value => subscriber.onNext(value),
+          onSubscribe: _subscription => {
+            subscription = _subscription;
+            if (call.cancelled) {
+              _subscription.cancel();
+              end();
+            } else if (requested > 0) {
+              _subscription.request(requested);
+            }
+          },
+        });
+      },
+    };
+    subscriber.onSubscribe({
+      cancel: () => {
+        if (call.cancelled) {
+          return;
+        }
+        call.cancelled = true;
+        if (subscription) {
+          subscription.cancel();
+          end();
+        } else {
+          gate.withdraw(call);
+        }
+      },
+      request: n => {
+        if (subscription) {
+          subscription.request(n);
+        } else {
+          requested = Math.min(requested + n, MAX_REQUEST_N);
+        }
+      },
+    });
+    if (!call.cancelled) {
+      gate.admit(call);
+    }
+  });
+}
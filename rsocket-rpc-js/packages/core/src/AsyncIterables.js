@@ -0,0 +1,254 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+
+'use strict';
+
+/* eslint-disable no-bitwise */
+
+import {Flowable} from 'rsocket-flowable';
+import type {ISubscriber, ISubscription} from 'rsocket-types';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+// Items an async iterator over a stream requests ahead of being consumed
+const DEFAULT_PREFETCH = 32;
+// Runtimes without async iteration get the symbol polyfills register
+const ASYNC_ITERATOR: any =
+  (Symbol: any).asyncIterator || Symbol.for('Symbol.asyncIterator');
+
+/**
+ * Returns what a stream or channel handler returned as a Flowable. Flowables
+ * are returned as they are; async iterables, e.g. those of an
+ * `async function*`, are pulled an item at a time while there is demand, so
+ * that a handler produces no more than has been requested.
+ */
+export function toFlowable<T>(result: any): Flowable<T> {
+  if (result && typeof result.subscribe === 'function') {
+    return result;
+  }
+  if (result && typeof result[ASYNC_ITERATOR] === 'function') {
+    return new Flowable(subscriber => {
+      const subscription = new AsyncIterableSubscription(
+        result[ASYNC_ITERATOR](),
+        subscriber,
+      );
+      subscriber.onSubscribe(subscription);
+    });
+  }
+  return Flowable.error(
+    new Error('Expected a Flowable or an async iterable, got ' + result),
+  );
+}
+
+/**
+ * Makes a Flowable async iterable too, so that it can be consumed with
+ * `for await`. Each iteration subscribes anew, requesting `prefetch` items
+ * ahead and three quarters of them again whenever as many have been consumed.
+ * Breaking out of the loop cancels the subscription.
+ */
+export function withAsyncIterator<T>(
+  flowable: Flowable<T>,
+  prefetch?: number,
+): Flowable<T> {
+  (flowable: any)[ASYNC_ITERATOR] = () =>
+    new FlowableAsyncIterator(flowable, prefetch || DEFAULT_PREFETCH);
+  return flowable;
+}
+
+class AsyncIterableSubscription<T> implements ISubscription {
+  _iterator: any;
+  _subscriber: ISubscriber<T>;
+  _requested: number;
+  _pulling: boolean;
+  _cancelled: boolean;
+
+  constructor(iterator: any, subscriber: ISubscriber<T>) {
+    this._iterator = iterator;
+    this._subscriber = subscriber;
+    this._requested = 0;
+    this._pulling = false;
+    this._cancelled = false;
+  }
+
+  request(n: number) {
+    this._requested = Math.min(this._requested + n, MAX_REQUEST_N);
+    this._pull();
+  }
+
+  cancel() {
+    if (this._cancelled) {
+      return;
+    }
+    this._cancelled = true;
+    if (typeof this._iterator.return === 'function') {
+      Promise.resolve(this._iterator.return()).catch(() => {});
+    }
+  }
+
+  // Asks the iterator for one item at a time, and only while it is wanted
+  _pull() {
+    if (this._pulling || this._cancelled || this._requested === 0) {
+      return;
+    }
+    this._pulling = true;
+    let next;
+    try {
+      next = Promise.resolve(this._iterator.next());
+    } catch (error) {
+      next = Promise.reject(error);
+    }
+    next.then(
+      result => {
+        this._pulling = false;
+        if (this._cancelled) {
+          return;
+        }
+        if (result.done) {
+          this._cancelled = true;
+          this._subscriber.onComplete();
+          return;
+        }
+        if (this._requested < MAX_REQUEST_N) {
+          this._requested--;
+        }
+        this._subscriber.onNext(result.value);
+        this._pull();
+      },
+      error => {
+        this._pulling = false;
+        if (!this._cancelled) {
+          this._cancelled = true;
+          this._subscriber.onError(error);
+        }
+      },
+    );
+  }
+}
+
+type IteratorResult<T> = {value: T | void, done: boolean};
+type PendingNext<T> = {
+  resolve: (result: IteratorResult<T>) => void,
+  reject: (error: Error) => void,
+};
+
+class FlowableAsyncIterator<T> implements ISubscriber<T> {
+  _flowable: Flowable<T>;
+  _prefetch: number;
+  _limit: number;
+  _subscription: ?ISubscription;
+  _queue: T[];
+  _consumed: number;
+  _done: boolean;
+  _error: ?Error;
+  _pending: ?PendingNext<T>;
+
+  constructor(flowable: Flowable<T>, prefetch: number) {
+    this._flowable = flowable;
+    this._prefetch = prefetch;
+    this._limit = Math.max(1, prefetch - (prefetch >> 2));
+    this._subscription = null;
+    this._queue = [];
+    this._consumed = 0;
+    this._done = false;
+    this._error = null;
+    this._pending = null;
+    (this: any)[ASYNC_ITERATOR] = () => this;
+  }
+
+  next(): Promise<IteratorResult<T>> {
+    if (!this._subscription && !this._done) {
+      this._flowable.subscribe(this);
+    }
+    if (this._queue.length > 0) {
+      const value = this._queue.shift();
+      this._consume();
+      return Promise.resolve({value, done: false});
+    }
+    const error = this._error;
+    if (error) {
+      this._error = null;
+      return Promise.reject(error);
+    }
+    if (this._done) {
+      return Promise.resolve({value: undefined, done: true});
+    }
+    return new Promise((resolve, reject) => {
+      this._pending = {reject, resolve};
+    });
+  }
+
+  return(): Promise<IteratorResult<T>> {
+    if (!this._done) {
+      this._done = true;
+      this._queue = [];
+      this._subscription && this._subscription.cancel();
+    }
+    const pending = this._pending;
+    if (pending) {
+      this._pending = null;
+      pending.resolve({value: undefined, done: true});
+    }
+    return Promise.resolve({value: undefined, done: true});
+  }
+
+  onSubscribe(subscription: ISubscription) {
+    this._subscription = subscription;
+    if (this._done) {
+      subscription.cancel();
+      return;
+    }
+    subscription.request(this._prefetch);
+  }
+
+  onNext(value: T) {
+    const pending = this._pending;
+    if (pending) {
+      this._pending = null;
+      pending.resolve({value, done: false});
+      this._consume();
+    } else {
+      this._queue.push(value);
+    }
+  }
+
+  onError(error: Error) {
+    this._done = true;
+    const pending = this._pending;
+    if (pending) {
+      this._pending = null;
+      pending.reject(error);
+    } else {
+      this._error = error;
+    }
+  }
+
+  onComplete() {
+    this._done = true;
+    const pending = this._pending;
+    if (pending) {
+      this._pending = null;
+      pending.resolve({value: undefined, done: true});
+    }
+  }
+
+  // Requests more once enough of what was requested has been consumed
+  _consume() {
+    if (!this._done && ++this._consumed === this._limit) {
+      this._consumed = 0;
+      this._subscription && this._subscription.request(this._limit);
+    }
+  }
+}
@@ -0,0 +1,560 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+
+'use strict';
+
+/* eslint-disable no-bitwise */
+
+import type {ISubscriber, ISubscription, Payload} from 'rsocket-types';
+
+import {MAX_VARINT_SIZE, readVarint, writeVarint} from 'rsocket-rpc-frames';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+// Fragments requested at a time while reading chunked payloads
+const CHUNK_PREFETCH = 8;
+// Most bytes a chunked payload read from a peer may hold, unless configured
+export const DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+
+/**
+ * Returns a function to lift() a stream of payloads with, which splits each
+ * of them into fragments of at most `chunkSize` bytes, for methods declared
+ * with the `chunked` option. The first fragment of a payload starts with its
+ * length as a varint. Payloads are requested one at a time and demand is
+ * counted in fragments, so a large message is sent at the pace it is read
+ * rather than buffered whole by the transport. Metadata is dropped.
+ */
+export function chunkPayloads<D, M>(
+  chunkSize: number,
+): (ISubscriber<Payload<Buffer, M>>) => ISubscriber<Payload<D, M>> {
+  return subscriber => new ChunkingSubscriber(subscriber, chunkSize);
+}
+
+/**
+ * Returns a function to lift() a stream of fragments with, which joins them
+ * into the payloads they were split from, counting demand in payloads. Each
+ * payload is copied once, into a buffer of its length, as its fragments
+ * arrive. A payload declared longer than `maxBytes` fails the stream before
+ * anything is allocated for it.
+ */
+export function joinChunks<M>(
+  maxBytes?: number = DEFAULT_MAX_BYTES,
+): (ISubscriber<Payload<Buffer, M>>) => ISubscriber<Payload<any, M>> {
+  return subscriber => new ChunkReader(subscriber, new ChunkJoiner(maxBytes));
+}
+
+/**
+ * Returns a function to lift() a stream of fragments with, which emits the
+ * encoded elements of a repeated message field, the one numbered
+ * `fieldNumber`, of each chunked message as soon as they have arrived. The
+ * messages themselves are never assembled, so a response much larger than
+ * the heap can be processed an element at a time. An element declared longer
+ * than `maxBytes`, or than its message, fails the stream.
+ */
+export function repeatedField<M>(
+  fieldNumber: number,
+  maxBytes?: number = DEFAULT_MAX_BYTES,
+): (ISubscriber<Payload<Buffer, M>>) => ISubscriber<Payload<any, M>> {
+  return subscriber =>
+    new ChunkReader(
+      subscriber,
+      new RepeatedFieldReader(fieldNumber, maxBytes),
+    );
+}
+
+class ChunkingSubscriber<D, M>
+  implements ISubscriber<Payload<D, M>>, ISubscription {
+  _actual: ISubscriber<Payload<Buffer, M>>;
+  _subscription: ?ISubscription;
+  _chunkSize: number;
+  _data: ?Buffer;
+  _offset: number;
+  _requested: number;
+  _outstanding: boolean;
+  _done: boolean;
+  _error: ?Error;
+  _cancelled: boolean;
+  _wip: number;
+
+  constructor(actual: ISubscriber<Payload<Buffer, M>>, chunkSize: number) {
+    this._actual = actual;
+    this._subscription = null;
+    this._chunkSize = chunkSize;
+    this._data = null;
+    this._offset = 0;
+    this._requested = 0;
+    this._outstanding = false;
+    this._done = false;
+    this._error = null;
+    this._cancelled = false;
+    this._wip = 0;
+  }
+
+  onSubscribe(subscription: ISubscription) {
+    this._subscription = subscription;
+    this._actual.onSubscribe(this);
+  }
+
+  onNext(payload: Payload<D, M>) {
+    if (this._cancelled) {
+      return;
+    }
+    this._outstanding = false;
+    this._data = toBuffer(payload.data);
+    // Until the first fragment, which carries the length, is sent
+    this._offset = -1;
+    this._drain();
+  }
+
+  onError(error: Error) {
+    this._error = error;
+    this._done = true;
+    this._drain();
+  }
+
+  onComplete() {
+    this._done = true;
+    this._drain();
+  }
+
+  request(n: number) {
+    this._requested = Math.min(this._requested + n, MAX_REQUEST_N);
+    this._drain();
+  }
+
+  cancel() {
+    this._cancelled = true;
+    this._data = null;
+    this._subscription && this._subscription.cancel();
+  }
+
+  _drain() {
+    if (this._wip++ !== 0) {
+      return;
+    }
+    let missed = 1;
+    for (;;) {
+      if (this._cancelled) {
+        return;
+      }
+      if (this._error) {
+        this._cancelled = true;
+        this._actual.onError(this._error);
+        return;
+      }
+      while (this._requested > 0 && this._data) {
+        if (this._cancelled) {
+          return;
+        }
+        if (this._requested < MAX_REQUEST_N) {
+          this._requested--;
+        }
+        this._actual.onNext({
+          data: this._nextFragment(this._data),
+          metadata: (Buffer.alloc(0): any),
+        });
+      }
+      if (this._cancelled) {
+        return;
+      }
+      if (this._done && !this._data) {
+        this._cancelled = true;
+        this._actual.onComplete();
+        return;
+      }
+      // The next payload is only requested once this one is sent
+      if (
+        !this._done &&
+        !this._data &&
+        !this._outstanding &&
+        this._requested > 0 &&
+        this._subscription
+      ) {
+        this._outstanding = true;
+        this._subscription.request(1);
+      }
+      missed = this._wip -= missed;
+      if (missed === 0) {
+        return;
+      }
+    }
+  }
+
+  _nextFragment(data: Buffer): Buffer {
+    const chunkSize = this._chunkSize;
+    let fragment;
+    if (this._offset < 0) {
+      const end = Math.min(data.length, chunkSize);
+      fragment = Buffer.allocUnsafe(MAX_VARINT_SIZE + end);
+      const start = writeVarint(fragment, data.length, 0);
+      data.copy(fragment, start, 0, end);
+      fragment = fragment.slice(0, start + end);
+      this._offset = end;
+    } else {
+      const end = Math.min(data.length, this._offset + chunkSize);
+      fragment = data.slice(this._offset, end);
+      this._offset = end;
+    }
+    if (this._offset >= data.length) {
+      this._data = null;
+    }
+    return fragment;
+  }
+}
+
+/**
+ * Turns fragments into the payloads they are read as
+ */
+interface ChunkDecoder {
+  // Reads a fragment, passing each payload it completes to `emit`
+  write(fragment: Buffer, emit: (data: Buffer) => void): void;
+  // Whether a payload has been read in part
+  partial(): boolean;
+}
+
+class ChunkReader<M> implements ISubscriber<Payload<any, M>>, ISubscription {
+  _actual: ISubscriber<Payload<Buffer, M>>;
+  _decoder: ChunkDecoder;
+  _subscription: ?ISubscription;
+  _queue: Buffer[];
+  _metadata: ?M;
+  _requested: number;
+  _outstanding: number;
+  _unbounded: boolean;
+  _done: boolean;
+  _error: ?Error;
+  _cancelled: boolean;
+  _wip: number;
+
+  constructor(actual: ISubscriber<Payload<Buffer, M>>, decoder: ChunkDecoder) {
+    this._actual = actual;
+    this._decoder = decoder;
+    this._subscription = null;
+    this._queue = [];
+    this._metadata = null;
+    this._requested = 0;
+    this._outstanding = 0;
+    this._unbounded = false;
+    this._done = false;
+    this._error = null;
+    this._cancelled = false;
+    this._wip = 0;
+  }
+
+  onSubscribe(subscription: ISubscription) {
+    this._subscription = subscription;
+    this._actual.onSubscribe(this);
+  }
+
+  onNext(payload: Payload<any, M>) {
+    if (this._done || this._cancelled) {
+      return;
+    }
+    this._outstanding--;
+    this._metadata = payload.metadata;
+    try {
+      this._decoder.write(toBuffer(payload.data), data =>
+        this._queue.push(data),
+      );
+    } catch (error) {
+      this._subscription && this._subscription.cancel();
+      this.onError(error);
+      return;
+    }
+    this._drain();
+  }
+
+  onError(error: Error) {
+    this._error = error;
+    this._done = true;
+    this._drain();
+  }
+
+  onComplete() {
+    if (this._decoder.partial()) {
+      this.onError(new Error('Stream ended within a chunked payload'));
+      return;
+    }
+    this._done = true;
+    this._drain();
+  }
+
+  request(n: number) {
+    this._requested = Math.min(this._requested + n, MAX_REQUEST_N);
+    this._drain();
+  }
+
+  cancel() {
+    this._cancelled = true;
+    this._queue = [];
+    this._subscription && this._subscription.cancel();
+  }
+
+  _drain() {
+    if (this._wip++ !== 0) {
+      return;
+    }
+    let missed = 1;
+    for (;;) {
+      const queue = this._queue;
+      while (this._requested > 0 && queue.length > 0) {
+        if (this._cancelled) {
+          return;
+        }
+        if (this._requested < MAX_REQUEST_N) {
+          this._requested--;
+        }
+        this._actual.onNext({
+          data: queue.shift(),
+          metadata: (this._metadata: any),
+        });
+      }
+      if (this._cancelled) {
+        return;
+      }
+      if (this._done && (this._error || queue.length === 0)) {
+        this._cancelled = true;
+        const error = this._error;
+        error ? this._actual.onError(error) : this._actual.onComplete();
+        return;
+      }
+      // A stream wanting everything gets every fragment as it comes,
+      // otherwise a few more are requested once those read are used up
+      const subscription = this._subscription;
+      if (subscription && !this._done && !this._unbounded) {
+        if (this._requested >= MAX_REQUEST_N) {
+          this._unbounded = true;
+          subscription.request(MAX_REQUEST_N);
+        } else if (
+          this._requested > 0 &&
+          queue.length === 0 &&
+          this._outstanding <= 0
+        ) {
+          this._outstanding = CHUNK_PREFETCH;
+          subscription.request(CHUNK_PREFETCH);
+        }
+      }
+      missed = this._wip -= missed;
+      if (missed === 0) {
+        return;
+      }
+    }
+  }
+}
+
+class ChunkJoiner implements ChunkDecoder {
+  _maxBytes: number;
+  _data: ?Buffer;
+  _offset: number;
+  _cursor: {offset: number};
+
+  constructor(maxBytes: number) {
+    this._maxBytes = maxBytes;
+    this._data = null;
+    this._offset = 0;
+    this._cursor = {offset: 0};
+  }
+
+  write(fragment: Buffer, emit: (data: Buffer) => void): void {
+    const cursor = this._cursor;
+    cursor.offset = 0;
+    while (cursor.offset < fragment.length) {
+      let data = this._data;
+      if (!data) {
+        const length = readVarint(fragment, cursor);
+        if (length < 0) {
+          throw new Error('Malformed chunked payload');
+        }
+        if (length > this._maxBytes) {
+          throw new Error(
+            'Chunked payload of ' + length + ' bytes exceeds ' + this._maxBytes,
+          );
+        }
+        // A payload that fits in its first fragment is not copied
+        if (fragment.length - cursor.offset >= length) {
+          emit(fragment.slice(cursor.offset, cursor.offset + length));
+          cursor.offset += length;
+          continue;
+        }
+        data = this._data = Buffer.allocUnsafe(length);
+        this._offset = 0;
+      }
+      const copied = fragment.copy(data, this._offset, cursor.offset);
+      cursor.offset += copied;
+      this._offset += copied;
+      if (this._offset === data.length) {
+        this._data = null;
+        emit(data);
+      }
+    }
+  }
+
+  partial(): boolean {
+    return this._data != null;
+  }
+}
+
+// What RepeatedFieldReader reads next
+const MESSAGE_LENGTH = 0;
+const TAG = 1;
+const VARINT = 2;
+const FIELD_LENGTH = 3;
+const SKIP = 4;
+const ELEMENT = 5;
+
+// Protobuf wire types
+const WIRE_VARINT = 0;
+const WIRE_FIXED64 = 1;
+const WIRE_LENGTH_DELIMITED = 2;
+const WIRE_FIXED32 = 5;
+
+/**
+ * Walks the top-level fields of chunked protobuf messages across fragment
+ * boundaries, emitting the elements of one repeated field and skipping the
+ * others
+ */
+class RepeatedFieldReader implements ChunkDecoder {
+  _fieldNumber: number;
+  _maxBytes: number;
+  _state: number;
+  // Bytes of the current message not read yet
+  _remaining: number;
+  _value: number;
+  _shift: number;
+  _selected: boolean;
+  _skip: number;
+  _element: ?Buffer;
+  _offset: number;
+
+  constructor(fieldNumber: number, maxBytes: number) {
+    this._fieldNumber = fieldNumber;
+    this._maxBytes = maxBytes;
+    this._state = MESSAGE_LENGTH;
+    this._remaining = 0;
+    this._value = 0;
+    this._shift = 0;
+    this._selected = false;
+    this._skip = 0;
+    this._element = null;
+    this._offset = 0;
+  }
+
+  write(fragment: Buffer, emit: (data: Buffer) => void): void {
+    let offset = 0;
+    while (offset < fragment.length) {
+      const state = this._state;
+      if (state === SKIP) {
+        const skipped = Math.min(this._skip, fragment.length - offset);
+        offset += skipped;
+        this._skip -= skipped;
+        this._remaining -= skipped;
+        if (this._skip === 0) {
+          this._nextField();
+        }
+      } else if (state === ELEMENT) {
+        let element = this._element;
+        const available = fragment.length - offset;
+        // An element that is whole in this fragment is not copied
+        if (!element && available >= this._skip) {
+          emit(fragment.slice(offset, offset + this._skip));
+          offset += this._skip;
+          this._remaining -= this._skip;
+          this._nextField();
+          continue;
+        }
+        if (!element) {
+          element = this._element = Buffer.allocUnsafe(this._skip);
+          this._offset = 0;
+        }
+        const copied = fragment.copy(element, this._offset, offset);
+        offset += copied;
+        this._offset += copied;
+        this._remaining -= copied;
+        if (this._offset === element.length) {
+          this._element = null;
+          emit(element);
+          this._nextField();
+        }
+      } else {
+        const byte = fragment[offset++];
+        if (state !== MESSAGE_LENGTH) {
+          this._remaining--;
+        }
+        this._value += (byte & 0x7f) * Math.pow(2, this._shift);
+        this._shift += 7;
+        if ((byte & 0x80) === 0) {
+          const value = this._value;
+          this._value = 0;
+          this._shift = 0;
+          this._readVarint(state, value, emit);
+        }
+      }
+    }
+  }
+
+  partial(): boolean {
+    return this._state !== MESSAGE_LENGTH || this._shift > 0;
+  }
+
+  _readVarint(state: number, value: number, emit: (data: Buffer) => void) {
+    if (state === MESSAGE_LENGTH) {
+      this._remaining = value;
+      this._nextField();
+    } else if (state === TAG) {
+      const wireType = value & 7;
+      if (wireType === WIRE_VARINT) {
+        this._state = VARINT;
+      } else if (wireType === WIRE_LENGTH_DELIMITED) {
+        this._selected = Math.floor(value / 8) === this._fieldNumber;
+        this._state = FIELD_LENGTH;
+      } else if (wireType === WIRE_FIXED64 || wireType === WIRE_FIXED32) {
+        this._skip = wireType === WIRE_FIXED64 ? 8 : 4;
+        this._state = SKIP;
+      } else {
+        throw new Error('Unsupported protobuf wire type ' + wireType);
+      }
+    } else if (state === FIELD_LENGTH) {
+      if (value === 0) {
+        this._selected && emit(Buffer.alloc(0));
+        this._nextField();
+      } else {
+        if (value > this._remaining) {
+          throw new Error('Malformed chunked payload');
+        }
+        if (this._selected && value > this._maxBytes) {
+          throw new Error(
+            'Chunked element of ' + value + ' bytes exceeds ' + this._maxBytes,
+          );
+        }
+        this._skip = value;
+        this._state = this._selected ? ELEMENT : SKIP;
+      }
+    } else {
+      this._nextField();
+    }
+  }
+
+  _nextField() {
+    this._state = this._remaining > 0 ? TAG : MESSAGE_LENGTH;
+  }
+}
+
+function toBuffer(data: any): Buffer {
+  if (data == null) {
+    return Buffer.alloc(0);
+  }
+  return Buffer.isBuffer(data) ? data : Buffer.from(data);
+}
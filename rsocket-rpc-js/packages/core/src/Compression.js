@@ -0,0 +1,494 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+/* eslint-disable no-bitwise */
+
+import type {ISubscriber, ISubscription, Payload} from 'rsocket-types';
+
+import {Flowable, Single} from 'rsocket-flowable';
+import {
+  FLAG_DEFLATE,
+  FLAG_GZIP,
+  encodeFlags,
+  getFlags,
+  setFlags,
+} from 'rsocket-rpc-frames';
+
+// Values of the RSocketCompression enum in rsocket/options.proto
+export const COMPRESSION_NONE = 0;
+export const COMPRESSION_DEFLATE = 1;
+export const COMPRESSION_GZIP = 2;
+
+// Most bytes an inbound payload may decompress to, unless configured
+export const DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+
+type Callback = (error: ?Error, result: Buffer) => void;
+type Codec = (data: Buffer, callback: Callback, maxBytes: number) => void;
+
+let zlib = null;
+
+// Loaded on first use so that clients without compressed methods, e.g. in a
+// browser, never pull in zlib
+function getZlib(): Object {
+  if (!zlib) {
+    zlib = require('zlib');
+  }
+  return zlib;
+}
+
+function deflate(data: Buffer, callback: Callback): void {
+  getZlib().deflate(data, callback);
+}
+
+// Peers choose what they send, so decompressed sizes are bounded: zlib fails
+// rather than growing its output past maxOutputLength
+function inflate(data: Buffer, callback: Callback, maxBytes: number): void {
+  getZlib().inflate(data, {maxOutputLength: maxBytes}, callback);
+}
+
+function gzip(data: Buffer, callback: Callback): void {
+  getZlib().gzip(data, callback);
+}
+
+function gunzip(data: Buffer, callback: Callback, maxBytes: number): void {
+  getZlib().gunzip(data, {maxOutputLength: maxBytes}, callback);
+}
+
+function toBuffer(data: any): Buffer {
+  return Buffer.isBuffer(data) ? data : Buffer.from(data);
+}
+
+/**
+ * Compresses outbound and decompresses inbound payloads of a method declared
+ * with the `compression` option. Payloads at least `threshold` bytes long are
+ * compressed with Node's asynchronous zlib functions, so the work happens off
+ * the event loop, and are flagged as such in their metadata. Payloads whose
+ * metadata cannot carry flags, such as version 1 headers, are sent as they
+ * are, which is why the generator requires metadata_version=2 for the
+ * option. Inbound payloads are decompressed according to their flags,
+ * whatever this instance's settings, up to `maxBytes`: those that would grow
+ * past it fail their call.
+ *
+ * Clients compress the request of each call, or the first request of a
+ * channel, whatever its size: its flag tells the server that the client
+ * reads compressed payloads. Servers only compress the responses of calls
+ * whose request was flagged.
+ */
+export default class Compression {
+  _flag: number;
+  _threshold: number;
+  _maxBytes: number;
+
+  constructor(compression: number, threshold: number, maxBytes?: number) {
+    this._flag =
+      compression === COMPRESSION_DEFLATE
+        ? FLAG_DEFLATE
+        : compression === COMPRESSION_GZIP ? FLAG_GZIP : 0;
+    this._threshold = threshold;
+    this._maxBytes = maxBytes || DEFAULT_MAX_BYTES;
+  }
+
+  compressPayload<D, M>(
+    payload: Payload<D, M>,
+    force?: boolean,
+  ): Single<Payload<D, M>> {
+    const data: any = payload.data;
+    if (
+      this._flag === 0 ||
+      data == null ||
+      (!force && data.length < this._threshold)
+    ) {
+      return Single.of(payload);
+    }
+    const metadata: any = payload.metadata;
+    const flagged =
+      metadata && metadata.length > 0
+        ? setFlags(metadata, this._flag)
+        : encodeFlags(this._flag);
+    // Only version 2 headers and empty metadata can be flagged
+    if (!flagged) {
+      return Single.of(payload);
+    }
+    return codecSingle(
+      this._flag === FLAG_GZIP ? gzip : deflate,
+      data,
+      this._maxBytes,
+      compressed => ({
+        data: (compressed: any),
+        metadata: (flagged: any),
+      }),
+    );
+  }
+
+  decompressPayload<D, M>(payload: Payload<D, M>): Single<Payload<D, M>> {
+    const flags = getFlags((payload.metadata: any));
+    if ((flags & (FLAG_DEFLATE | FLAG_GZIP)) === 0 || payload.data == null) {
+      return Single.of(payload);
+    }
+    return codecSingle(
+      flags & FLAG_GZIP ? gunzip : inflate,
+      payload.data,
+      this._maxBytes,
+      decompressed => ({
+        data: (decompressed: any),
+        metadata: payload.metadata,
+      }),
+    );
+  }
+
+  /**
+   * Compresses each of `payloads`, the first one whatever its size when
+   * `forceFirst` is set
+   */
+  compressPayloads<D, M>(
+    payloads: Flowable<Payload<D, M>>,
+    forceFirst?: boolean,
+  ): Flowable<Payload<D, M>> {
+    let force = Boolean(forceFirst);
+    return mapSingles(payloads, payload => {
+      const compressed = this.compressPayload(payload, force);
+      force = false;
+      return compressed;
+    });
+  }
+
+  /**
+   * Server side: compresses the responses to `request` if its sender reads
+   * compressed payloads, and passes them on as they are otherwise
+   */
+  compressResponses<D, M>(
+    request: Payload<D, M>,
+    responses: Flowable<Payload<D, M>>,
+  ): Flowable<Payload<D, M>> {
+    return accepts(request) ? this.compressPayloads(responses) : responses;
+  }
+
+  decompressPayloads<D, M>(
+    payloads: Flowable<Payload<D, M>>,
+  ): Flowable<Payload<D, M>> {
+    return mapSingles(payloads, payload => this.decompressPayload(payload));
+  }
+
+  /**
+   * Client side: sends a compressed request and decompresses the response.
+   */
+  requestResponse<D, M>(
+    payload: Payload<D, M>,
+    send: (payload: Payload<D, M>) => Single<Payload<D, M>>,
+  ): Single<Payload<D, M>> {
+    return flatMapSingle(
+      flatMapSingle(this.compressPayload(payload, true), send),
+      response => this.decompressPayload(response),
+    );
+  }
+
+  requestStream<D, M>(
+    payload: Payload<D, M>,
+    send: (payload: Payload<D, M>) => Flowable<Payload<D, M>>,
+  ): Flowable<Payload<D, M>> {
+    return this.decompressPayloads(
+      flatMapFlowable(this.compressPayload(payload, true), send),
+    );
+  }
+
+  requestChannel<D, M>(
+    payloads: Flowable<Payload<D, M>>,
+    send: (payloads: Flowable<Payload<D, M>>) => Flowable<Payload<D, M>>,
+  ): Flowable<Payload<D, M>> {
+    return this.decompressPayloads(send(this.compressPayloads(payloads, true)));
+  }
+
+  /**
+   * Server side: decompresses a request and compresses the response.
+   */
+  handleRequestResponse<D, M>(
+    payload: Payload<D, M>,
+    handle: (payload: Payload<D, M>) => Single<Payload<D, M>>,
+  ): Single<Payload<D, M>> {
+    return flatMapSingle(
+      flatMapSingle(this.decompressPayload(payload), handle),
+      response =>
+        accepts(payload) ? this.compressPayload(response) : Single.of(response),
+    );
+  }
+
+  handleRequestStream<D, M>(
+    payload: Payload<D, M>,
+    handle: (payload: Payload<D, M>) => Flowable<Payload<D, M>>,
+  ): Flowable<Payload<D, M>> {
+    return this.compressResponses(
+      payload,
+      flatMapFlowable(this.decompressPayload(payload), handle),
+    );
+  }
+
+  handleRequestChannel<D, M>(
+    payloads: Flowable<Payload<D, M>>,
+    handle: (payloads: Flowable<Payload<D, M>>) => Flowable<Payload<D, M>>,
+  ): Flowable<Payload<D, M>> {
+    let accepted = null;
+    const requests = payloads.map(payload => {
+      if (accepted === null) {
+        accepted = accepts(payload);
+      }
+      return payload;
+    });
+    return mapSingles(
+      handle(this.decompressPayloads(requests)),
+      response =>
+        accepted ? this.compressPayload(response) : Single.of(response),
+    );
+  }
+}
+
+// Whether the sender of `request` reads compressed payloads, as told by the
+// flag of the request
+function accepts<D, M>(request: Payload<D, M>): boolean {
+  return (getFlags((request.metadata: any)) & (FLAG_DEFLATE | FLAG_GZIP)) !== 0;
+}
+
+function codecSingle<T>(
+  codec: Codec,
+  data: any,
+  maxBytes: number,
+  wrap: (result: Buffer) => T,
+): Single<T> {
+  return new Single(subscriber => {
+    let cancelled = false;
+    subscriber.onSubscribe(() => {
+      cancelled = true;
+    });
+    codec(
+      toBuffer(data),
+      (error, result) => {
+        if (cancelled) {
+          return;
+        }
+        if (error) {
+          subscriber.onError(error);
+        } else {
+          subscriber.onComplete(wrap(result));
+        }
+      },
+      maxBytes,
+    );
+  });
+}
+
+function flatMapSingle<T, R>(
+  source: Single<T>,
+  fn: (value: T) => Single<R>,
+): Single<R> {
+  return new Single(subscriber => {
+    let cancel = null;
+    let cancelled = false;
+    subscriber.onSubscribe(() => {
+      cancelled = true;
+      cancel && cancel();
+    });
+    source.subscribe({
+      onComplete: value => {
+        if (cancelled) {
+          return;
+        }
+        let next;
+        try {
+          next = fn(value);
+        } catch (error) {
+          subscriber.onError(error);
+          return;
+        }
+        next.subscribe({
+          onComplete: result => subscriber.onComplete(result),
+          onError: error => subscriber.onError(error),
+          onSubscribe: c => {
+            cancel = c;
+          },
+        });
+      },
+      onError: error => subscriber.onError(error),
+      onSubscribe: c => {
+        cancel = c;
+      },
+    });
+  });
+}
+
+function flatMapFlowable<T, R>(
+  source: Single<T>,
+  fn: (value: T) => Flowable<R>,
+): Flowable<R> {
+  return new Flowable(subscriber => {
+    let requested = 0;
+    let cancelled = false;
+    let cancelSource = null;
+    let inner: ?ISubscription = null;
+    subscriber.onSubscribe({
+      cancel: () => {
+        cancelled = true;
+        inner ? inner.cancel() : cancelSource && cancelSource();
+      },
+      request: n => {
+        if (inner) {
+          inner.request(n);
+        } else {
+          requested += n;
+        }
+      },
+    });
+    source.subscribe({
+      onComplete: value => {
+        if (cancelled) {
+          return;
+        }
+        let next;
+        try {
+          next = fn(value);
+        } catch (error) {
+          subscriber.onError(error);
+          return;
+        }
+        next.subscribe({
+          onComplete: () => subscriber.onComplete(),
+          onError: error => subscriber.onError(error),
+          onNext: value => subscriber.onNext(value),
+          onSubscribe: subscription => {
+            inner = subscription;
+            if (requested > 0) {
+              subscription.request(requested);
+            }
+          },
+        });
+      },
+      onError: error => subscriber.onError(error),
+      onSubscribe: cancel => {
+        cancelSource = cancel;
+      },
+    });
+  });
+}
+
+/**
+ * Maps each element through an asynchronous function, emitting the results
+ * in the order of the source elements.
+ */
+function mapSingles<T, R>(
+  source: Flowable<T>,
+  fn: (value: T) => Single<R>,
+): Flowable<R> {
+  return new Flowable(subscriber =>
+    source.subscribe(new OrderedMapSubscriber(subscriber, fn)),
+  );
+}
+
+type Slot<R> = {done: boolean, value: ?R, cancel: ?() => void};
+
+/**
+ * @private
+ */
+class OrderedMapSubscriber<T, R> implements ISubscriber<T>, ISubscription {
+  _actual: ISubscriber<R>;
+  _fn: (value: T) => Single<R>;
+  _slots: Array<Slot<R>>;
+  _subscription: ?ISubscription;
+  _completed: boolean;
+  _terminated: boolean;
+
+  constructor(actual: ISubscriber<R>, fn: (value: T) => Single<R>) {
+    this._actual = actual;
+    this._fn = fn;
+    this._slots = [];
+    this._subscription = null;
+    this._completed = false;
+    this._terminated = false;
+  }
+
+  onSubscribe(subscription: ISubscription) {
+    this._subscription = subscription;
+    this._actual.onSubscribe(this);
+  }
+
+  onNext(value: T) {
+    if (this._terminated) {
+      return;
+    }
+    const slot: Slot<R> = {done: false, value: null, cancel: null};
+    this._slots.push(slot);
+    this._fn(value).subscribe({
+      onComplete: result => {
+        slot.done = true;
+        slot.value = result;
+        this._drain();
+      },
+      onError: error => this._fail(error, true),
+      onSubscribe: cancel => {
+        slot.cancel = cancel;
+      },
+    });
+  }
+
+  onError(error: Error) {
+    this._fail(error, false);
+  }
+
+  onComplete() {
+    this._completed = true;
+    this._drain();
+  }
+
+  request(n: number) {
+    // Each source element yields exactly one result, so demand passes through
+    this._subscription && this._subscription.request(n);
+  }
+
+  cancel() {
+    this._terminated = true;
+    this._cancelSlots();
+    this._subscription && this._subscription.cancel();
+  }
+
+  _drain() {
+    while (!this._terminated && this._slots.length > 0 && this._slots[0].done) {
+      const slot = this._slots.shift();
+      this._actual.onNext((slot.value: any));
+    }
+    if (!this._terminated && this._completed && this._slots.length === 0) {
+      this._terminated = true;
+      this._actual.onComplete();
+    }
+  }
+
+  _fail(error: Error, cancelSource: boolean) {
+    if (this._terminated) {
+      return;
+    }
+    this._terminated = true;
+    this._cancelSlots();
+    if (cancelSource && this._subscription) {
+      this._subscription.cancel();
+    }
+    this._actual.onError(error);
+  }
+
+  _cancelSlots() {
+    this._slots.forEach(slot => slot.cancel && slot.cancel());
+    this._slots = [];
+  }
+}
@@ -0,0 +1,33 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+/**
+ * Anything tracking the demand and buffers of a stream, e.g. a StreamFlow from
+ * rsocket-rpc-metrics. Operators report the credit requested from them, the
+ * elements they deliver, the elements they hold on to until there is demand,
+ * and the end of the stream.
+ */
+export type FlowObserver = {
+  request(n: number): void,
+  next(value: mixed): void,
+  buffer(value: mixed): void,
+  unbuffer(value: mixed): void,
+  close(): void,
+};
@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import {Single} from 'rsocket-flowable';
+
+/**
+ * Subscribes to `attempt()` and, if it has not completed after `delay()`
+ * milliseconds, subscribes to it a second time. The first attempt to complete
+ * wins and the other one is cancelled. Errors are not retried: an attempt that
+ * fails before the hedge is sent fails the whole call.
+ *
+ * Only use this for idempotent requests. Each attempt calls the factory again,
+ * with `socket` when given. A pool, see RSocketPool.hedged(), is passed as a
+ * view of itself that sends the hedge to another connection than the first
+ * attempt.
+ */
+export default function hedgeSingle<S, T>(
+  attempt: (socket: S) => Single<T>,
+  delay: () => number,
+  socket?: S,
+): Single<T> {
+  return new Single(subscriber => {
+    const target =
+      socket && typeof (socket: any).hedged === 'function'
+        ? (socket: any).hedged()
+        : socket;
+    const cancels: Array<?() => void> = [];
+    let done = false;
+    let pending = 0;
+    let timeout = null;
+
+    const finish = () => {
+      done = true;
+      if (timeout) {
+        clearTimeout(timeout);
+        timeout = null;
+      }
+      cancels.forEach(cancel => cancel && cancel());
+      cancels.length = 0;
+    };
+
+    const fail = (error: Error) => {
+      pending--;
+      if (!done && pending === 0) {
+        finish();
+        subscriber.onError(error);
+      }
+    };
+
+    const subscribeAttempt = () => {
+      const index = cancels.length;
+      cancels.push(null);
+      pending++;
+      let single;
+      try {
+        single = attempt((target: any));
+      } catch (error) {
+        fail(error);
+        return;
+      }
+      single.subscribe({
+        onComplete: value => {
+          if (done) {
+            return;
+          }
+          cancels[index] = null;
+          finish();
+          subscriber.onComplete(value);
+        },
+        onError: error => {
+          if (done) {
+            return;
+          }
+          cancels[index] = null;
+          fail(error);
+        },
+        onSubscribe: cancel => {
+          if (done) {
+            cancel && cancel();
+          } else {
+            cancels[index] = cancel;
+          }
+        },
+      });
+    };
+
+    subscriber.onSubscribe(() => {
+      if (!done) {
+        finish();
+      }
+    });
+
+    const after = delay();
+    if (after > 0 && after < Infinity) {
+      timeout = setTimeout(() => {
+        timeout = null;
+        if (!done) {
+          subscribeAttempt();
+        }
+      }, after);
+    }
+
+    subscribeAttempt();
+  });
+}
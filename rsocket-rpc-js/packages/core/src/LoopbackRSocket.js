@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {ConnectionStatus, Payload, ReactiveSocket} from 'rsocket-types';
+
+import {Flowable, Single} from 'rsocket-flowable';
+import type PriorityScheduler from './PriorityScheduler';
+import type RequestHandlingRSocket from './RequestHandlingRSocket';
+import {methodPriority} from './RequestHandlingRSocket';
+
+// Generated servers serve the calls of generated clients in the same process
+type LocalHandler = {
+  handleLocal(method: string, message: any, metadata: Buffer): any,
+};
+
+/**
+ * A ReactiveSocket that hands requests to a responder in the same process.
+ * Generated clients given one call the generated servers registered with the
+ * responder directly, passing their messages without serializing them, while
+ * still timing and tracing both sides of the call. With `clone`, each side
+ * gets copies of the other's messages, so that neither sees the other mutate
+ * them. Other requests reach the responder as payloads, without framing.
+ * Calls to generated servers are admitted by the responder's scheduler, if
+ * it has one, as the requests it handles are.
+ */
+export default class LoopbackRSocket
+  implements ReactiveSocket<Buffer, Buffer> {
+  _responder: RequestHandlingRSocket;
+  _clone: boolean;
+  _servers: WeakMap<Object, LocalServer>;
+  _closed: boolean;
+
+  constructor(responder: RequestHandlingRSocket, clone?: boolean) {
+    this._responder = responder;
+    this._clone = !!clone;
+    this._servers = new WeakMap();
+    this._closed = false;
+  }
+
+  /**
+   * The generated server registered for `service`, if any
+   */
+  localServer(service: string): ?LocalServer {
+    const handler: any = this._responder.getHandler(service);
+    if (!handler || typeof handler.handleLocal !== 'function') {
+      return null;
+    }
+    let server = this._servers.get(handler);
+    if (!server) {
+      server = new LocalServer(
+        handler,
+        this._clone,
+        this._responder.getScheduler(),
+      );
+      this._servers.set(handler, server);
+    }
+    return server;
+  }
+
+  fireAndForget(payload: Payload<Buffer, Buffer>): void {
+    this._responder.fireAndForget(payload);
+  }
+
+  requestResponse(
+    payload: Payload<Buffer, Buffer>,
+  ): Single<Payload<Buffer, Buffer>> {
+    return this._responder.requestResponse(payload);
+  }
+
+  requestStream(
+    payload: Payload<Buffer, Buffer>,
+  ): Flowable<Payload<Buffer, Buffer>> {
+    return this._responder.requestStream(payload);
+  }
+
+  requestChannel(
+    payloads: Flowable<Payload<Buffer, Buffer>>,
+  ): Flowable<Payload<Buffer, Buffer>> {
+    return this._responder.requestChannel(payloads);
+  }
+
+  metadataPush(payload: Payload<Buffer, Buffer>): Single<void> {
+    return this._responder.metadataPush(payload);
+  }
+
+  close(): void {
+    this._closed = true;
+  }
+
+  connectionStatus(): Flowable<ConnectionStatus> {
+    return new Flowable(subscriber => {
+      let sent = false;
+      subscriber.onSubscribe({
+        cancel: () => {},
+        request: () => {
+          if (!sent) {
+            sent = true;
+            subscriber.onNext({kind: this._closed ? 'CLOSED' : 'CONNECTED'});
+          }
+        },
+      });
+    });
+  }
+}
+
+/**
+ * Returns the generated server a generated client with the given socket can
+ * call directly, if the socket is a LoopbackRSocket serving `service`
+ */
+export function localServer(rsocket: any, service: string): ?LocalServer {
+  return rsocket instanceof LoopbackRSocket
+    ? rsocket.localServer(service)
+    : null;
+}
+
+/**
+ * Calls a generated server with messages, as its generated clients do when
+ * they share its process
+ */
+class LocalServer {
+  _handler: LocalHandler;
+  _clone: boolean;
+  _scheduler: ?PriorityScheduler;
+
+  constructor(
+    handler: LocalHandler,
+    clone: boolean,
+    scheduler: ?PriorityScheduler,
+  ) {
+    this._handler = handler;
+    this._clone = clone;
+    this._scheduler = scheduler;
+  }
+
+  fireAndForget(method: string, message: any, metadata: Buffer): void {
+    const scheduler = this._scheduler;
+    if (scheduler) {
+      scheduler
+        .single(methodPriority(this._handler, method), () => {
+          this._handler.handleLocal(method, this._copy(message), metadata);
+          return Single.of(undefined);
+        })
+        .subscribe({onError: () => {}});
+    } else {
+      this._handler.handleLocal(method, this._copy(message), metadata);
+    }
+  }
+
+  requestResponse(method: string, message: any, metadata: Buffer): Single<any> {
+    const call = () => {
+      const response: Single<any> = this._handler.handleLocal(
+        method,
+        this._copy(message),
+        metadata,
+      );
+      return this._clone ? response.map(copy) : response;
+    };
+    try {
+      const scheduler = this._scheduler;
+      return scheduler
+        ? scheduler.single(methodPriority(this._handler, method), call)
+        : call();
+    } catch (error) {
+      return Single.error(error);
+    }
+  }
+
+  requestStream(method: string, message: any, metadata: Buffer): Flowable<any> {
+    return this._flowable(method, () =>
+      this._handler.handleLocal(method, this._copy(message), metadata),
+    );
+  }
+
+  requestChannel(
+    method: string,
+    messages: Flowable<any>,
+    metadata: Buffer,
+  ): Flowable<any> {
+    return this._flowable(method, () =>
+      this._handler.handleLocal(
+        method,
+        this._clone ? messages.map(copy) : messages,
+        metadata,
+      ),
+    );
+  }
+
+  _flowable(method: string, handle: () => Flowable<any>): Flowable<any> {
+    const call = () => {
+      const responses = handle();
+      return this._clone ? responses.map(copy) : responses;
+    };
+    try {
+      const scheduler = this._scheduler;
+      return scheduler
+        ? scheduler.flowable(methodPriority(this._handler, method), call)
+        : call();
+    } catch (error) {
+      return Flowable.error(error);
+    }
+  }
+
+  _copy(message: any): any {
+    return this._clone ? copy(message) : message;
+  }
+}
+
+// A deep copy of a generated protobuf message
+function copy(message: any): any {
+  return message.cloneMessage();
+}
@@ -0,0 +1,383 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {ISubscriber, ISubscription, Payload} from 'rsocket-types';
+
+import {MAX_VARINT_SIZE, readVarint, writeVarint} from 'rsocket-rpc-frames';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+// Messages requested at a time from the stream being packed
+const PACK_PREFETCH = 256;
+
+/**
+ * Returns a function to lift() a stream of payloads with, which packs
+ * consecutive payloads into one, each of their data prefixed with its length
+ * as a varint, for methods declared with the `pack` option. A packed payload
+ * holds at most `maxBytes` of data, unless a single payload is larger, and is
+ * sent once it is full, the stream ends, or `lingerMs` after the first
+ * payload it holds arrived; with no linger, at the end of the current turn of
+ * the event loop. Demand is counted in packed payloads. Metadata is dropped.
+ */
+export function packPayloads<D, M>(
+  maxBytes: number,
+  lingerMs: number,
+): (ISubscriber<Payload<Buffer, M>>) => ISubscriber<Payload<D, M>> {
+  return subscriber => new PackingSubscriber(subscriber, maxBytes, lingerMs);
+}
+
+/**
+ * Lifts a stream of packed payloads into the payloads they hold, counting
+ * demand in unpacked payloads: a packed payload is only requested once those
+ * of the previous one are all requested.
+ */
+export function unpackPayloads<M>(
+  subscriber: ISubscriber<Payload<Buffer, M>>,
+): ISubscriber<Payload<any, M>> {
+  return new UnpackingSubscriber(subscriber);
+}
+
+class PackingSubscriber<D, M>
+  implements ISubscriber<Payload<D, M>>, ISubscription {
+  _actual: ISubscriber<Payload<Buffer, M>>;
+  _subscription: ?ISubscription;
+  _maxBytes: number;
+  _lingerMs: number;
+  _buffers: Buffer[];
+  _bytes: number;
+  _requested: number;
+  _outstanding: number;
+  _lingering: any;
+  _lingered: boolean;
+  _done: boolean;
+  _error: ?Error;
+  _cancelled: boolean;
+  _wip: number;
+
+  constructor(
+    actual: ISubscriber<Payload<Buffer, M>>,
+    maxBytes: number,
+    lingerMs: number,
+  ) {
+    this._actual = actual;
+    this._subscription = null;
+    this._maxBytes = maxBytes;
+    this._lingerMs = lingerMs;
+    this._buffers = [];
+    this._bytes = 0;
+    this._requested = 0;
+    this._outstanding = 0;
+    this._lingering = null;
+    this._lingered = false;
+    this._done = false;
+    this._error = null;
+    this._cancelled = false;
+    this._wip = 0;
+  }
+
+  onSubscribe(subscription: ISubscription) {
+    this._subscription = subscription;
+    this._actual.onSubscribe(this);
+  }
+
+  onNext(payload: Payload<D, M>) {
+    if (this._cancelled) {
+      return;
+    }
+    const data = toBuffer(payload.data);
+    this._outstanding--;
+    this._buffers.push(data);
+    this._bytes += data.length;
+    if (this._lingering == null && !this._lingered) {
+      this._linger();
+    }
+    this._drain();
+  }
+
+  onError(error: Error) {
+    this._error = error;
+    this._done = true;
+    this._drain();
+  }
+
+  onComplete() {
+    this._done = true;
+    this._drain();
+  }
+
+  request(n: number) {
+    this._requested = Math.min(this._requested + n, MAX_REQUEST_N);
+    this._drain();
+  }
+
+  cancel() {
+    this._cancelled = true;
+    this._stopLingering();
+    this._buffers = [];
+    this._subscription && this._subscription.cancel();
+  }
+
+  _linger() {
+    const flush = () => {
+      this._lingering = null;
+      this._lingered = true;
+      this._drain();
+    };
+    this._lingering =
+      this._lingerMs > 0
+        ? setTimeout(flush, this._lingerMs)
+        : setImmediate(flush);
+  }
+
+  _stopLingering() {
+    const lingering = this._lingering;
+    if (lingering != null) {
+      this._lingering = null;
+      this._lingerMs > 0 ? clearTimeout(lingering) : clearImmediate(lingering);
+    }
+  }
+
+  _drain() {
+    if (this._wip++ !== 0) {
+      return;
+    }
+    let missed = 1;
+    for (;;) {
+      if (this._cancelled) {
+        return;
+      }
+      if (this._error) {
+        this._stopLingering();
+        this._cancelled = true;
+        this._actual.onError(this._error);
+        return;
+      }
+      // Sends what is ready while there is demand for it
+      while (
+        this._requested > 0 &&
+        this._buffers.length > 0 &&
+        (this._bytes >= this._maxBytes || this._lingered || this._done)
+      ) {
+        this._send();
+        if (this._cancelled) {
+          return;
+        }
+      }
+      if (this._done && this._buffers.length === 0) {
+        this._stopLingering();
+        this._cancelled = true;
+        this._actual.onComplete();
+        return;
+      }
+      // Only asks for more while the next packed payload is not full yet
+      if (
+        !this._done &&
+        this._requested > 0 &&
+        this._bytes < this._maxBytes &&
+        this._outstanding === 0 &&
+        this._subscription
+      ) {
+        this._outstanding = PACK_PREFETCH;
+        this._subscription.request(PACK_PREFETCH);
+      }
+      missed = this._wip -= missed;
+      if (missed === 0) {
+        return;
+      }
+    }
+  }
+
+  _send() {
+    const buffers = this._buffers;
+    let count = 0;
+    let bytes = 0;
+    do {
+      bytes += buffers[count].length;
+      count++;
+    } while (
+      count < buffers.length &&
+      bytes + buffers[count].length <= this._maxBytes
+    );
+
+    const packed = Buffer.allocUnsafe(bytes + count * MAX_VARINT_SIZE);
+    let offset = 0;
+    for (let i = 0; i < count; i++) {
+      const data = buffers[i];
+      offset = writeVarint(packed, data.length, offset);
+      offset += data.copy(packed, offset);
+    }
+    buffers.splice(0, count);
+    this._bytes -= bytes;
+    if (this._requested < MAX_REQUEST_N) {
+      this._requested--;
+    }
+
+    // What is left over starts a packed payload of its own
+    this._stopLingering();
+    this._lingered = false;
+    if (buffers.length > 0) {
+      this._linger();
+    }
+    this._actual.onNext({
+      data: packed.slice(0, offset),
+      metadata: (Buffer.alloc(0): any),
+    });
+  }
+}
+
+class UnpackingSubscriber<M>
+  implements ISubscriber<Payload<any, M>>, ISubscription {
+  _actual: ISubscriber<Payload<Buffer, M>>;
+  _subscription: ?ISubscription;
+  _queue: Array<Payload<Buffer, M>>;
+  _cursor: {offset: number};
+  _requested: number;
+  _outstanding: boolean;
+  _unbounded: boolean;
+  _done: boolean;
+  _error: ?Error;
+  _cancelled: boolean;
+  _wip: number;
+
+  constructor(actual: ISubscriber<Payload<Buffer, M>>) {
+    this._actual = actual;
+    this._subscription = null;
+    this._queue = [];
+    this._cursor = {offset: 0};
+    this._requested = 0;
+    this._outstanding = false;
+    this._unbounded = false;
+    this._done = false;
+    this._error = null;
+    this._cancelled = false;
+    this._wip = 0;
+  }
+
+  onSubscribe(subscription: ISubscription) {
+    this._subscription = subscription;
+    this._actual.onSubscribe(this);
+  }
+
+  onNext(payload: Payload<any, M>) {
+    this._outstanding = false;
+    const data = toBuffer(payload.data);
+    if (data.length > 0) {
+      this._queue.push({data, metadata: payload.metadata});
+    }
+    this._drain();
+  }
+
+  onError(error: Error) {
+    this._error = error;
+    this._done = true;
+    this._drain();
+  }
+
+  onComplete() {
+    this._done = true;
+    this._drain();
+  }
+
+  request(n: number) {
+    this._requested = Math.min(this._requested + n, MAX_REQUEST_N);
+    this._drain();
+  }
+
+  cancel() {
+    this._cancelled = true;
+    this._queue = [];
+    this._subscription && this._subscription.cancel();
+  }
+
+  _drain() {
+    if (this._wip++ !== 0) {
+      return;
+    }
+    let missed = 1;
+    for (;;) {
+      const queue = this._queue;
+      while (this._requested > 0 && queue.length > 0) {
+        if (this._cancelled) {
+          return;
+        }
+        const {data, metadata} = queue[0];
+        const cursor = this._cursor;
+        const length = readVarint(data, cursor);
+        // Packed payloads come from the peer, so a length cut short or
+        // running past its payload fails the stream
+        if (length < 0 || length > data.length - cursor.offset) {
+          this._cancelled = true;
+          this._queue = [];
+          this._subscription && this._subscription.cancel();
+          this._actual.onError(new Error('Malformed packed payload'));
+          return;
+        }
+        const start = cursor.offset;
+        cursor.offset += length;
+        if (cursor.offset >= data.length) {
+          queue.shift();
+          cursor.offset = 0;
+        }
+        if (this._requested < MAX_REQUEST_N) {
+          this._requested--;
+        }
+        this._actual.onNext({
+          data: data.slice(start, start + length),
+          metadata: (metadata: any),
+        });
+      }
+      if (this._cancelled) {
+        return;
+      }
+      if (this._done && this._queue.length === 0) {
+        this._cancelled = true;
+        const error = this._error;
+        error ? this._actual.onError(error) : this._actual.onComplete();
+        return;
+      }
+      // A stream wanting everything gets every packed payload as it comes,
+      // otherwise one is requested once the previous one is used up
+      const subscription = this._subscription;
+      if (subscription && !this._done && !this._unbounded) {
+        if (this._requested >= MAX_REQUEST_N) {
+          this._unbounded = true;
+          subscription.request(MAX_REQUEST_N);
+        } else if (
+          this._requested > 0 &&
+          this._queue.length === 0 &&
+          !this._outstanding
+        ) {
+          this._outstanding = true;
+          subscription.request(1);
+        }
+      }
+      missed = this._wip -= missed;
+      if (missed === 0) {
+        return;
+      }
+    }
+  }
+}
+
+function toBuffer(data: any): Buffer {
+  if (data == null) {
+    return Buffer.alloc(0);
+  }
+  return Buffer.isBuffer(data) ? data : Buffer.from(data);
+}
@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {
+  ConnectionStatus,
+  DuplexConnection,
+  Frame,
+  ISubscriber,
+  ISubscription,
+} from 'rsocket-types';
+import type {Encoders} from 'rsocket-core/build/RSocketEncoding';
+
+import {Flowable} from 'rsocket-flowable';
+import {deserializeFrames, serializeFrameWithLength} from 'rsocket-core';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+
+/**
+ * Bytes received before they are acknowledged
+ */
+export const ACK_SIZE = 64 * 1024;
+
+/**
+ * A DuplexConnection over a MessagePort, fed by a ShardedServer with the
+ * bytes of a connection it accepted on the main thread. Each message is an
+ * ArrayBuffer of the connection's bytes, framed as over TCP, and null marks
+ * the end of the connection. Once their frames are handled, every ACK_SIZE
+ * bytes received are acknowledged with a message holding their number, for
+ * the server to stop reading a connection whose worker falls behind.
+ */
+export default class PortDuplexConnection implements DuplexConnection {
+  _port: Object;
+  _encoders: ?Encoders<*>;
+  _buffer: Buffer;
+  _receivers: Set<ISubscriber<Frame>>;
+  _senders: Set<ISubscription>;
+  _statuses: Set<ISubscriber<ConnectionStatus>>;
+  _status: ConnectionStatus;
+  _unacknowledged: number;
+
+  constructor(port: Object, encoders: ?Encoders<*>) {
+    this._port = port;
+    this._encoders = encoders;
+    this._buffer = Buffer.alloc(0);
+    this._receivers = new Set();
+    this._senders = new Set();
+    this._statuses = new Set();
+    this._status = {kind: 'CONNECTED'};
+    this._unacknowledged = 0;
+    port.on('message', data =>
+      data == null ? this._close() : this._handleData(Buffer.from(data)),
+    );
+    port.on('close', () => this._close());
+  }
+
+  sendOne(frame: Frame): void {
+    if (this._status.kind !== 'CONNECTED') {
+      return;
+    }
+    const data = transferable(serializeFrameWithLength(frame, this._encoders));
+    this._port.postMessage(data, [data]);
+  }
+
+  send(frames: Flowable<Frame>): void {
+    let subscription;
+    frames.subscribe({
+      onComplete: () => {
+        subscription && this._senders.delete(subscription);
+      },
+      onError: error => {
+        subscription && this._senders.delete(subscription);
+        this._close(error);
+      },
+      onNext: frame => this.sendOne(frame),
+      onSubscribe: _subscription => {
+        subscription = _subscription;
+        this._senders.add(subscription);
+        subscription.request(MAX_REQUEST_N);
+      },
+    });
+  }
+
+  receive(): Flowable<Frame> {
+    return new Flowable(subscriber => {
+      subscriber.onSubscribe({
+        cancel: () => {
+          this._receivers.delete(subscriber);
+        },
+        request: () => {
+          this._receivers.add(subscriber);
+        },
+      });
+    });
+  }
+
+  close(): void {
+    this._close();
+  }
+
+  connect(): void {
+    throw new Error('PortDuplexConnection: connect() is not supported');
+  }
+
+  connectionStatus(): Flowable<ConnectionStatus> {
+    return new Flowable(subscriber => {
+      subscriber.onSubscribe({
+        cancel: () => {
+          this._statuses.delete(subscriber);
+        },
+        request: () => {
+          this._statuses.add(subscriber);
+          subscriber.onNext(this._status);
+        },
+      });
+    });
+  }
+
+  _handleData(data: Buffer): void {
+    try {
+      const buffer =
+        this._buffer.length > 0 ? Buffer.concat([this._buffer, data]) : data;
+      const [frames, remaining] = deserializeFrames(buffer, this._encoders);
+      this._buffer = remaining;
+      frames.forEach(frame =>
+        this._receivers.forEach(subscriber => subscriber.onNext(frame)),
+      );
+      this._unacknowledged += data.length;
+      if (
+        this._unacknowledged >= ACK_SIZE &&
+        this._status.kind === 'CONNECTED'
+      ) {
+        this._port.postMessage(this._unacknowledged);
+        this._unacknowledged = 0;
+      }
+    } catch (error) {
+      this._close(error);
+    }
+  }
+
+  _close(error?: Error): void {
+    if (this._status.kind !== 'CONNECTED') {
+      return;
+    }
+    this._status = error ? {error, kind: 'ERROR'} : {kind: 'CLOSED'};
+    this._port.postMessage(null);
+    this._port.close();
+    this._senders.forEach(subscription => subscription.cancel());
+    this._senders.clear();
+    const receivers = Array.from(this._receivers);
+    this._receivers.clear();
+    receivers.forEach(subscriber =>
+      error ? subscriber.onError(error) : subscriber.onComplete(),
+    );
+    this._statuses.forEach(subscriber => subscriber.onNext(this._status));
+  }
+}
+
+/**
+ * The buffer behind `bytes`, to transfer to another thread, when they are
+ * all it holds, otherwise a copy of them. Pooled Buffers, which share theirs,
+ * are never all of it.
+ */
+export function transferable(bytes: Uint8Array): ArrayBuffer {
+  if (bytes.byteOffset === 0 && bytes.byteLength === bytes.buffer.byteLength) {
+    return bytes.buffer;
+  }
+  const copied = new Uint8Array(bytes.length);
+  copied.set(bytes);
+  return copied.buffer;
+}
@@ -0,0 +1,281 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {Flowable, Single} from 'rsocket-flowable';
+import type {Call, Gate} from './Admission';
+
+import {admitFlowable, admitSingle} from './Admission';
+
+// Values of the RSocketPriority enum in rsocket/options.proto
+export const PRIORITY_UNSET = 0;
+export const PRIORITY_CRITICAL = 1;
+export const PRIORITY_HIGH = 2;
+export const PRIORITY_NORMAL = 3;
+export const PRIORITY_LOW = 4;
+
+export type PriorityWeights = {
+  high?: number,
+  normal?: number,
+  low?: number,
+};
+
+/**
+ * The shares of the calls run at once that the calls of a priority and those
+ * below it may hold, e.g. half of them for low
+ */
+export type PriorityShares = {
+  normal?: number,
+  low?: number,
+};
+
+/**
+ * The calls to a method waiting to start
+ */
+export type MethodLoad = {
+  service: string,
+  method: string,
+  queued: number,
+};
+
+type Task = {
+  call: Call,
+  service: ?string,
+  method: ?string,
+};
+
+type Queue = {
+  tasks: Array<Task>,
+  weight: number,
+  current: number,
+  // Calls of this priority running, and the most that may run of it and the
+  // priorities below it
+  running: number,
+  limit: number,
+};
+
+/**
+ * Admits calls by the priority of their method. At most `maxConcurrent`
+ * calls run at once, counting a stream or channel until it ends; the others
+ * wait in a queue per priority, and are started as calls end, from the
+ * queues with waiting calls in proportion to their weights (smooth weighted
+ * round robin), 8, 4 and 1 for high, normal and low when unset. So that
+ * long streams of lower priorities cannot hold every slot, low calls may
+ * only hold a share of them, half when unset, and normal and low calls
+ * together another, all of them when unset; high calls may hold them all.
+ * Critical calls, e.g. health checks, are never queued, though they count
+ * towards the calls running. Unset priorities are normal.
+ */
+export default class PriorityScheduler {
+  _maxConcurrent: number;
+  _queues: Array<Queue>;
+  _active: number;
+
+  constructor(
+    maxConcurrent: number,
+    weights?: PriorityWeights,
+    shares?: PriorityShares,
+  ) {
+    const queue = (weight, share) => ({
+      current: 0,
+      limit: Math.max(1, Math.floor(maxConcurrent * share)),
+      running: 0,
+      tasks: [],
+      weight,
+    });
+    this._maxConcurrent = maxConcurrent;
+    this._queues = [
+      queue((weights && weights.high) || 8, 1),
+      queue((weights && weights.normal) || 4, (shares && shares.normal) || 1),
+      queue((weights && weights.low) || 1, (shares && shares.low) || 0.5),
+    ];
+    this._active = 0;
+  }
+
+  /**
+   * Subscribes to the Single returned by `source` once admitted. The service
+   * and method, when given, are reported by load() while the call waits.
+   */
+  single<T>(
+    priority: number,
+    source: () => Single<T>,
+    service?: ?string,
+    method?: ?string,
+  ): Single<T> {
+    return admitSingle(this._gate(priority, service, method), source);
+  }
+
+  /**
+   * Subscribes to the Flowable returned by `source` once admitted, passing
+   * on the demand requested until then
+   */
+  flowable<T>(
+    priority: number,
+    source: () => Flowable<T>,
+    service?: ?string,
+    method?: ?string,
+  ): Flowable<T> {
+    return admitFlowable(this._gate(priority, service, method), source);
+  }
+
+  /**
+   * The most calls run at once
+   */
+  maxConcurrent(): number {
+    return this._maxConcurrent;
+  }
+
+  /**
+   * The number of calls running
+   */
+  active(): number {
+    return this._active;
+  }
+
+  /**
+   * The number of calls waiting, of one priority or of all of them
+   */
+  queued(priority?: number): number {
+    if (priority != null) {
+      const queue = this._queue(priority);
+      return queue ? queue.tasks.length : 0;
+    }
+    return this._queues.reduce((sum, queue) => sum + queue.tasks.length, 0);
+  }
+
+  /**
+   * The number of calls waiting for each method that has some, of the calls
+   * admitted with their service and method
+   */
+  load(): Array<MethodLoad> {
+    const loads: Map<string, MethodLoad> = new Map();
+    this._queues.forEach(queue =>
+      queue.tasks.forEach(({method, service}) => {
+        if (service == null || method == null) {
+          return;
+        }
+        const key = service + '/' + method;
+        const load = loads.get(key);
+        if (load) {
+          load.queued++;
+        } else {
+          loads.set(key, {method, queued: 1, service});
+        }
+      }),
+    );
+    return Array.from(loads.values());
+  }
+
+  _queue(priority: number): ?Queue {
+    switch (priority) {
+      case PRIORITY_CRITICAL:
+        return null;
+      case PRIORITY_HIGH:
+        return this._queues[0];
+      case PRIORITY_LOW:
+        return this._queues[2];
+      default:
+        return this._queues[1];
+    }
+  }
+
+  _gate(priority: number, service: ?string, method: ?string): Gate {
+    return {
+      admit: call => this._admit(priority, {call, method, service}),
+      release: () => this._release(priority),
+      withdraw: call => this._withdraw(priority, call),
+    };
+  }
+
+  _admit(priority: number, task: Task): void {
+    const queue = this._queue(priority);
+    if (!queue) {
+      this._active++;
+      task.call.start();
+    } else if (this._active < this._maxConcurrent && this._hasRoom(queue)) {
+      this._start(queue, task);
+    } else {
+      queue.tasks.push(task);
+    }
+  }
+
+  _start(queue: Queue, task: Task): void {
+    this._active++;
+    queue.running++;
+    task.call.start();
+  }
+
+  // Whether the calls of a queue's priority and those below it hold fewer
+  // than their share of the slots
+  _hasRoom(queue: Queue): boolean {
+    let running = 0;
+    for (let i = this._queues.indexOf(queue); i < this._queues.length; i++) {
+      running += this._queues[i].running;
+    }
+    return running < queue.limit;
+  }
+
+  _withdraw(priority: number, call: Call): void {
+    const queue = this._queue(priority);
+    if (!queue) {
+      return;
+    }
+    const index = queue.tasks.findIndex(task => task.call === call);
+    if (index !== -1) {
+      queue.tasks.splice(index, 1);
+    }
+  }
+
+  _release(priority: number): void {
+    const queue = this._queue(priority);
+    if (queue) {
+      queue.running--;
+    }
+    this._active--;
+    while (this._active < this._maxConcurrent) {
+      const next = this._next();
+      if (!next) {
+        return;
+      }
+      this._start(next, next.tasks.shift());
+    }
+  }
+
+  // Picks the queue furthest behind its share of the calls started, of those
+  // with calls waiting and room for them
+  _next(): ?Queue {
+    let total = 0;
+    let next = null;
+    for (let i = 0; i < this._queues.length; i++) {
+      const queue = this._queues[i];
+      if (queue.tasks.length > 0 && this._hasRoom(queue)) {
+        total += queue.weight;
+        queue.current += queue.weight;
+        if (!next || queue.current > next.current) {
+          next = queue;
+        }
+      }
+    }
+    if (!next) {
+      return null;
+    }
+    next.current -= total;
+    return next;
+  }
+}
@@ -4,9 +4,16 @@ import type {
   IPartialSubscriber,
   ISubscription,
 } from 'rsocket-types';
+import type {FlowObserver} from './FlowObserver';
 
 const MAX_REQUEST_N = 0x7fffffff; // uint31
 
+/**
+ * Queues the elements it is given until its subscriber requests them. Given
+ * a flow observer, e.g. a StreamFlow of rsocket-rpc-metrics, it reports the
+ * elements and bytes it holds, the credit requested from it and the end of
+ * the stream.
+ */
 export default class QueuingFlowableProcessor<T>
   implements IPublisher, ISubscriber, ISubscription {
   _once: boolean;
@@ -18,8 +25,9 @@ export default class QueuingFlowableProcessor<T>
   _cancelled: boolean;
   _done: boolean;
   _error: ?Error;
+  _flow: ?FlowObserver;
 
-  constructor(capacity?: number) {
+  constructor(capacity?: number, flow?: ?FlowObserver) {
     this._once = false;
     this._requested = 0;
     this._actual = null;
@@ -30,6 +38,7 @@ export default class QueuingFlowableProcessor<T>
     this._capacity = capacity;
     this._queue = [];
     this._transformers = [];
+    this._flow = flow;
   }
 
   subscribe(s: Subscriber<T>) {
@@ -56,6 +65,7 @@ export default class QueuingFlowableProcessor<T>
     }
     if (!this._capacity || this._queue.length < this._capacity) {
       this._queue.push(t);
+      this._flow && this._flow.buffer(t);
     }
     this.drain();
   }
@@ -76,6 +86,7 @@ export default class QueuingFlowableProcessor<T>
 
   request(n: number) {
     if (n > 0) {
+      this._flow && this._flow.request(n);
       this._requested += n;
       this.drain();
     } else {
@@ -85,6 +96,7 @@ export default class QueuingFlowableProcessor<T>
 
   cancel() {
     this._cancelled = true;
+    this._flow && this._flow.close();
     if (this._wip++ === 0) {
       this._actual = null;
       this._queue = [];
@@ -130,6 +142,7 @@ export default class QueuingFlowableProcessor<T>
               this._actual.onComplete();
             }
             this._actual = null;
+            this._flow && this._flow.close();
           }
           return;
         }
@@ -137,12 +150,14 @@ export default class QueuingFlowableProcessor<T>
         if (empty) {
           break;
         }
+        this._flow && this._flow.unbuffer(v);
 
         if (this._actual != null) {
           const transformedV = this._transformers.reduce(
             (interim, xform) => xform(interim),
             v,
           );
+          this._flow && this._flow.next(transformedV);
           this._actual.onNext(transformedV);
         }
 
@@ -167,6 +182,7 @@ export default class QueuingFlowableProcessor<T>
               this._actual.onComplete();
             }
             this._actual = null;
+            this._flow && this._flow.close();
           }
           return;
         }
@@ -0,0 +1,464 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {
+  ConnectionStatus,
+  ISubscriber,
+  ISubscription,
+  Payload,
+  ReactiveSocket,
+} from 'rsocket-types';
+
+import {Flowable, Single} from 'rsocket-flowable';
+import type RpcClient from './RpcClient';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+
+// Latency assumed for a connection that has not answered anything yet
+const INITIAL_LATENCY = 1;
+// Time constant of the latency moving average, in milliseconds
+const DECAY_TIME = 10000;
+
+/**
+ * A ReactiveSocket spread over several connections. Each request goes to the
+ * cheaper of two randomly chosen connections, where the cost of a connection
+ * is its moving average latency times its number of outstanding requests.
+ *
+ * Connections are dropped from the pool once they close or fail, and are
+ * never replaced by the pool: an RpcClient connects only once, over a
+ * transport that cannot be reopened. Callers that want to keep the pool at
+ * its size watch the connectionStatus() of the sockets they add, connect a
+ * new RpcClient when one closes, and add() its socket. The pool reports
+ * CLOSED once its last connection is gone, and CONNECTED again once one is
+ * added.
+ */
+export default class RSocketPool<D, M> implements ReactiveSocket<D, M> {
+  _members: Array<PoolMember<D, M>>;
+  _statusSubscribers: Array<StatusSubscriber>;
+
+  constructor(sockets?: Array<ReactiveSocket<D, M>>) {
+    this._members = [];
+    this._statusSubscribers = [];
+    (sockets || []).forEach(socket => this.add(socket));
+  }
+
+  /**
+   * Connects every client and completes with a pool of the connections that
+   * succeeded. Fails only if none of them did. Clients that failed, and
+   * those whose connection later closes, are not retried, see above.
+   */
+  static connect(clients: Array<RpcClient<D, M>>): Single<RSocketPool<D, M>> {
+    return new Single(subscriber => {
+      const pool = new RSocketPool();
+      const cancels = [];
+      let remaining = clients.length;
+      let lastError = new Error('RSocketPool: No clients to connect.');
+      const settle = () => {
+        if (--remaining === 0) {
+          if (pool.size() > 0) {
+            subscriber.onComplete(pool);
+          } else {
+            subscriber.onError(lastError);
+          }
+        }
+      };
+      subscriber.onSubscribe(() => cancels.forEach(cancel => cancel()));
+      if (remaining === 0) {
+        subscriber.onError(lastError);
+        return;
+      }
+      clients.forEach(client =>
+        client.connect().subscribe({
+          onComplete: socket => {
+            pool.add(socket);
+            settle();
+          },
+          onError: error => {
+            lastError = error;
+            settle();
+          },
+          onSubscribe: cancel => cancels.push(cancel),
+        }),
+      );
+    });
+  }
+
+  add(socket: ReactiveSocket<D, M>): void {
+    const member = new PoolMember(socket);
+    this._members.push(member);
+    socket.connectionStatus().subscribe({
+      onNext: status => {
+        if (status.kind === 'CLOSED' || status.kind === 'ERROR') {
+          this._remove(member);
+        }
+      },
+      onSubscribe: subscription => {
+        member.statusSubscription = subscription;
+        subscription.request(MAX_REQUEST_N);
+      },
+    });
+    if (this._members.length === 1) {
+      this._publishStatus({kind: 'CONNECTED'});
+    }
+  }
+
+  size(): number {
+    return this._members.length;
+  }
+
+  fireAndForget(payload: Payload<D, M>): void {
+    const member = this._select();
+    if (member) {
+      member.socket.fireAndForget(payload);
+    }
+  }
+
+  requestResponse(payload: Payload<D, M>): Single<Payload<D, M>> {
+    return this._requestResponse(payload, null);
+  }
+
+  /**
+   * A view of the pool for the attempts of one hedged call, see hedgeSingle():
+   * each of its requests goes to a connection the earlier ones did not, as
+   * long as there is one left
+   */
+  hedged(): ReactiveSocket<D, M> {
+    return new HedgedPool(this);
+  }
+
+  _requestResponse(
+    payload: Payload<D, M>,
+    used: ?Set<PoolMember<D, M>>,
+  ): Single<Payload<D, M>> {
+    return new Single(subscriber => {
+      const member = this._select(used);
+      if (member && used) {
+        used.add(member);
+      }
+      if (!member) {
+        subscriber.onSubscribe();
+        subscriber.onError(noConnections());
+        return;
+      }
+      const start = member.start();
+      let active = true;
+      const end = (record: boolean) => {
+        if (active) {
+          active = false;
+          member.end(start, record);
+        }
+      };
+      member.socket.requestResponse(payload).subscribe({
+        onComplete: value => {
+          end(true);
+          subscriber.onComplete(value);
+        },
+        onError: error => {
+          end(true);
+          subscriber.onError(error);
+        },
+        onSubscribe: cancel => {
+          subscriber.onSubscribe(() => {
+            end(false);
+            cancel && cancel();
+          });
+        },
+      });
+    });
+  }
+
+  requestStream(payload: Payload<D, M>): Flowable<Payload<D, M>> {
+    return new Flowable(subscriber => {
+      const member = this._select();
+      if (!member) {
+        Flowable.error(noConnections()).subscribe(subscriber);
+        return;
+      }
+      member.socket
+        .requestStream(payload)
+        .subscribe(new PoolSubscriber(subscriber, member));
+    });
+  }
+
+  requestChannel(payloads: Flowable<Payload<D, M>>): Flowable<Payload<D, M>> {
+    return new Flowable(subscriber => {
+      const member = this._select();
+      if (!member) {
+        Flowable.error(noConnections()).subscribe(subscriber);
+        return;
+      }
+      member.socket
+        .requestChannel(payloads)
+        .subscribe(new PoolSubscriber(subscriber, member));
+    });
+  }
+
+  metadataPush(payload: Payload<D, M>): Single<void> {
+    const member = this._select();
+    return member
+      ? member.socket.metadataPush(payload)
+      : Single.error(noConnections());
+  }
+
+  close(): void {
+    this._members.slice().forEach(member => {
+      this._remove(member);
+      member.socket.close();
+    });
+  }
+
+  connectionStatus(): Flowable<ConnectionStatus> {
+    return new Flowable(subscriber => {
+      const statusSubscriber = {subscriber, requested: 0, last: null};
+      subscriber.onSubscribe({
+        cancel: () => {
+          const index = this._statusSubscribers.indexOf(statusSubscriber);
+          if (index !== -1) {
+            this._statusSubscribers.splice(index, 1);
+          }
+        },
+        request: n => {
+          statusSubscriber.requested = Math.min(
+            MAX_REQUEST_N,
+            statusSubscriber.requested + n,
+          );
+          if (statusSubscriber.last === null) {
+            this._deliverStatus(
+              statusSubscriber,
+              this._members.length > 0
+                ? {kind: 'CONNECTED'}
+                : {kind: 'NOT_CONNECTED'},
+            );
+          }
+        },
+      });
+      this._statusSubscribers.push(statusSubscriber);
+    });
+  }
+
+  _select(exclude?: ?Set<PoolMember<D, M>>): ?PoolMember<D, M> {
+    let members = this._members;
+    if (exclude && exclude.size > 0) {
+      const remaining = members.filter(member => !exclude.has(member));
+      // Once every connection was used, they are all candidates again
+      members = remaining.length > 0 ? remaining : members;
+    }
+    if (members.length < 2) {
+      return members[0];
+    }
+    // Power of two choices: pick two distinct members, keep the cheaper one
+    const i = Math.floor(Math.random() * members.length);
+    let j = Math.floor(Math.random() * (members.length - 1));
+    if (j >= i) {
+      j++;
+    }
+    return members[i].cost() <= members[j].cost() ? members[i] : members[j];
+  }
+
+  _remove(member: PoolMember<D, M>): void {
+    const index = this._members.indexOf(member);
+    if (index === -1) {
+      return;
+    }
+    this._members.splice(index, 1);
+    member.statusSubscription && member.statusSubscription.cancel();
+    if (this._members.length === 0) {
+      this._publishStatus({kind: 'CLOSED'});
+    }
+  }
+
+  _publishStatus(status: ConnectionStatus): void {
+    this._statusSubscribers.forEach(statusSubscriber =>
+      this._deliverStatus(statusSubscriber, status),
+    );
+  }
+
+  _deliverStatus(
+    statusSubscriber: StatusSubscriber,
+    status: ConnectionStatus,
+  ): void {
+    if (statusSubscriber.requested > 0) {
+      statusSubscriber.requested--;
+      statusSubscriber.last = status;
+      statusSubscriber.subscriber.onNext(status);
+    }
+  }
+}
+
+type StatusSubscriber = {
+  subscriber: ISubscriber<ConnectionStatus>,
+  requested: number,
+  last: ?ConnectionStatus,
+};
+
+/**
+ * @private
+ */
+class HedgedPool<D, M> implements ReactiveSocket<D, M> {
+  _pool: RSocketPool<D, M>;
+  _used: Set<PoolMember<D, M>>;
+
+  constructor(pool: RSocketPool<D, M>) {
+    this._pool = pool;
+    this._used = new Set();
+  }
+
+  fireAndForget(payload: Payload<D, M>): void {
+    this._pool.fireAndForget(payload);
+  }
+
+  requestResponse(payload: Payload<D, M>): Single<Payload<D, M>> {
+    return this._pool._requestResponse(payload, this._used);
+  }
+
+  requestStream(payload: Payload<D, M>): Flowable<Payload<D, M>> {
+    return this._pool.requestStream(payload);
+  }
+
+  requestChannel(payloads: Flowable<Payload<D, M>>): Flowable<Payload<D, M>> {
+    return this._pool.requestChannel(payloads);
+  }
+
+  metadataPush(payload: Payload<D, M>): Single<void> {
+    return this._pool.metadataPush(payload);
+  }
+
+  close(): void {
+    this._pool.close();
+  }
+
+  connectionStatus(): Flowable<ConnectionStatus> {
+    return this._pool.connectionStatus();
+  }
+}
+
+function noConnections(): Error {
+  return new Error('RSocketPool: No connections available.');
+}
+
+/**
+ * @private
+ */
+class PoolMember<D, M> {
+  socket: ReactiveSocket<D, M>;
+  statusSubscription: ?ISubscription;
+  _pending: number;
+  _latency: number;
+  _stamp: number;
+
+  constructor(socket: ReactiveSocket<D, M>) {
+    this.socket = socket;
+    this.statusSubscription = null;
+    this._pending = 0;
+    this._latency = INITIAL_LATENCY;
+    this._stamp = Date.now();
+  }
+
+  cost(): number {
+    return this._latency * (this._pending + 1);
+  }
+
+  start(): number {
+    this._pending++;
+    return Date.now();
+  }
+
+  end(start: number, record: boolean): void {
+    this._pending--;
+    if (record) {
+      this.observe(Date.now() - start);
+    }
+  }
+
+  observe(latency: number): void {
+    const now = Date.now();
+    if (latency > this._latency) {
+      // React to latency spikes immediately, decay back slowly
+      this._latency = latency;
+    } else {
+      const weight = Math.exp(-(now - this._stamp) / DECAY_TIME);
+      this._latency = this._latency * weight + latency * (1 - weight);
+    }
+    this._stamp = now;
+  }
+}
+
+/**
+ * Counts a stream as outstanding until it terminates and records the time to
+ * its first element as the connection's latency.
+ *
+ * @private
+ */
+class PoolSubscriber<T> implements ISubscriber<T>, ISubscription {
+  _actual: ISubscriber<T>;
+  _member: PoolMember<any, any>;
+  _subscription: ?ISubscription;
+  _start: number;
+  _first: boolean;
+  _active: boolean;
+
+  constructor(actual: ISubscriber<T>, member: PoolMember<any, any>) {
+    this._actual = actual;
+    this._member = member;
+    this._subscription = null;
+    this._start = member.start();
+    this._first = true;
+    this._active = true;
+  }
+
+  onSubscribe(subscription: ISubscription) {
+    this._subscription = subscription;
+    this._actual.onSubscribe(this);
+  }
+
+  onNext(value: T) {
+    if (this._first) {
+      this._first = false;
+      this._member.observe(Date.now() - this._start);
+    }
+    this._actual.onNext(value);
+  }
+
+  onError(error: Error) {
+    this._end();
+    this._actual.onError(error);
+  }
+
+  onComplete() {
+    this._end();
+    this._actual.onComplete();
+  }
+
+  request(n: number) {
+    this._subscription && this._subscription.request(n);
+  }
+
+  cancel() {
+    this._end();
+    this._subscription && this._subscription.cancel();
+  }
+
+  _end() {
+    if (this._active) {
+      this._active = false;
+      this._member.end(this._start, false);
+    }
+  }
+}
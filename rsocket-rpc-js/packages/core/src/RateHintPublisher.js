@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {ReactiveSocket} from 'rsocket-types';
+import type {RateHint} from 'rsocket-rpc-frames';
+import type PriorityScheduler from './PriorityScheduler';
+
+import {encodeRateHints} from 'rsocket-rpc-frames';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+
+/**
+ * Pushes rate hints to the clients connected to a server, as the metadata of
+ * metadata pushes, for a RateLimiter on their side to throttle their calls
+ * by. Clients are added with the socket a server hands its request handler
+ * for each connection, and get the hints in effect at once. Hints without a
+ * limit or a retry after lift those pushed before for their method. Hints
+ * are either published by hand or derived from the calls waiting in a
+ * PriorityScheduler, see track().
+ */
+export default class RateHintPublisher {
+  _sockets: Set<ReactiveSocket<Buffer, Buffer>>;
+  _hints: Map<string, RateHint>;
+
+  constructor() {
+    this._sockets = new Set();
+    this._hints = new Map();
+  }
+
+  /**
+   * Pushes hints to `socket` until it closes
+   */
+  add(socket: ReactiveSocket<Buffer, Buffer>): void {
+    this._sockets.add(socket);
+    socket.connectionStatus().subscribe({
+      onNext: status => {
+        if (status.kind === 'CLOSED' || status.kind === 'ERROR') {
+          this._sockets.delete(socket);
+        }
+      },
+      onSubscribe: subscription => subscription.request(MAX_REQUEST_N),
+    });
+    if (this._hints.size > 0) {
+      push(socket, encodeRateHints(Array.from(this._hints.values())));
+    }
+  }
+
+  /**
+   * Pushes hints to every client, in place of those published before for the
+   * same methods
+   */
+  publish(hints: Array<RateHint>): void {
+    hints.forEach(hint => {
+      const key = hint.service + '/' + hint.method;
+      if (hint.maxInFlight > 0 || hint.retryAfter > 0) {
+        this._hints.set(key, hint);
+      } else {
+        this._hints.delete(key);
+      }
+    });
+    const metadata = encodeRateHints(hints);
+    this._sockets.forEach(socket => push(socket, metadata));
+  }
+
+  /**
+   * Publishes hints for the methods with calls waiting in `scheduler` every
+   * `interval` milliseconds, 1000 by default, until the returned function is
+   * called. Each hint carries the number of the method's calls waiting, and
+   * asks each client to keep at most its share of the calls the scheduler
+   * runs at once in flight to such a method. While more calls wait
+   * than the scheduler runs at once, clients are also asked to hold off until
+   * the next hints. The hints of methods whose calls no longer wait are
+   * lifted.
+   */
+  track(scheduler: PriorityScheduler, interval?: number): () => void {
+    const period = interval || 1000;
+    let tracked: Map<string, RateHint> = new Map();
+    const timer = setInterval(() => {
+      const loads = scheduler.load();
+      const maxConcurrent = scheduler.maxConcurrent();
+      const queued = loads.reduce((sum, load) => sum + load.queued, 0);
+      const maxInFlight = Math.max(
+        1,
+        Math.floor(maxConcurrent / Math.max(1, this._sockets.size)),
+      );
+      const retryAfter = queued > maxConcurrent ? period : 0;
+      const hints = [];
+      const next = new Map();
+      loads.forEach(load => {
+        const {method, service} = load;
+        const key = service + '/' + method;
+        const hint = {
+          maxInFlight,
+          method,
+          queueDepth: load.queued,
+          retryAfter,
+          service,
+        };
+        const last = tracked.get(key);
+        // Retry afters are sent again for as long as they last
+        if (
+          !last ||
+          last.maxInFlight !== maxInFlight ||
+          last.queueDepth !== hint.queueDepth ||
+          retryAfter > 0
+        ) {
+          hints.push(hint);
+        }
+        next.set(key, hint);
+      });
+      tracked.forEach(({method, service}, key) => {
+        if (!next.has(key)) {
+          hints.push({
+            maxInFlight: 0,
+            method,
+            queueDepth: 0,
+            retryAfter: 0,
+            service,
+          });
+        }
+      });
+      tracked = next;
+      if (hints.length > 0) {
+        this.publish(hints);
+      }
+    }, period);
+    // Tracking alone does not keep the process running
+    timer.unref && timer.unref();
+    return () => clearInterval(timer);
+  }
+
+  /**
+   * The number of clients hints are pushed to
+   */
+  size(): number {
+    return this._sockets.size;
+  }
+}
+
+function push(socket: ReactiveSocket<Buffer, Buffer>, metadata: Buffer): void {
+  // A client that cannot take the push is dropped once its connection closes
+  socket.metadataPush({data: null, metadata}).subscribe({onError: () => {}});
+}
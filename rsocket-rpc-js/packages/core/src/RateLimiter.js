@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {
+  ConnectionStatus,
+  Payload,
+  ReactiveSocket,
+  Responder,
+} from 'rsocket-types';
+import type {RateHint} from 'rsocket-rpc-frames';
+import type {Call, Gate} from './Admission';
+
+import {Flowable, Single} from 'rsocket-flowable';
+import {
+  decodeRateHints,
+  getMethod,
+  getServiceId,
+  serviceId,
+} from 'rsocket-rpc-frames';
+import {admitFlowable, admitSingle} from './Admission';
+import SwitchTransformOperator from './SwitchTransformOperator';
+
+type MethodState = {
+  hint: ?RateHint,
+  retryAt: number,
+  inFlight: number,
+  waiting: Array<Call>,
+  timer: any,
+};
+
+/**
+ * Throttles calls by the rate hints servers push, see RateHintPublisher.
+ * Calls to a method are held back, in the order they were made, while the
+ * server asked to retry it later, or while as many calls as it suggested are
+ * in flight. Hints reach the limiter through the responder of the client,
+ * see responder(), and the calls through the sockets it wraps, see wrap(),
+ * which generated clients are handed in place of the connection. Methods are
+ * told apart by the interned id of their service, see serviceId(), which is
+ * all the headers of clients generated for version 2 metadata carry.
+ */
+export default class RateLimiter {
+  _methods: Map<string, MethodState>;
+
+  constructor() {
+    this._methods = new Map();
+  }
+
+  /**
+   * A responder taking the rate hints pushed to it, which hands everything
+   * else to `responder`
+   */
+  responder(responder?: ?Responder<Buffer, Buffer>): Responder<Buffer, Buffer> {
+    return new HintedResponder(this, responder);
+  }
+
+  /**
+   * A socket calling through `socket` once this limiter admits each call
+   */
+  wrap(socket: ReactiveSocket<Buffer, Buffer>): ReactiveSocket<Buffer, Buffer> {
+    return new RateLimitedRSocket(socket, this);
+  }
+
+  /**
+   * Applies the hints a server pushed, replacing those it pushed before for
+   * the same methods. Hints without a limit or a retry after lift them.
+   */
+  update(hints: Array<RateHint>): void {
+    hints.forEach(hint => {
+      const key = methodKey(serviceId(hint.service), hint.method);
+      const state = this._state(key);
+      const lifted = hint.maxInFlight === 0 && hint.retryAfter === 0;
+      state.hint = lifted ? null : hint;
+      state.retryAt = hint.retryAfter > 0 ? Date.now() + hint.retryAfter : 0;
+      if (state.timer) {
+        clearTimeout(state.timer);
+        state.timer = null;
+      }
+      this._drain(key, state);
+    });
+  }
+
+  /**
+   * The hint in effect for a method, whose queue depth tells how many of its
+   * calls waited on the server when the hint was sent
+   */
+  hint(service: string, method: string): ?RateHint {
+    const state = this._methods.get(methodKey(serviceId(service), method));
+    return state ? state.hint : null;
+  }
+
+  /**
+   * The number of calls to a method held back
+   */
+  waiting(service: string, method: string): number {
+    const state = this._methods.get(methodKey(serviceId(service), method));
+    return state ? state.waiting.length : 0;
+  }
+
+  /**
+   * Admits the calls of requests with the given routing metadata
+   */
+  gate(metadata: Buffer): Gate {
+    const key = methodKey(getServiceId(metadata), getMethod(metadata));
+    return {
+      admit: call => this._admit(key, call),
+      release: () => this._release(key),
+      withdraw: call => this._withdraw(key, call),
+    };
+  }
+
+  _state(key: string): MethodState {
+    let state = this._methods.get(key);
+    if (!state) {
+      state = {hint: null, inFlight: 0, retryAt: 0, timer: null, waiting: []};
+      this._methods.set(key, state);
+    }
+    return state;
+  }
+
+  _admit(key: string, call: Call): void {
+    const state = this._state(key);
+    state.waiting.push(call);
+    this._drain(key, state);
+  }
+
+  _withdraw(key: string, call: Call): void {
+    const state = this._methods.get(key);
+    const index = state ? state.waiting.indexOf(call) : -1;
+    if (state && index !== -1) {
+      state.waiting.splice(index, 1);
+      this._prune(key, state);
+    }
+  }
+
+  _release(key: string): void {
+    const state = this._methods.get(key);
+    if (state) {
+      state.inFlight--;
+      this._drain(key, state);
+    }
+  }
+
+  _drain(key: string, state: MethodState): void {
+    const now = Date.now();
+    if (state.retryAt > now) {
+      if (!state.timer && state.waiting.length > 0) {
+        state.timer = setTimeout(() => {
+          state.timer = null;
+          this._drain(key, state);
+        }, state.retryAt - now);
+      }
+      return;
+    }
+    const maxInFlight = state.hint ? state.hint.maxInFlight : 0;
+    while (
+      state.waiting.length > 0 &&
+      (maxInFlight === 0 || state.inFlight < maxInFlight)
+    ) {
+      const call = state.waiting.shift();
+      state.inFlight++;
+      call.start();
+    }
+    this._prune(key, state);
+  }
+
+  // Forgets methods without a hint in effect once their calls are over
+  _prune(key: string, state: MethodState): void {
+    if (
+      !state.hint &&
+      !state.timer &&
+      state.inFlight === 0 &&
+      state.waiting.length === 0
+    ) {
+      this._methods.delete(key);
+    }
+  }
+}
+
+function methodKey(id: number, method: string): string {
+  return id + '/' + method;
+}
+
+/**
+ * Routes each call through the limiter by the service and method of its
+ * metadata. Calls without metadata are sent at once.
+ */
+class RateLimitedRSocket implements ReactiveSocket<Buffer, Buffer> {
+  _socket: ReactiveSocket<Buffer, Buffer>;
+  _limiter: RateLimiter;
+
+  constructor(socket: ReactiveSocket<Buffer, Buffer>, limiter: RateLimiter) {
+    this._socket = socket;
+    this._limiter = limiter;
+  }
+
+  fireAndForget(payload: Payload<Buffer, Buffer>): void {
+    const metadata = payload.metadata;
+    if (metadata == null) {
+      this._socket.fireAndForget(payload);
+      return;
+    }
+    admitSingle(this._limiter.gate(metadata), () => {
+      this._socket.fireAndForget(payload);
+      return Single.of(undefined);
+    }).subscribe({onError: () => {}});
+  }
+
+  requestResponse(
+    payload: Payload<Buffer, Buffer>,
+  ): Single<Payload<Buffer, Buffer>> {
+    const metadata = payload.metadata;
+    if (metadata == null) {
+      return this._socket.requestResponse(payload);
+    }
+    return admitSingle(this._limiter.gate(metadata), () =>
+      this._socket.requestResponse(payload),
+    );
+  }
+
+  requestStream(
+    payload: Payload<Buffer, Buffer>,
+  ): Flowable<Payload<Buffer, Buffer>> {
+    const metadata = payload.metadata;
+    if (metadata == null) {
+      return this._socket.requestStream(payload);
+    }
+    return admitFlowable(this._limiter.gate(metadata), () =>
+      this._socket.requestStream(payload),
+    );
+  }
+
+  requestChannel(
+    payloads: Flowable<Payload<Buffer, Buffer>>,
+  ): Flowable<Payload<Buffer, Buffer>> {
+    // The method of a channel is known from its first payload. Its requests
+    // are observed by the generated client that sent them, not here.
+    return payloads.lift(
+      s =>
+        new SwitchTransformOperator(s, (payload, flowable) => {
+          const metadata = payload.metadata;
+          if (metadata == null) {
+            return this._socket.requestChannel(flowable);
+          }
+          return admitFlowable(this._limiter.gate(metadata), () =>
+            this._socket.requestChannel(flowable),
+          );
+        }),
+    );
+  }
+
+  metadataPush(payload: Payload<Buffer, Buffer>): Single<void> {
+    return this._socket.metadataPush(payload);
+  }
+
+  close(): void {
+    this._socket.close();
+  }
+
+  connectionStatus(): Flowable<ConnectionStatus> {
+    return this._socket.connectionStatus();
+  }
+}
+
+/**
+ * @private
+ */
+class HintedResponder implements Responder<Buffer, Buffer> {
+  _limiter: RateLimiter;
+  _responder: any;
+
+  constructor(limiter: RateLimiter, responder: ?Responder<Buffer, Buffer>) {
+    this._limiter = limiter;
+    this._responder = responder || {};
+  }
+
+  fireAndForget(payload: Payload<Buffer, Buffer>): void {
+    if (this._responder.fireAndForget) {
+      this._responder.fireAndForget(payload);
+    }
+  }
+
+  requestResponse(
+    payload: Payload<Buffer, Buffer>,
+  ): Single<Payload<Buffer, Buffer>> {
+    return this._responder.requestResponse
+      ? this._responder.requestResponse(payload)
+      : Single.error(new Error('requestResponse() is not implemented'));
+  }
+
+  requestStream(
+    payload: Payload<Buffer, Buffer>,
+  ): Flowable<Payload<Buffer, Buffer>> {
+    return this._responder.requestStream
+      ? this._responder.requestStream(payload)
+      : Flowable.error(new Error('requestStream() is not implemented'));
+  }
+
+  requestChannel(
+    payloads: Flowable<Payload<Buffer, Buffer>>,
+  ): Flowable<Payload<Buffer, Buffer>> {
+    return this._responder.requestChannel
+      ? this._responder.requestChannel(payloads)
+      : Flowable.error(new Error('requestChannel() is not implemented'));
+  }
+
+  metadataPush(payload: Payload<Buffer, Buffer>): Single<void> {
+    const hints = decodeRateHints(payload.metadata);
+    if (hints) {
+      this._limiter.update(hints);
+      return Single.of(undefined);
+    }
+    return this._responder.metadataPush
+      ? this._responder.metadataPush(payload)
+      : Single.error(new Error('metadataPush() is not implemented'));
+  }
+}
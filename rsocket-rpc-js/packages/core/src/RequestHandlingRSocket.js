@@ -17,37 +17,94 @@
  */
 
 import type {Responder, Payload} from 'rsocket-types';
+import type {FlowObserver} from './FlowObserver';
 
 import {Flowable, Single} from 'rsocket-flowable';
 
-import {getService} from 'rsocket-rpc-frames';
+import {getMethod, getService, internService} from 'rsocket-rpc-frames';
 import SwitchTransformOperator from './SwitchTransformOperator';
+import PriorityScheduler, {PRIORITY_NORMAL} from './PriorityScheduler';
 
+// Generated servers route a channel on a first payload peeked by the caller
+type ChannelHandler = {
+  handleChannel(
+    payload: Payload<Buffer, Buffer>,
+    payloads: Flowable<Payload<Buffer, Buffer>>,
+  ): Flowable<Payload<Buffer, Buffer>>,
+};
+
+// Generated servers observe the requests of client streaming methods
+type ObservedHandler = {
+  channelFlow(payload: Payload<Buffer, Buffer>): ?FlowObserver,
+};
+
+// Generated servers of services with prioritized methods
+type PrioritizedHandler = {
+  priorities: {[method: string]: number},
+};
+
+/**
+ * Routes requests to the handler registered for their service. Given a
+ * PriorityScheduler, it admits them by the priorities generated servers
+ * declare for their methods.
+ */
 export default class RequestHandlingRSocket
   implements Responder<Buffer, Buffer> {
   _registeredServices: Map<string, Responder<Buffer, Buffer>>;
+  _scheduler: ?PriorityScheduler;
 
-  constructor() {
+  constructor(scheduler?: ?PriorityScheduler) {
     this._registeredServices = new Map();
+    this._scheduler = scheduler;
   }
 
   addService(service: string, handler: Responder<Buffer, Buffer>) {
+    // Lets clients address the service by its interned id
+    internService(service);
     this._registeredServices.set(service, handler);
   }
 
+  getHandler(service: string): ?Responder<Buffer, Buffer> {
+    return this._registeredServices.get(service);
+  }
+
+  /**
+   * The scheduler requests are admitted by, if any
+   */
+  getScheduler(): ?PriorityScheduler {
+    return this._scheduler;
+  }
+
   fireAndForget(payload: Payload<Buffer, Buffer>): void {
     if (payload.metadata == null) {
       throw new Error('metadata is empty');
     }
 
-    const service = getService(payload.metadata);
+    const metadata = payload.metadata;
+    const service = getService(metadata);
     const handler = this._registeredServices.get(service);
 
     if (handler == null) {
       throw new Error('can not find service ' + service);
     }
 
-    handler.fireAndForget(payload);
+    const scheduler = this._scheduler;
+    if (scheduler) {
+      const method = getMethod(metadata);
+      scheduler
+        .single(
+          methodPriority(handler, method),
+          () => {
+            handler.fireAndForget(payload);
+            return Single.of(undefined);
+          },
+          service,
+          method,
+        )
+        .subscribe({onError: () => {}});
+    } else {
+      handler.fireAndForget(payload);
+    }
   }
 
   requestResponse(
@@ -58,13 +115,24 @@ export default class RequestHandlingRSocket
         return Single.error(new Error('metadata is empty'));
       }
 
-      const service = getService(payload.metadata);
+      const metadata = payload.metadata;
+      const service = getService(metadata);
       const handler = this._registeredServices.get(service);
 
       if (handler == null) {
         return Single.error(new Error('can not find service ' + service));
       }
 
+      const scheduler = this._scheduler;
+      if (scheduler) {
+        const method = getMethod(metadata);
+        return scheduler.single(
+          methodPriority(handler, method),
+          () => handler.requestResponse(payload),
+          service,
+          method,
+        );
+      }
       return handler.requestResponse(payload);
     } catch (error) {
       return Single.error(error);
@@ -79,13 +147,24 @@ export default class RequestHandlingRSocket
         return Flowable.error(new Error('metadata is empty'));
       }
 
-      const service = getService(payload.metadata);
+      const metadata = payload.metadata;
+      const service = getService(metadata);
       const handler = this._registeredServices.get(service);
 
       if (handler == null) {
         return Flowable.error(new Error('can not find service ' + service));
       }
 
+      const scheduler = this._scheduler;
+      if (scheduler) {
+        const method = getMethod(metadata);
+        return scheduler.flowable(
+          methodPriority(handler, method),
+          () => handler.requestStream(payload),
+          service,
+          method,
+        );
+      }
       return handler.requestStream(payload);
     } catch (error) {
       return Flowable.error(error);
@@ -95,27 +174,68 @@ export default class RequestHandlingRSocket
   requestChannel(
     payloads: Flowable<Payload<Buffer, Buffer>>,
   ): Flowable<Payload<Buffer, Buffer>> {
-    return new Flowable(s => payloads.subscribe(s)).lift(
+    // The first payload is peeked once, here, and handed to the service
+    return payloads.lift(
       s =>
-        new SwitchTransformOperator(s, (payload, flowable) => {
-          if (payload.metadata === undefined || payload.metadata === null) {
-            return Flowable.error(new Error('metadata is empty'));
-          } else {
-            const service = getService(payload.metadata);
-            const handler = this._registeredServices.get(service);
-            if (handler === undefined || handler === null) {
-              return Flowable.error(
-                new Error('can not find service ' + service),
-              );
+        new SwitchTransformOperator(
+          s,
+          (payload, flowable) => {
+            if (payload.metadata === undefined || payload.metadata === null) {
+              return Flowable.error(new Error('metadata is empty'));
             } else {
-              return handler.requestChannel(flowable);
+              const metadata = payload.metadata;
+              const service = getService(metadata);
+              const handler = this._registeredServices.get(service);
+              if (handler === undefined || handler === null) {
+                return Flowable.error(
+                  new Error('can not find service ' + service),
+                );
+              }
+              const scheduler = this._scheduler;
+              const channel = () =>
+                typeof (handler: any).handleChannel === 'function'
+                  ? ((handler: any): ChannelHandler).handleChannel(
+                      payload,
+                      flowable,
+                    )
+                  : handler.requestChannel(flowable);
+              if (!scheduler) {
+                return channel();
+              }
+              const method = getMethod(metadata);
+              return scheduler.flowable(
+                methodPriority(handler, method),
+                channel,
+                service,
+                method,
+              );
             }
-          }
-        }),
+          },
+          payload => this._channelFlow(payload),
+        ),
     );
   }
 
   metadataPush(payload: Payload<Buffer, Buffer>): Single<void> {
     return Single.error(new Error('metadataPush() is not implemented'));
   }
+
+  // The observer of the requests of a channel, picked by its handler
+  _channelFlow(payload: Payload<Buffer, Buffer>): ?FlowObserver {
+    if (payload.metadata == null) {
+      return null;
+    }
+    const handler = this._registeredServices.get(getService(payload.metadata));
+    return handler && typeof (handler: any).channelFlow === 'function'
+      ? ((handler: any): ObservedHandler).channelFlow(payload)
+      : null;
+  }
+}
+
+/**
+ * The priority a generated server declares for one of its methods
+ */
+export function methodPriority(handler: any, method: string): number {
+  const priorities = (handler: PrioritizedHandler).priorities;
+  return (priorities && priorities[method]) || PRIORITY_NORMAL;
 }
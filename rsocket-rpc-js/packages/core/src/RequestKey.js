@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+/**
+ * Builds a key that is equal for byte-identical requests sent with
+ * byte-identical user metadata. The data length prefix keeps the boundary
+ * between the two unambiguous.
+ *
+ * With `names`, e.g. those of a method's `cache_key_metadata` option, only
+ * the values of the named entries of the metadata go into the key. The
+ * metadata is then read as key/value pairs in the encoding of the tracing
+ * map; metadata that is not is keyed as a whole.
+ */
+export default function requestKey(
+  data: Buffer,
+  metadata: ?Buffer,
+  names?: ?Array<string>,
+): string {
+  const key = data.length + ':' + data.toString('latin1');
+  if (!metadata || metadata.length === 0) {
+    return key;
+  }
+  const values = names ? namedValues(metadata, names) : null;
+  return values ? key + values : key + metadata.toString('latin1');
+}
+
+// The values of the entries of `metadata` named by `names`, in their order,
+// each prefixed with its length, and a '-' for those missing
+function namedValues(metadata: Buffer, names: Array<string>): ?string {
+  const values: Array<?string> = names.map(() => null);
+  let offset = 0;
+  while (offset < metadata.length) {
+    if (offset + 2 > metadata.length) {
+      return null;
+    }
+    const keyEnd = offset + 2 + metadata.readUInt16BE(offset);
+    if (keyEnd + 2 > metadata.length) {
+      return null;
+    }
+    const valueEnd = keyEnd + 2 + metadata.readUInt16BE(keyEnd);
+    if (valueEnd > metadata.length) {
+      return null;
+    }
+    const index = names.indexOf(metadata.toString('utf8', offset + 2, keyEnd));
+    if (index !== -1) {
+      values[index] = metadata.toString('latin1', keyEnd + 2, valueEnd);
+    }
+    offset = valueEnd;
+  }
+  return values
+    .map(value => (value == null ? '-' : value.length + ':' + value))
+    .join('');
+}
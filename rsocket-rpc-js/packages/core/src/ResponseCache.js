@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+type CacheEntry = {|
+  value: Buffer,
+  expires: number,
+|};
+
+// Anything with an inc() method, e.g. a Counter from rsocket-rpc-metrics
+type Increment = {inc(): void};
+
+/**
+ * A least-recently-used cache of serialized responses, keyed by requestKey(),
+ * used by generated clients for methods marked `cacheable`. Entries expire
+ * `ttl` milliseconds after they are stored; a `ttl` of zero keeps them until
+ * they are evicted.
+ */
+export default class ResponseCache {
+  _entries: Map<string, CacheEntry>;
+  _maxEntries: number;
+  _ttl: number;
+  _hits: ?Increment;
+  _misses: ?Increment;
+
+  constructor(
+    maxEntries: number,
+    ttl: number,
+    hits?: ?Increment,
+    misses?: ?Increment,
+  ) {
+    this._entries = new Map();
+    this._maxEntries = maxEntries;
+    this._ttl = ttl;
+    this._hits = hits;
+    this._misses = misses;
+  }
+
+  get(key: string): ?Buffer {
+    const entry = this._entries.get(key);
+    if (entry) {
+      this._entries.delete(key);
+      if (this._ttl <= 0 || entry.expires > Date.now()) {
+        // Re-inserting moves the entry to the most recently used end
+        this._entries.set(key, entry);
+        this._hits && this._hits.inc();
+        return entry.value;
+      }
+    }
+    this._misses && this._misses.inc();
+    return null;
+  }
+
+  put(key: string, value: Buffer | Uint8Array): void {
+    this._entries.delete(key);
+    this._entries.set(key, {
+      // Copy so the cache does not pin the frame the response arrived in
+      value: Buffer.from(value),
+      expires: this._ttl > 0 ? Date.now() + this._ttl : Infinity,
+    });
+    if (this._entries.size > this._maxEntries) {
+      this._entries.delete(this._entries.keys().next().value);
+    }
+  }
+
+  size(): number {
+    return this._entries.size;
+  }
+
+  clear(): void {
+    this._entries.clear();
+  }
+}
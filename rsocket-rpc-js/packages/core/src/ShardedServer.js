@@ -0,0 +1,288 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import type {ReactiveSocket, Payload, Responder} from 'rsocket-types';
+import type {Encoders} from 'rsocket-core/build/RSocketEncoding';
+import type {PayloadSerializers} from 'rsocket-core/build/RSocketSerialization';
+
+import {Flowable, Single} from 'rsocket-flowable';
+import {BufferEncoders, RSocketServer} from 'rsocket-core';
+
+import PortDuplexConnection, {
+  ACK_SIZE,
+  transferable,
+} from './PortDuplexConnection';
+import {getWorkerThreads} from './WorkerThreads';
+
+export type ShardedServerOptions = {
+  workers?: number,
+  workerData?: mixed,
+  highWaterMark?: number,
+};
+
+type RequestHandler = (
+  socket: ReactiveSocket<Buffer, Buffer>,
+  setup: Payload<Buffer, Buffer>,
+) => Responder<Buffer, Buffer>;
+
+export type ShardOptions = {
+  encoders?: ?Encoders<*>,
+  serializers?: PayloadSerializers<Buffer, Buffer>,
+};
+
+type Shard = {
+  worker: Object,
+  sockets: Set<Object>,
+  started: number,
+  failures: number,
+};
+
+const DEFAULT_HIGH_WATER_MARK = 1024 * 1024;
+
+// Workers exiting sooner than this after they started are restarted after a
+// delay, doubling from the minimum with each such exit
+const STABLE_TIME = 10000;
+const MIN_RESTART_DELAY = 100;
+const MAX_RESTART_DELAY = 30000;
+
+/**
+ * Serves RSocket connections on several cores. The main thread accepts TCP
+ * connections and hands each one to the worker thread serving the fewest,
+ * which runs `filename`; it serves them with serveShard(). The main thread
+ * only moves bytes: each chunk read from a connection is transferred to its
+ * worker, which decodes the frames and runs the responders, and the bytes the
+ * worker writes are transferred back. `workers` defaults to the number of
+ * CPUs, and `workerData` is handed to each of them.
+ *
+ * A connection is no longer read while its worker has more than
+ * `highWaterMark` bytes of it unacknowledged, 1MB by default, or while the
+ * bytes written back to it are not flushed. Workers that keep exiting are
+ * restarted with an exponential backoff.
+ */
+export default class ShardedServer {
+  _filename: string;
+  _options: ShardedServerOptions;
+  _shards: Array<Shard>;
+  _server: ?Object;
+  _closed: boolean;
+  _restarts: Set<TimeoutID>;
+
+  constructor(filename: string, options?: ShardedServerOptions) {
+    this._filename = filename;
+    this._options = options || {};
+    this._shards = [];
+    this._server = null;
+    this._closed = false;
+    this._restarts = new Set();
+  }
+
+  /**
+   * Starts the workers and accepts connections on `port`
+   */
+  listen(port: number, host?: string): Single<void> {
+    return new Single(subscriber => {
+      subscriber.onSubscribe();
+      const size = this._options.workers || require('os').cpus().length;
+      while (this._shards.length < size) {
+        this._shards.push(this._startShard());
+      }
+      const server = require('net').createServer(socket =>
+        this._handleConnection(socket),
+      );
+      this._server = server;
+      server.once('error', error => subscriber.onError(error));
+      server.listen(port, host, () => subscriber.onComplete());
+    });
+  }
+
+  /**
+   * The number of connections each worker serves
+   */
+  connections(): Array<number> {
+    return this._shards.map(shard => shard.sockets.size);
+  }
+
+  close(): void {
+    this._closed = true;
+    this._server && this._server.close();
+    this._restarts.forEach(timeout => clearTimeout(timeout));
+    this._restarts.clear();
+    this._shards.forEach(shard => {
+      shard.sockets.forEach(socket => socket.destroy());
+      shard.worker.terminate();
+    });
+    this._shards = [];
+  }
+
+  _startShard(failures?: number): Shard {
+    const {Worker} = getWorkerThreads();
+    const shard = {
+      failures: failures || 0,
+      sockets: new Set(),
+      started: Date.now(),
+      worker: new Worker(this._filename, {
+        workerData: this._options.workerData,
+      }),
+    };
+    // The connections of a worker that failed are dropped, and a new worker
+    // takes its place
+    shard.worker.on('error', () => {});
+    shard.worker.on('exit', () => {
+      const index = this._shards.indexOf(shard);
+      if (index === -1) {
+        return;
+      }
+      shard.sockets.forEach(socket => socket.destroy());
+      this._shards.splice(index, 1);
+      if (!this._closed) {
+        this._restartShard(shard);
+      }
+    });
+    return shard;
+  }
+
+  _restartShard(shard: Shard): void {
+    const stable = Date.now() - shard.started >= STABLE_TIME;
+    const failures = stable ? 0 : shard.failures + 1;
+    const delay = stable
+      ? 0
+      : Math.min(
+          MAX_RESTART_DELAY,
+          MIN_RESTART_DELAY * Math.pow(2, shard.failures),
+        );
+    const timeout = setTimeout(() => {
+      this._restarts.delete(timeout);
+      this._shards.push(this._startShard(failures));
+    }, delay);
+    this._restarts.add(timeout);
+  }
+
+  _handleConnection(socket: Object): void {
+    if (this._shards.length === 0) {
+      socket.destroy();
+      return;
+    }
+    let shard = this._shards[0];
+    this._shards.forEach(candidate => {
+      if (candidate.sockets.size < shard.sockets.size) {
+        shard = candidate;
+      }
+    });
+    shard.sockets.add(socket);
+
+    const {MessageChannel} = getWorkerThreads();
+    const {port1, port2} = new MessageChannel();
+    shard.worker.postMessage({port: port2}, [port2]);
+
+    let ended = false;
+    const end = () => {
+      if (!ended) {
+        ended = true;
+        port1.postMessage(null);
+        port1.close();
+      }
+    };
+
+    // Bytes handed to the worker that it has not acknowledged yet
+    let unacknowledged = 0;
+    let flushing = false;
+    let paused = false;
+    const highWaterMark = Math.max(
+      this._options.highWaterMark || DEFAULT_HIGH_WATER_MARK,
+      ACK_SIZE,
+    );
+    const throttle = () => {
+      const pause = flushing || unacknowledged > highWaterMark;
+      if (pause !== paused) {
+        paused = pause;
+        if (pause) {
+          socket.pause();
+        } else {
+          socket.resume();
+        }
+      }
+    };
+
+    socket.on('data', chunk => {
+      unacknowledged += chunk.length;
+      const data = transferable(chunk);
+      port1.postMessage(data, [data]);
+      throttle();
+    });
+    socket.on('drain', () => {
+      flushing = false;
+      throttle();
+    });
+    socket.on('end', end);
+    socket.on('error', end);
+    socket.on('close', () => {
+      shard.sockets.delete(socket);
+      end();
+    });
+    port1.on('message', data => {
+      if (data == null) {
+        socket.end();
+      } else if (typeof data === 'number') {
+        unacknowledged -= data;
+        throttle();
+      } else if (!socket.write(Buffer.from(data))) {
+        flushing = true;
+        throttle();
+      }
+    });
+    port1.on('close', () => socket.destroy());
+  }
+}
+
+/**
+ * Serves the connections a ShardedServer hands to the worker thread this runs
+ * in, with the given responder, e.g. a RequestHandlingRSocket with generated
+ * servers registered, or with the responder returned for each connection.
+ * Frames are encoded with BufferEncoders unless `encoders` are given.
+ */
+export function serveShard(
+  handler: Responder<Buffer, Buffer> | RequestHandler,
+  options?: ShardOptions,
+): RSocketServer<Buffer, Buffer> {
+  const {parentPort} = getWorkerThreads();
+  const encoders =
+    options && options.encoders ? options.encoders : BufferEncoders;
+  const getRequestHandler: RequestHandler =
+    typeof handler === 'function' ? handler : () => (handler: any);
+  const server = new RSocketServer({
+    getRequestHandler,
+    serializers: options && options.serializers,
+    transport: {
+      start: () =>
+        new Flowable(subscriber => {
+          const onMessage = message =>
+            subscriber.onNext(new PortDuplexConnection(message.port, encoders));
+          subscriber.onSubscribe({
+            cancel: () => parentPort.removeListener('message', onMessage),
+            request: () => {},
+          });
+          parentPort.on('message', onMessage);
+        }),
+      stop: () => {},
+    },
+  });
+  server.start();
+  return server;
+}
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import {Single} from 'rsocket-flowable';
+import type {IFutureSubscriber} from 'rsocket-flowable/build/Single';
+
+type Flight<T> = {
+  subscribers: Array<IFutureSubscriber<T>>,
+  cancel: ?() => void,
+  done: boolean,
+};
+
+/**
+ * Collapses concurrent calls that share a key into a single subscription to
+ * the underlying source, fanning its result out to every caller. The source is
+ * cancelled only once every caller has cancelled.
+ */
+export default class SingleFlight<T> {
+  _flights: Map<string, Flight<T>>;
+
+  constructor() {
+    this._flights = new Map();
+  }
+
+  share(key: string, source: () => Single<T>): Single<T> {
+    return new Single(subscriber => {
+      let flight = this._flights.get(key);
+      const leader = !flight;
+      if (!flight) {
+        flight = {subscribers: [], cancel: null, done: false};
+        this._flights.set(key, flight);
+      }
+      const joined = flight;
+      joined.subscribers.push(subscriber);
+      subscriber.onSubscribe(() => this._leave(key, joined, subscriber));
+      if (leader) {
+        this._start(key, joined, source);
+      }
+    });
+  }
+
+  inFlight(): number {
+    return this._flights.size;
+  }
+
+  _start(key: string, flight: Flight<T>, source: () => Single<T>): void {
+    if (flight.done) {
+      return;
+    }
+    let single;
+    try {
+      single = source();
+    } catch (error) {
+      this._finish(key, flight).forEach(s => s.onError(error));
+      return;
+    }
+    single.subscribe({
+      onComplete: value => {
+        this._finish(key, flight).forEach(s => s.onComplete(value));
+      },
+      onError: error => {
+        this._finish(key, flight).forEach(s => s.onError(error));
+      },
+      onSubscribe: cancel => {
+        if (flight.done) {
+          cancel && cancel();
+        } else {
+          flight.cancel = cancel;
+        }
+      },
+    });
+  }
+
+  _finish(key: string, flight: Flight<T>): Array<IFutureSubscriber<T>> {
+    if (this._flights.get(key) === flight) {
+      this._flights.delete(key);
+    }
+    flight.done = true;
+    const subscribers = flight.subscribers;
+    flight.subscribers = [];
+    return subscribers;
+  }
+
+  _leave(
+    key: string,
+    flight: Flight<T>,
+    subscriber: IFutureSubscriber<T>,
+  ): void {
+    const index = flight.subscribers.indexOf(subscriber);
+    if (index === -1) {
+      return;
+    }
+    flight.subscribers.splice(index, 1);
+    if (flight.subscribers.length === 0) {
+      this._finish(key, flight);
+      flight.cancel && flight.cancel();
+    }
+  }
+}
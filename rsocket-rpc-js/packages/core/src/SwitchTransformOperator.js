@@ -23,6 +23,7 @@ import type {
   IPublisher,
 } from 'rsocket-types';
 import {Flowable} from 'rsocket-flowable';
+import type {FlowObserver} from './FlowObserver';
 
 const MAX_REQUEST_N = 0x7fffffff; // uint31
 
@@ -36,13 +37,22 @@ export default class SwitchTransformOperator<T, R>
   _inner: ISubscriber<T>;
   _subscription: ISubscription;
   _transformer: (first: T, stream: Flowable<T>) => IPublisher<R>;
-
+  _observe: ?(first: T) => ?FlowObserver;
+  _flow: ?FlowObserver;
+
+  /**
+   * `observe`, when given, picks from the first element the observer, if
+   * any, of the demand for the stream passed to the transformer, including
+   * its first element until it is requested
+   */
   constructor(
     initial: ISubscriber<R>,
     transformer: (first: T, stream: Flowable<T>) => IPublisher<R>,
+    observe?: ?(first: T) => ?FlowObserver,
   ) {
     this._transformer = transformer;
     this._outer = initial;
+    this._observe = observe;
   }
 
   cancel() {
@@ -52,6 +62,7 @@ export default class SwitchTransformOperator<T, R>
 
     this._canceled = true;
     this._first = undefined;
+    this._flow && this._flow.close();
     this._subscription.cancel();
   }
 
@@ -94,6 +105,8 @@ export default class SwitchTransformOperator<T, R>
     if (!this._inner) {
       try {
         this._first = value;
+        this._flow = this._observe && this._observe(value);
+        this._flow && this._flow.buffer(value);
         const result = this._transformer(
           value,
           new Flowable(s => this.subscribe(s)),
@@ -105,6 +118,7 @@ export default class SwitchTransformOperator<T, R>
       return;
     }
 
+    this._flow && this._flow.next(value);
     this._inner.onNext(value);
   }
 
@@ -115,6 +129,7 @@ export default class SwitchTransformOperator<T, R>
 
     this._error = error;
     this._done = true;
+    this._flow && this._flow.close();
 
     if (this._inner) {
       if (!this._first) {
@@ -136,6 +151,7 @@ export default class SwitchTransformOperator<T, R>
     }
 
     this._done = true;
+    this._flow && this._flow.close();
 
     if (this._inner) {
       if (!this._first) {
@@ -152,9 +168,14 @@ export default class SwitchTransformOperator<T, R>
   }
 
   request(n: number) {
+    this._flow && this._flow.request(n);
     if (this._first) {
       const f = this._first;
       this._first = undefined;
+      if (this._flow) {
+        this._flow.unbuffer(f);
+        this._flow.next(f);
+      }
       this._inner.onNext(f);
 
       if (this._done) {
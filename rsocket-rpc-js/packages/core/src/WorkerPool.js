@@ -0,0 +1,286 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import {Single} from 'rsocket-flowable';
+
+import {getWorkerThreads} from './WorkerThreads';
+
+/**
+ * Anything tracking the state of a WorkerPool, e.g. the gauges returned by
+ * workerPool() of rsocket-rpc-metrics: its number of started workers, of
+ * workers running a call and of calls waiting for a worker.
+ */
+export type WorkerPoolObserver = {
+  workers(count: number): void,
+  busy(count: number): void,
+  queued(count: number): void,
+};
+
+export type WorkerPoolOptions = {
+  size?: number,
+  observer?: ?WorkerPoolObserver,
+};
+
+/**
+ * What a worker serves calls of methods declared with the `offload` option
+ * with, e.g. a generated `<Service>Worker`. It is handed a call's request
+ * bytes and returns its serialized response.
+ */
+export type OffloadedService = {
+  service: string,
+  handleOffloaded(
+    method: string,
+    data: Uint8Array,
+    metadata: Buffer,
+  ): Single<Uint8Array>,
+};
+
+type Task = {
+  service: string,
+  method: string,
+  data: ArrayBuffer,
+  metadata: ArrayBuffer,
+  onComplete: (data: Buffer) => void,
+  onError: (error: Error) => void,
+  cancelled: boolean,
+};
+
+type PooledWorker = {
+  worker: Object,
+  task: ?Task,
+};
+
+/**
+ * Runs calls of methods declared with the `offload` option on a pool of
+ * worker threads, so that CPU-heavy handlers do not hold up the event loop.
+ * Each worker runs `filename`, which serves the offloaded services with
+ * serveOffloaded(). Workers are started as calls arrive, up to `size`, one
+ * less than the number of CPUs when unset, and run one call at a time; other
+ * calls wait in a queue. The request bytes are copied once into a buffer that
+ * is transferred to the worker, and the response comes back the same way.
+ */
+export default class WorkerPool {
+  _filename: string;
+  _size: number;
+  _observer: ?WorkerPoolObserver;
+  _workers: Array<PooledWorker>;
+  _idle: Array<PooledWorker>;
+  _queue: Array<Task>;
+  _nextId: number;
+  _closed: boolean;
+
+  constructor(filename: string, options?: WorkerPoolOptions) {
+    this._filename = filename;
+    this._size =
+      options && options.size
+        ? options.size
+        : Math.max(1, require('os').cpus().length - 1);
+    this._observer = options && options.observer;
+    this._workers = [];
+    this._idle = [];
+    this._queue = [];
+    this._nextId = 0;
+    this._closed = false;
+  }
+
+  /**
+   * Calls `method` of `service` on a worker, with the serialized request and
+   * the metadata of the call, and emits the serialized response
+   */
+  run(
+    service: string,
+    method: string,
+    data: Uint8Array,
+    metadata: Buffer,
+  ): Single<Buffer> {
+    return new Single(subscriber => {
+      const task = {
+        service,
+        method,
+        data: copy(data),
+        metadata: copy(metadata),
+        onComplete: data => subscriber.onComplete(data),
+        onError: error => subscriber.onError(error),
+        cancelled: false,
+      };
+      subscriber.onSubscribe(() => this._cancel(task));
+      if (this._closed) {
+        task.onError(new Error('WorkerPool is closed'));
+        return;
+      }
+      this._queue.push(task);
+      this._dispatch();
+    });
+  }
+
+  /**
+   * Fails the calls waiting for a worker and stops the workers
+   */
+  close(): void {
+    this._closed = true;
+    const queue = this._queue;
+    this._queue = [];
+    queue.forEach(task => task.onError(new Error('WorkerPool is closed')));
+    this._workers.forEach(pooled => pooled.worker.terminate());
+  }
+
+  _dispatch(): void {
+    while (this._queue.length > 0) {
+      let pooled = this._idle.pop();
+      if (!pooled) {
+        if (this._workers.length >= this._size) {
+          break;
+        }
+        pooled = this._start();
+      }
+      const task = this._queue.shift();
+      pooled.task = task;
+      // Only busy workers keep the process alive
+      pooled.worker.ref();
+      pooled.worker.postMessage(
+        {
+          data: task.data,
+          metadata: task.metadata,
+          method: task.method,
+          service: task.service,
+        },
+        [task.data, task.metadata],
+      );
+    }
+    this._observe();
+  }
+
+  _start(): PooledWorker {
+    const {Worker} = getWorkerThreads();
+    const pooled = {worker: new Worker(this._filename), task: null};
+    pooled.worker.on('message', message => {
+      const task = pooled.task;
+      pooled.task = null;
+      pooled.worker.unref();
+      this._idle.push(pooled);
+      if (task && !task.cancelled) {
+        message.error != null
+          ? task.onError(new Error(message.error))
+          : task.onComplete(Buffer.from(message.data));
+      }
+      this._dispatch();
+    });
+    pooled.worker.on('error', error => this._remove(pooled, error));
+    pooled.worker.on('exit', () =>
+      this._remove(pooled, new Error('Worker exited')),
+    );
+    this._workers.push(pooled);
+    return pooled;
+  }
+
+  // Replaces a worker that failed or exited, failing the call it was running
+  _remove(pooled: PooledWorker, error: Error): void {
+    const index = this._workers.indexOf(pooled);
+    if (index === -1) {
+      return;
+    }
+    this._workers.splice(index, 1);
+    const idle = this._idle.indexOf(pooled);
+    if (idle !== -1) {
+      this._idle.splice(idle, 1);
+    }
+    const task = pooled.task;
+    pooled.task = null;
+    if (task && !task.cancelled) {
+      task.onError(error);
+    }
+    if (!this._closed) {
+      this._dispatch();
+    }
+  }
+
+  // A call being run is left to finish, and its response dropped
+  _cancel(task: Task): void {
+    task.cancelled = true;
+    const index = this._queue.indexOf(task);
+    if (index !== -1) {
+      this._queue.splice(index, 1);
+      this._observe();
+    }
+  }
+
+  _observe(): void {
+    const observer = this._observer;
+    if (observer) {
+      observer.workers(this._workers.length);
+      observer.busy(this._workers.length - this._idle.length);
+      observer.queued(this._queue.length);
+    }
+  }
+}
+
+/**
+ * Serves the calls a WorkerPool sends to the worker thread this runs in
+ */
+export function serveOffloaded(...services: Array<OffloadedService>): void {
+  const {parentPort} = getWorkerThreads();
+  const handlers: Map<string, OffloadedService> = new Map();
+  services.forEach(service => handlers.set(service.service, service));
+  parentPort.on('message', message => {
+    const fail = error =>
+      parentPort.postMessage({error: String(error && error.message)});
+    const handler = handlers.get(message.service);
+    if (!handler) {
+      fail(new Error('can not find service ' + message.service));
+      return;
+    }
+    let response;
+    try {
+      response = handler.handleOffloaded(
+        message.method,
+        new Uint8Array(message.data),
+        Buffer.from(message.metadata),
+      );
+    } catch (error) {
+      fail(error);
+      return;
+    }
+    response.subscribe({
+      onComplete: data => {
+        const transferable = owned(data);
+        parentPort.postMessage({data: transferable}, [transferable]);
+      },
+      onError: fail,
+    });
+  });
+}
+
+// A copy of `bytes` to transfer to another thread
+function copy(bytes: ?Uint8Array): ArrayBuffer {
+  const copied = new Uint8Array(bytes ? bytes.length : 0);
+  bytes && copied.set(bytes);
+  return copied.buffer;
+}
+
+// The buffer behind serialized bytes, when they are all it holds. Node's
+// Buffers may share theirs with others, so they are copied.
+function owned(bytes: ?Uint8Array): ArrayBuffer {
+  return bytes &&
+    !Buffer.isBuffer(bytes) &&
+    bytes.byteOffset === 0 &&
+    bytes.byteLength === bytes.buffer.byteLength
+    ? bytes.buffer
+    : copy(bytes);
+}
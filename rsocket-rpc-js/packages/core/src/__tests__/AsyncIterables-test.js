@@ -0,0 +1,138 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable} from 'rsocket-flowable';
+
+import {toFlowable, withAsyncIterator} from '../AsyncIterables';
+
+const ASYNC_ITERATOR =
+  Symbol.asyncIterator || Symbol.for('Symbol.asyncIterator');
+
+// An async iterable of 0 to count - 1, recording how far it was pulled
+function counter(count) {
+  const state = {pulled: 0, returned: false};
+  state.iterable = {
+    [ASYNC_ITERATOR]: () => ({
+      next: () =>
+        Promise.resolve(
+          state.pulled < count
+            ? {done: false, value: state.pulled++}
+            : {done: true, value: undefined},
+        ),
+      return: () => {
+        state.returned = true;
+        return Promise.resolve({done: true, value: undefined});
+      },
+    }),
+  };
+  return state;
+}
+
+function tick() {
+  return new Promise(resolve => setTimeout(resolve, 5));
+}
+
+describe('AsyncIterables', () => {
+  it('pulls from an async iterable only what is requested', done => {
+    const state = counter(100);
+    const values = [];
+    let subscription;
+    toFlowable(state.iterable).subscribe({
+      onNext: value => values.push(value),
+      onSubscribe: s => {
+        subscription = s;
+        subscription.request(3);
+      },
+    });
+    tick()
+      .then(() => {
+        expect(values).to.deep.equal([0, 1, 2]);
+        expect(state.pulled).to.equal(3);
+        subscription.cancel();
+        return tick();
+      })
+      .then(() => {
+        expect(state.pulled).to.equal(3);
+        expect(state.returned).to.equal(true);
+        done();
+      })
+      .catch(done);
+  });
+
+  it('completes once the async iterable is done', done => {
+    const values = [];
+    toFlowable(counter(3).iterable).subscribe({
+      onComplete: () => {
+        expect(values).to.deep.equal([0, 1, 2]);
+        done();
+      },
+      onNext: value => values.push(value),
+      onSubscribe: subscription => subscription.request(10),
+    });
+  });
+
+  it('returns Flowables as they are', () => {
+    const flowable = Flowable.just(1);
+    expect(toFlowable(flowable)).to.equal(flowable);
+  });
+
+  it('iterates a Flowable, requesting as values are consumed', done => {
+    const requests = [];
+    const flowable = withAsyncIterator(
+      Flowable.just(...[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]).lift(subscriber => ({
+        onComplete: () => subscriber.onComplete(),
+        onError: error => subscriber.onError(error),
+        onNext: value => subscriber.onNext(value),
+        onSubscribe: subscription =>
+          subscriber.onSubscribe({
+            cancel: () => subscription.cancel(),
+            request: n => {
+              requests.push(n);
+              subscription.request(n);
+            },
+          }),
+      })),
+      4,
+    );
+    const iterator = flowable[ASYNC_ITERATOR]();
+    const values = [];
+    const next = () =>
+      iterator.next().then(result => {
+        if (result.done) {
+          expect(values).to.deep.equal([0, 1, 2, 3, 4, 5, 6, 7, 8, 9]);
+          expect(requests).to.deep.equal([4, 3, 3]);
+          done();
+          return;
+        }
+        values.push(result.value);
+        return next();
+      });
+    next().catch(done);
+  });
+
+  it('cancels the subscription when the iteration stops', done => {
+    let cancelled = false;
+    const flowable = withAsyncIterator(
+      new Flowable(subscriber =>
+        subscriber.onSubscribe({
+          cancel: () => {
+            cancelled = true;
+          },
+          request: () => subscriber.onNext('value'),
+        }),
+      ),
+    );
+    const iterator = flowable[ASYNC_ITERATOR]();
+    iterator
+      .next()
+      .then(result => {
+        expect(result).to.deep.equal({done: false, value: 'value'});
+        return iterator.return();
+      })
+      .then(result => {
+        expect(result.done).to.equal(true);
+        expect(cancelled).to.equal(true);
+        done();
+      })
+      .catch(done);
+  });
+});
@@ -0,0 +1,152 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable} from 'rsocket-flowable';
+
+import {chunkPayloads, joinChunks, repeatedField} from '../ChunkedPayloads';
+
+const MAX_REQUEST_N = 0x7fffffff;
+
+function payloads(...datas) {
+  return Flowable.just(
+    ...datas.map(data => ({data, metadata: Buffer.alloc(0)})),
+  );
+}
+
+function collect(flowable, request, done, check) {
+  const values = [];
+  let subscription;
+  flowable.subscribe({
+    onComplete: () => {
+      check(values);
+      done();
+    },
+    onError: done,
+    onNext: payload => {
+      values.push(payload.data);
+      if (request && values.length % request === 0) {
+        setImmediate(() => subscription.request(request));
+      }
+    },
+    onSubscribe: s => {
+      subscription = s;
+      subscription.request(request || MAX_REQUEST_N);
+    },
+  });
+}
+
+// A length-delimited protobuf field of a small number and length
+function field(number, data) {
+  return Buffer.concat([Buffer.from([number * 8 + 2, data.length]), data]);
+}
+
+describe('ChunkedPayloads', () => {
+  it('joins the fragments a payload is split into', done => {
+    const large = Buffer.alloc(1000, 'a');
+    const sizes = [];
+    const fragments = payloads(large, Buffer.alloc(0), Buffer.from('small'))
+      .lift(chunkPayloads(300))
+      .map(payload => {
+        sizes.push(payload.data.length);
+        return payload;
+      });
+    collect(fragments.lift(joinChunks()), 1, done, values => {
+      // The first fragment of a payload starts with its length
+      expect(sizes).to.deep.equal([302, 300, 300, 100, 1, 6]);
+      expect(values.map(value => value.toString())).to.deep.equal([
+        large.toString(),
+        '',
+        'small',
+      ]);
+    });
+  });
+
+  it('reads the elements of a repeated field across fragments', done => {
+    const message = Buffer.concat([
+      field(1, Buffer.from('title')),
+      field(2, Buffer.from('first')),
+      // A fixed64 field 3 and a varint field 4, which are skipped
+      Buffer.from([3 * 8 + 1, 1, 2, 3, 4, 5, 6, 7, 8]),
+      Buffer.from([4 * 8, 0x96, 0x01]),
+      field(2, Buffer.alloc(0)),
+      field(2, Buffer.from('second')),
+    ]);
+    collect(
+      payloads(message, message)
+        .lift(chunkPayloads(1))
+        .lift(repeatedField(2)),
+      2,
+      done,
+      values => {
+        expect(values.map(value => value.toString())).to.deep.equal([
+          'first',
+          '',
+          'second',
+          'first',
+          '',
+          'second',
+        ]);
+      },
+    );
+  });
+
+  it('fails a stream that ends within a payload', done => {
+    // A payload of 10 bytes, of which only 3 arrive
+    payloads(Buffer.from([10, 1, 2, 3]))
+      .lift(joinChunks())
+      .subscribe({
+        onComplete: () => done(new Error('completed')),
+        onError: error => {
+          expect(error.message).to.contain('chunked payload');
+          done();
+        },
+        onSubscribe: subscription => subscription.request(1),
+      });
+  });
+
+  it('fails payloads longer than the maximum before allocating them', done => {
+    // The first fragment of a payload of 100 bytes
+    const fragments = payloads(Buffer.from([100, 1, 2, 3]));
+    let allocated = 0;
+    const allocUnsafe = Buffer.allocUnsafe;
+    Buffer.allocUnsafe = size => {
+      allocated += size;
+      return allocUnsafe(size);
+    };
+    const values = [];
+    fragments.lift(joinChunks(64)).subscribe({
+      onComplete: () => done(new Error('completed')),
+      onError: error => {
+        Buffer.allocUnsafe = allocUnsafe;
+        expect(error.message).to.contain('exceeds 64');
+        expect(allocated).to.equal(0);
+        expect(values).to.deep.equal([]);
+        done();
+      },
+      onNext: payload => values.push(payload.data),
+      onSubscribe: subscription => subscription.request(2),
+    });
+  });
+
+  it('fails elements longer than the maximum', done => {
+    const message = Buffer.concat([
+      field(2, Buffer.from('first')),
+      field(2, Buffer.alloc(100)),
+    ]);
+    const values = [];
+    payloads(message)
+      .lift(chunkPayloads(8))
+      .lift(repeatedField(2, 64))
+      .subscribe({
+        onComplete: () => done(new Error('completed')),
+        onError: error => {
+          expect(error.message).to.contain('exceeds 64');
+          expect(values.map(value => value.toString())).to.deep.equal([
+            'first',
+          ]);
+          done();
+        },
+        onNext: payload => values.push(payload.data),
+        onSubscribe: subscription => subscription.request(2),
+      });
+  });
+});
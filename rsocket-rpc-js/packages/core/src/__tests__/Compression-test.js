@@ -0,0 +1,159 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable, Single} from 'rsocket-flowable';
+import {
+  encodeMetadata,
+  encodeMetadataV2,
+  getFlags,
+  getMethod,
+} from 'rsocket-rpc-frames';
+
+import Compression, {
+  COMPRESSION_GZIP,
+  COMPRESSION_DEFLATE,
+} from '../Compression';
+
+const LARGE = Buffer.from('abcdefgh'.repeat(512));
+const SMALL = Buffer.from('abc');
+
+function metadata() {
+  return encodeMetadataV2('service', 'foo', undefined, Buffer.alloc(0));
+}
+
+describe('Compression', () => {
+  it('leaves payloads under the threshold alone', done => {
+    const payload = {data: SMALL, metadata: metadata()};
+    new Compression(COMPRESSION_GZIP, 1024).compressPayload(payload).subscribe({
+      onComplete: result => {
+        expect(result).to.equal(payload);
+        expect(getFlags(result.metadata)).to.equal(0);
+        done();
+      },
+      onError: done,
+    });
+  });
+
+  it('round-trips a request and flags it in the routing header', done => {
+    const compression = new Compression(COMPRESSION_DEFLATE, 1024);
+    compression
+      .requestResponse({data: LARGE, metadata: metadata()}, request => {
+        expect(request.data.length).to.be.below(LARGE.length);
+        expect(getFlags(request.metadata)).to.not.equal(0);
+        expect(getMethod(request.metadata)).to.equal('foo');
+        return compression.handleRequestResponse(request, received =>
+          Single.of({data: received.data, metadata: Buffer.alloc(0)}),
+        );
+      })
+      .subscribe({
+        onComplete: response => {
+          expect(response.data).to.deep.equal(LARGE);
+          done();
+        },
+        onError: done,
+      });
+  });
+
+  it('flags a copy of the header', done => {
+    const header = metadata();
+    const payload = {data: LARGE, metadata: header};
+    new Compression(COMPRESSION_GZIP, 1024).compressPayload(payload).subscribe({
+      onComplete: result => {
+        expect(getFlags(result.metadata)).to.not.equal(0);
+        expect(getFlags(header)).to.equal(0);
+        done();
+      },
+      onError: done,
+    });
+  });
+
+  it('sends payloads with version 1 headers uncompressed', done => {
+    const header = encodeMetadata('service', 'foo', undefined, Buffer.alloc(0));
+    const payload = {data: LARGE, metadata: header};
+    new Compression(COMPRESSION_GZIP, 1024).compressPayload(payload).subscribe({
+      onComplete: result => {
+        expect(result).to.equal(payload);
+        expect(getFlags(header)).to.equal(0);
+        done();
+      },
+      onError: done,
+    });
+  });
+
+  it('flags every request so that responses get compressed', done => {
+    const compression = new Compression(COMPRESSION_GZIP, 1024);
+    compression
+      .requestResponse({data: SMALL, metadata: metadata()}, request => {
+        expect(getFlags(request.metadata)).to.not.equal(0);
+        return compression.handleRequestResponse(request, received => {
+          expect(received.data).to.deep.equal(SMALL);
+          return Single.of({data: LARGE, metadata: Buffer.alloc(0)});
+        });
+      })
+      .subscribe({
+        onComplete: response => {
+          expect(response.data).to.deep.equal(LARGE);
+          done();
+        },
+        onError: done,
+      });
+  });
+
+  it('only compresses responses to flagged requests', done => {
+    const compression = new Compression(COMPRESSION_GZIP, 1024);
+    compression
+      .handleRequestResponse({data: SMALL, metadata: metadata()}, () =>
+        Single.of({data: LARGE, metadata: Buffer.alloc(0)}),
+      )
+      .subscribe({
+        onComplete: response => {
+          expect(response.data).to.equal(LARGE);
+          expect(getFlags(response.metadata)).to.equal(0);
+          done();
+        },
+        onError: done,
+      });
+  });
+
+  it('fails payloads that decompress past the maximum', done => {
+    const compression = new Compression(COMPRESSION_GZIP, 8, 1024);
+    // Kilobytes of zeros compress to a few dozen bytes
+    compression
+      .compressPayload({data: Buffer.alloc(64 * 1024), metadata: metadata()})
+      .subscribe({
+        onComplete: compressed => {
+          expect(compressed.data.length).to.be.below(1024);
+          compression.decompressPayload(compressed).subscribe({
+            onComplete: () => done(new Error('decompressed past the maximum')),
+            onError: () => done(),
+          });
+        },
+        onError: done,
+      });
+  });
+
+  it('keeps stream elements in order', done => {
+    const compression = new Compression(COMPRESSION_GZIP, 8);
+    const sizes = [4096, 16, 2048, 4, 1024];
+    const values = [];
+    compression
+      .decompressPayloads(
+        compression.compressPayloads(
+          Flowable.just(
+            ...sizes.map(size => ({
+              data: Buffer.alloc(size, size % 251),
+              metadata: Buffer.alloc(0),
+            })),
+          ),
+        ),
+      )
+      .subscribe({
+        onComplete: () => {
+          expect(values).to.deep.equal(sizes);
+          done();
+        },
+        onError: done,
+        onNext: payload => values.push(payload.data.length),
+        onSubscribe: subscription => subscription.request(sizes.length),
+      });
+  });
+});
@@ -0,0 +1,97 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Single} from 'rsocket-flowable';
+
+import hedgeSingle from '../HedgingSingle';
+
+function delayed(value, millis, cancelled) {
+  return new Single(subscriber => {
+    const timeout = setTimeout(() => subscriber.onComplete(value), millis);
+    subscriber.onSubscribe(() => {
+      clearTimeout(timeout);
+      cancelled && cancelled.push(value);
+    });
+  });
+}
+
+describe('hedgeSingle', () => {
+  it('does not hedge an attempt that completes in time', done => {
+    let attempts = 0;
+    hedgeSingle(() => delayed(++attempts, 5), () => 50).subscribe({
+      onComplete: value => {
+        expect(value).to.equal(1);
+        setTimeout(() => {
+          expect(attempts).to.equal(1);
+          done();
+        }, 80);
+      },
+      onError: done,
+    });
+  });
+
+  it('takes the hedge when it wins and cancels the first attempt', done => {
+    const cancelled = [];
+    let attempts = 0;
+    hedgeSingle(
+      () => (++attempts === 1 ? delayed(1, 200, cancelled) : delayed(2, 5)),
+      () => 10,
+    ).subscribe({
+      onComplete: value => {
+        expect(value).to.equal(2);
+        expect(cancelled).to.deep.equal([1]);
+        done();
+      },
+      onError: done,
+    });
+  });
+
+  it('hands every attempt the hedged view of a socket', done => {
+    const views = [];
+    const socket = {hedged: () => ({id: views.length})};
+    hedgeSingle(
+      view => {
+        views.push(view);
+        return views.length === 1 ? delayed(1, 200) : delayed(2, 5);
+      },
+      () => 10,
+      socket,
+    ).subscribe({
+      onComplete: value => {
+        expect(value).to.equal(2);
+        expect(views.length).to.equal(2);
+        expect(views[1]).to.equal(views[0]);
+        done();
+      },
+      onError: done,
+    });
+  });
+
+  it('fails without hedging when the first attempt fails', done => {
+    let attempts = 0;
+    hedgeSingle(() => {
+      attempts++;
+      return Single.error(new Error('boom'));
+    }, () => 10).subscribe({
+      onComplete: () => done(new Error('expected an error')),
+      onError: error => {
+        expect(error.message).to.equal('boom');
+        setTimeout(() => {
+          expect(attempts).to.equal(1);
+          done();
+        }, 30);
+      },
+    });
+  });
+
+  it('never hedges when the delay is not positive', done => {
+    let attempts = 0;
+    hedgeSingle(() => delayed(++attempts, 30), () => 0).subscribe({
+      onComplete: value => {
+        expect(value).to.equal(1);
+        expect(attempts).to.equal(1);
+        done();
+      },
+      onError: done,
+    });
+  });
+});
@@ -0,0 +1,188 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import path from 'path';
+import {Flowable, Single} from 'rsocket-flowable';
+
+import LoopbackRSocket, {localServer} from '../LoopbackRSocket';
+import PriorityScheduler from '../PriorityScheduler';
+import RequestHandlingRSocket from '../RequestHandlingRSocket';
+import WorkerPool from '../WorkerPool';
+
+class Message {
+  constructor(value) {
+    this.value = value;
+  }
+
+  cloneMessage() {
+    return new Message(this.value);
+  }
+
+  serializeBinary() {
+    return Buffer.from(this.value);
+  }
+
+  static deserializeBinary(data) {
+    return new Message(Buffer.from(data).toString());
+  }
+}
+
+// A generated server, recording the messages it is called with
+function server() {
+  const calls = [];
+  return {
+    calls,
+    handleLocal: (method, message, metadata) => {
+      calls.push({message, method});
+      switch (method) {
+        case 'Get':
+          return Single.of(new Message('got ' + message.value));
+        case 'List':
+          return Flowable.just(new Message(1), new Message(2));
+        case 'Echo':
+          return message;
+        default:
+          throw new Error('unknown method');
+      }
+    },
+  };
+}
+
+function responder(service) {
+  const rsocket = new RequestHandlingRSocket();
+  rsocket.addService('test.Service', service);
+  return rsocket;
+}
+
+describe('LoopbackRSocket', () => {
+  it('hands messages to the server as they are', done => {
+    const service = server();
+    const local = localServer(
+      new LoopbackRSocket(responder(service)),
+      'test.Service',
+    );
+    const message = new Message('a');
+    local.requestResponse('Get', message, Buffer.alloc(0)).subscribe({
+      onComplete: response => {
+        expect(response.value).to.equal('got a');
+        expect(service.calls[0].message).to.equal(message);
+        done();
+      },
+      onError: done,
+    });
+  });
+
+  it('clones the messages of either side when asked to', done => {
+    const service = server();
+    const local = localServer(
+      new LoopbackRSocket(responder(service), true),
+      'test.Service',
+    );
+    const messages = [new Message('a'), new Message('b')];
+    const values = [];
+    local
+      .requestChannel('Echo', Flowable.just(...messages), Buffer.alloc(0))
+      .subscribe({
+        onComplete: () => {
+          expect(values.map(value => value.value)).to.deep.equal(['a', 'b']);
+          values.forEach((value, i) =>
+            expect(value === messages[i]).to.equal(false),
+          );
+          done();
+        },
+        onError: done,
+        onNext: value => values.push(value),
+        onSubscribe: subscription => subscription.request(10),
+      });
+  });
+
+  it('fails calls the server does not know', done => {
+    const local = localServer(
+      new LoopbackRSocket(responder(server())),
+      'test.Service',
+    );
+    local
+      .requestStream('Missing', new Message('a'), Buffer.alloc(0))
+      .subscribe({
+        onError: error => {
+          expect(error.message).to.equal('unknown method');
+          done();
+        },
+        onSubscribe: subscription => subscription.request(1),
+      });
+  });
+
+  it('is only used for generated servers of other sockets', () => {
+    const rsocket = new LoopbackRSocket(responder({}));
+    expect(localServer(rsocket, 'test.Service')).to.equal(null);
+    expect(localServer(rsocket, 'test.Other')).to.equal(null);
+    expect(localServer(responder(server()), 'test.Service')).to.equal(null);
+  });
+
+  it('reuses the local server of a service', () => {
+    const rsocket = new LoopbackRSocket(responder(server()));
+    expect(localServer(rsocket, 'test.Service')).to.equal(
+      localServer(rsocket, 'test.Service'),
+    );
+  });
+
+  it("admits local calls by the responder's scheduler", () => {
+    const scheduler = new PriorityScheduler(1);
+    const rsocket = new RequestHandlingRSocket(scheduler);
+    const pending = [];
+    rsocket.addService('test.Service', {
+      handleLocal: (method, message) =>
+        new Single(subscriber => {
+          subscriber.onSubscribe();
+          pending.push(() => subscriber.onComplete(message));
+        }),
+    });
+    const local = localServer(new LoopbackRSocket(rsocket), 'test.Service');
+    const responses = [];
+    const call = value =>
+      local
+        .requestResponse('Get', new Message(value), Buffer.alloc(0))
+        .subscribe({onComplete: response => responses.push(response.value)});
+
+    call('a');
+    call('b');
+    expect(pending.length).to.equal(1);
+    expect(scheduler.queued()).to.equal(1);
+    pending.shift()();
+    pending.shift()();
+    expect(responses).to.deep.equal(['a', 'b']);
+    expect(scheduler.active()).to.equal(0);
+  });
+
+  it('runs offloaded methods on the workers of the server', done => {
+    const workers = new WorkerPool(path.join(__dirname, 'echoWorker.js'), {
+      size: 1,
+    });
+    // A generated server of a method declared with `offload`, given a pool
+    const service = {
+      _workers: workers,
+      handleLocal(method, message, metadata) {
+        return this._workers
+          .run('test.Echo', method, message.serializeBinary(), metadata)
+          .map(data => Message.deserializeBinary(data));
+      },
+    };
+    const local = localServer(
+      new LoopbackRSocket(responder(service)),
+      'test.Service',
+    );
+    local
+      .requestResponse('Echo', new Message('a'), Buffer.from('+metadata'))
+      .subscribe({
+        onComplete: response => {
+          workers.close();
+          expect(response).to.be.instanceof(Message);
+          expect(response.value).to.equal('a+metadata');
+          done();
+        },
+        onError: error => {
+          workers.close();
+          done(error);
+        },
+      });
+  });
+});
@@ -0,0 +1,97 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable} from 'rsocket-flowable';
+
+import {packPayloads, unpackPayloads} from '../PackedPayloads';
+
+const MAX_REQUEST_N = 0x7fffffff;
+
+function messages(count) {
+  const payloads = [];
+  for (let i = 0; i < count; i++) {
+    payloads.push({data: Buffer.from('message-' + i), metadata: undefined});
+  }
+  return Flowable.just(...payloads);
+}
+
+function frames(flowable, counts) {
+  return flowable.map(payload => {
+    counts.push(payload.data.length);
+    return payload;
+  });
+}
+
+describe('PackedPayloads', () => {
+  it('packs messages up to the byte budget', done => {
+    const sizes = [];
+    const values = [];
+    frames(messages(10).lift(packPayloads(50, 0)), sizes)
+      .lift(unpackPayloads)
+      .subscribe({
+        onComplete: () => {
+          expect(values.length).to.equal(10);
+          values.forEach((value, i) => expect(value).to.equal('message-' + i));
+          // 5 messages of 9 bytes, each with a 1 byte length, per frame
+          expect(sizes).to.deep.equal([50, 50]);
+          done();
+        },
+        onNext: payload => values.push(payload.data.toString()),
+        onSubscribe: subscription => subscription.request(MAX_REQUEST_N),
+      });
+  });
+
+  it('sends a message larger than the budget on its own', done => {
+    const sizes = [];
+    frames(messages(3).lift(packPayloads(4, 0)), sizes)
+      .lift(unpackPayloads)
+      .subscribe({
+        onComplete: () => {
+          expect(sizes).to.deep.equal([10, 10, 10]);
+          done();
+        },
+        onSubscribe: subscription => subscription.request(MAX_REQUEST_N),
+      });
+  });
+
+  it('counts demand in unpacked messages', done => {
+    const requests = [];
+    const values = [];
+    let subscription;
+    messages(10)
+      .lift(packPayloads(1000, 0))
+      .lift(subscriber => ({
+        onComplete: () => subscriber.onComplete(),
+        onError: error => subscriber.onError(error),
+        onNext: payload => subscriber.onNext(payload),
+        onSubscribe: upstream =>
+          subscriber.onSubscribe({
+            cancel: () => upstream.cancel(),
+            request: n => {
+              requests.push(n);
+              upstream.request(n);
+            },
+          }),
+      }))
+      .lift(unpackPayloads)
+      .subscribe({
+        onComplete: () => {
+          expect(values.length).to.equal(10);
+          expect(requests).to.deep.equal([1]);
+          done();
+        },
+        onNext: payload => {
+          values.push(payload.data.toString());
+          if (values.length === 3) {
+            setImmediate(() => {
+              expect(values.length).to.equal(3);
+              subscription.request(7);
+            });
+          }
+        },
+        onSubscribe: s => {
+          subscription = s;
+          subscription.request(3);
+        },
+      });
+  });
+});
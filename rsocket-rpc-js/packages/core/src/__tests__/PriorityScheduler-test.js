@@ -0,0 +1,186 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable, Single} from 'rsocket-flowable';
+
+import PriorityScheduler, {
+  PRIORITY_CRITICAL,
+  PRIORITY_HIGH,
+  PRIORITY_LOW,
+  PRIORITY_NORMAL,
+} from '../PriorityScheduler';
+
+// Calls that run until completed by hand, recording the order they started in
+function calls() {
+  const state = {running: [], started: []};
+  state.call = name => () =>
+    new Single(subscriber => {
+      subscriber.onSubscribe();
+      state.started.push(name);
+      state.running.push(() => subscriber.onComplete(name));
+    });
+  state.complete = () => state.running.shift()();
+  return state;
+}
+
+describe('PriorityScheduler', () => {
+  it('queues calls beyond the limit, except critical ones', () => {
+    const scheduler = new PriorityScheduler(1);
+    const state = calls();
+    scheduler.single(PRIORITY_LOW, state.call('low')).subscribe();
+    scheduler.single(PRIORITY_NORMAL, state.call('normal')).subscribe();
+    scheduler.single(PRIORITY_CRITICAL, state.call('health')).subscribe();
+    expect(state.started).to.deep.equal(['low', 'health']);
+    expect(scheduler.active()).to.equal(2);
+    expect(scheduler.queued()).to.equal(1);
+
+    state.complete();
+    state.complete();
+    expect(state.started).to.deep.equal(['low', 'health', 'normal']);
+    expect(scheduler.active()).to.equal(1);
+  });
+
+  it('starts queued calls in proportion to the weights', () => {
+    const scheduler = new PriorityScheduler(1, {high: 2, low: 1, normal: 1});
+    const state = calls();
+    scheduler.single(PRIORITY_NORMAL, state.call('first')).subscribe();
+    for (let i = 0; i < 4; i++) {
+      scheduler.single(PRIORITY_LOW, state.call('L')).subscribe();
+      scheduler.single(PRIORITY_NORMAL, state.call('N')).subscribe();
+      scheduler.single(PRIORITY_HIGH, state.call('H')).subscribe();
+    }
+    while (state.running.length > 0) {
+      state.complete();
+    }
+    expect(state.started.join('')).to.equal('firstHNLHHNLHNLNL');
+  });
+
+  it('keeps slots from low calls for higher priorities', () => {
+    const scheduler = new PriorityScheduler(4);
+    const state = calls();
+    for (let i = 0; i < 6; i++) {
+      scheduler.single(PRIORITY_LOW, state.call('L')).subscribe();
+    }
+    // Low calls hold half of the slots at most
+    expect(state.started.join('')).to.equal('LL');
+    expect(scheduler.queued(PRIORITY_LOW)).to.equal(4);
+
+    scheduler.single(PRIORITY_HIGH, state.call('H')).subscribe();
+    scheduler.single(PRIORITY_NORMAL, state.call('N')).subscribe();
+    expect(state.started.join('')).to.equal('LLHN');
+    expect(scheduler.active()).to.equal(4);
+
+    // A low call ending makes room for another one only
+    state.complete();
+    expect(state.started.join('')).to.equal('LLHNL');
+    expect(scheduler.queued(PRIORITY_LOW)).to.equal(3);
+    state.complete();
+    state.complete();
+    expect(state.started.join('')).to.equal('LLHNLL');
+    expect(scheduler.active()).to.equal(3);
+  });
+
+  it('caps normal and low calls together by their share', () => {
+    const scheduler = new PriorityScheduler(4, undefined, {
+      low: 0.25,
+      normal: 0.5,
+    });
+    const state = calls();
+    scheduler.single(PRIORITY_LOW, state.call('L')).subscribe();
+    scheduler.single(PRIORITY_LOW, state.call('L')).subscribe();
+    scheduler.single(PRIORITY_NORMAL, state.call('N')).subscribe();
+    scheduler.single(PRIORITY_NORMAL, state.call('N')).subscribe();
+    scheduler.single(PRIORITY_HIGH, state.call('H')).subscribe();
+    scheduler.single(PRIORITY_HIGH, state.call('H')).subscribe();
+    expect(state.started.join('')).to.equal('LNHH');
+    expect(scheduler.queued()).to.equal(2);
+  });
+
+  it('passes on the demand of a stream requested while queued', () => {
+    const scheduler = new PriorityScheduler(1);
+    const state = calls();
+    scheduler.single(PRIORITY_NORMAL, state.call('first')).subscribe();
+    const values = [];
+    scheduler
+      .flowable(PRIORITY_NORMAL, () => Flowable.just(1, 2, 3))
+      .subscribe({
+        onNext: value => values.push(value),
+        onSubscribe: subscription => subscription.request(2),
+      });
+    expect(values).to.deep.equal([]);
+    state.complete();
+    expect(values).to.deep.equal([1, 2]);
+  });
+
+  it('drops a call cancelled while queued', () => {
+    const scheduler = new PriorityScheduler(1);
+    const state = calls();
+    scheduler.single(PRIORITY_NORMAL, state.call('first')).subscribe();
+    let cancel;
+    scheduler.single(PRIORITY_HIGH, state.call('cancelled')).subscribe({
+      onSubscribe: _cancel => {
+        cancel = _cancel;
+      },
+    });
+    scheduler.single(PRIORITY_LOW, state.call('last')).subscribe();
+    cancel();
+    expect(scheduler.queued()).to.equal(1);
+    state.complete();
+    expect(state.started).to.deep.equal(['first', 'last']);
+  });
+
+  it('never starts a call cancelled as it is subscribed to', () => {
+    const scheduler = new PriorityScheduler(1);
+    const state = calls();
+    scheduler
+      .single(PRIORITY_NORMAL, state.call('cancelled'))
+      .subscribe({onSubscribe: cancel => cancel()});
+    expect(state.started).to.deep.equal([]);
+    expect(scheduler.active()).to.equal(0);
+  });
+
+  it('releases a call cancelled before its source subscribed', () => {
+    const scheduler = new PriorityScheduler(1);
+    let subscribe;
+    let cancelled = false;
+    let cancel;
+    scheduler
+      .single(
+        PRIORITY_NORMAL,
+        () =>
+          new Single(subscriber => {
+            subscribe = () =>
+              subscriber.onSubscribe(() => {
+                cancelled = true;
+              });
+          }),
+      )
+      .subscribe({
+        onSubscribe: _cancel => {
+          cancel = _cancel;
+        },
+      });
+    cancel();
+    expect(scheduler.active()).to.equal(1);
+    subscribe();
+    expect(cancelled).to.equal(true);
+    expect(scheduler.active()).to.equal(0);
+  });
+
+  it('reports the calls waiting for each method', () => {
+    const scheduler = new PriorityScheduler(1);
+    const state = calls();
+    scheduler
+      .single(PRIORITY_NORMAL, state.call('running'), 'foo.Bar', 'Get')
+      .subscribe();
+    ['Get', 'Get', 'Put'].forEach(method =>
+      scheduler
+        .single(PRIORITY_NORMAL, state.call(method), 'foo.Bar', method)
+        .subscribe(),
+    );
+    scheduler.single(PRIORITY_LOW, state.call('untagged')).subscribe();
+    expect(scheduler.load()).to.deep.equal([
+      {method: 'Get', queued: 2, service: 'foo.Bar'},
+      {method: 'Put', queued: 1, service: 'foo.Bar'},
+    ]);
+  });
+});
@@ -0,0 +1,149 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable, Single} from 'rsocket-flowable';
+
+import RSocketPool from '../RSocketPool';
+
+function fakeSocket(name, millis) {
+  const statusSubscribers = [];
+  return {
+    name,
+    requests: 0,
+    closed: false,
+    requestResponse(payload) {
+      this.requests++;
+      return new Single(subscriber => {
+        const timeout = setTimeout(
+          () => subscriber.onComplete({data: name, metadata: null}),
+          millis,
+        );
+        subscriber.onSubscribe(() => clearTimeout(timeout));
+      });
+    },
+    requestStream(payload) {
+      this.requests++;
+      return Flowable.just({data: name, metadata: null});
+    },
+    close() {
+      this.closed = true;
+    },
+    connectionStatus() {
+      return new Flowable(subscriber => {
+        subscriber.onSubscribe({cancel: () => {}, request: () => {}});
+        statusSubscribers.push(subscriber);
+      });
+    },
+    fail() {
+      statusSubscribers.forEach(subscriber =>
+        subscriber.onNext({kind: 'ERROR', error: new Error(name)}),
+      );
+    },
+  };
+}
+
+function call(pool) {
+  return new Promise((resolve, reject) =>
+    pool.requestResponse({data: 'x', metadata: null}).subscribe({
+      onComplete: payload => resolve(payload.data),
+      onError: reject,
+    }),
+  );
+}
+
+describe('RSocketPool', () => {
+  it('fails requests when it has no connections', done => {
+    new RSocketPool().requestResponse({data: 'x', metadata: null}).subscribe({
+      onComplete: () => done(new Error('expected an error')),
+      onError: error => {
+        expect(error.message).to.contain('No connections');
+        done();
+      },
+    });
+  });
+
+  it('sends each attempt of a hedged call to another connection', () => {
+    const sockets = [fakeSocket('a', 50), fakeSocket('b', 50)];
+    sockets.push(fakeSocket('c', 50));
+    const pool = new RSocketPool(sockets);
+    const hedged = pool.hedged();
+    const cancels = [];
+    for (let i = 0; i < 3; i++) {
+      hedged.requestResponse({data: 'x', metadata: null}).subscribe({
+        onSubscribe: cancel => cancels.push(cancel),
+      });
+    }
+    cancels.forEach(cancel => cancel());
+    expect(sockets.map(socket => socket.requests)).to.deep.equal([1, 1, 1]);
+  });
+
+  it('prefers the connection with fewer outstanding requests', () => {
+    const a = fakeSocket('a', 50);
+    const b = fakeSocket('b', 50);
+    const pool = new RSocketPool([a, b]);
+    const cancels = [];
+    for (let i = 0; i < 10; i++) {
+      pool.requestResponse({data: 'x', metadata: null}).subscribe({
+        onSubscribe: cancel => cancels.push(cancel),
+      });
+    }
+    cancels.forEach(cancel => cancel());
+    // With two members both are compared on every call, so load stays even
+    expect(a.requests).to.equal(5);
+    expect(b.requests).to.equal(5);
+  });
+
+  it('shifts load away from a slow connection', async () => {
+    const fast = fakeSocket('fast', 1);
+    const slow = fakeSocket('slow', 40);
+    const pool = new RSocketPool([fast, slow]);
+    await Promise.all([call(pool), call(pool)]);
+    fast.requests = 0;
+    slow.requests = 0;
+    for (let i = 0; i < 10; i++) {
+      await call(pool);
+    }
+    expect(fast.requests).to.equal(10);
+    expect(slow.requests).to.equal(0);
+  });
+
+  it('drops connections that fail', async () => {
+    const a = fakeSocket('a', 1);
+    const b = fakeSocket('b', 1);
+    const pool = new RSocketPool([a, b]);
+    a.fail();
+    expect(pool.size()).to.equal(1);
+    expect(await call(pool)).to.equal('b');
+  });
+
+  it('recovers once its last connection is replaced', async () => {
+    const a = fakeSocket('a', 1);
+    const pool = new RSocketPool([a]);
+    const statuses = [];
+    pool.connectionStatus().subscribe({
+      onNext: status => statuses.push(status.kind),
+      onSubscribe: subscription => subscription.request(10),
+    });
+    a.fail();
+    expect(pool.size()).to.equal(0);
+
+    pool.add(fakeSocket('b', 1));
+    expect(statuses).to.deep.equal(['CONNECTED', 'CLOSED', 'CONNECTED']);
+    expect(await call(pool)).to.equal('b');
+  });
+
+  it('routes streams and closes every connection', done => {
+    const a = fakeSocket('a', 1);
+    const pool = new RSocketPool([a]);
+    pool.requestStream({data: 'x', metadata: null}).subscribe({
+      onComplete: () => {
+        pool.close();
+        expect(a.closed).to.equal(true);
+        expect(pool.size()).to.equal(0);
+        done();
+      },
+      onError: done,
+      onNext: payload => expect(payload.data).to.equal('a'),
+      onSubscribe: subscription => subscription.request(1),
+    });
+  });
+});
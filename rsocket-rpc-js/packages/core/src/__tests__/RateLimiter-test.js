@@ -0,0 +1,196 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable, Single} from 'rsocket-flowable';
+import {
+  encodeMetadata,
+  encodeMetadataV2,
+  serviceId,
+} from 'rsocket-rpc-frames';
+
+import PriorityScheduler from '../PriorityScheduler';
+import RateHintPublisher from '../RateHintPublisher';
+import RateLimiter from '../RateLimiter';
+
+function hint(method, maxInFlight, retryAfter, queueDepth) {
+  return {
+    maxInFlight,
+    method,
+    queueDepth: queueDepth || 0,
+    retryAfter,
+    service: 'foo.Bar',
+  };
+}
+
+// A connection answering requests when told to, and passing metadata pushes
+// on to `pushed`
+function connection(pushed) {
+  const pending = [];
+  return {
+    pending,
+    socket: {
+      connectionStatus: () =>
+        new Flowable(subscriber =>
+          subscriber.onSubscribe({cancel: () => {}, request: () => {}}),
+        ),
+      metadataPush: payload => (pushed ? pushed(payload) : Single.of()),
+      requestResponse: payload =>
+        new Single(subscriber => {
+          subscriber.onSubscribe();
+          pending.push({
+            method: payload.data.toString(),
+            respond: () => subscriber.onComplete(payload),
+          });
+        }),
+    },
+  };
+}
+
+function request(rsocket, method) {
+  const responses = [];
+  rsocket
+    .requestResponse({
+      data: Buffer.from(method),
+      metadata: encodeMetadata('foo.Bar', method, undefined, Buffer.alloc(0)),
+    })
+    .subscribe({onComplete: response => responses.push(response)});
+  return responses;
+}
+
+describe('RateLimiter', () => {
+  it('keeps calls to a method within its max in flight', () => {
+    const limiter = new RateLimiter();
+    const {pending, socket} = connection();
+    const rsocket = limiter.wrap(socket);
+    limiter.update([hint('Get', 2, 0)]);
+
+    ['Get', 'Get', 'Get', 'Put'].forEach(method => request(rsocket, method));
+    expect(pending.map(call => call.method)).to.deep.equal([
+      'Get',
+      'Get',
+      'Put',
+    ]);
+    expect(limiter.waiting('foo.Bar', 'Get')).to.equal(1);
+
+    pending.shift().respond();
+    expect(pending.map(call => call.method)).to.deep.equal([
+      'Get',
+      'Put',
+      'Get',
+    ]);
+    expect(limiter.waiting('foo.Bar', 'Get')).to.equal(0);
+  });
+
+  it('holds calls back until the retry after passes', done => {
+    const limiter = new RateLimiter();
+    const {pending, socket} = connection();
+    limiter.update([hint('Get', 0, 20)]);
+
+    const responses = request(limiter.wrap(socket), 'Get');
+    expect(pending.length).to.equal(0);
+    setTimeout(() => {
+      expect(pending.length).to.equal(1);
+      pending[0].respond();
+      expect(responses.length).to.equal(1);
+      done();
+    }, 40);
+  });
+
+  it('drops calls cancelled while held back', () => {
+    const limiter = new RateLimiter();
+    const {pending, socket} = connection();
+    limiter.update([hint('Get', 1, 0)]);
+
+    request(limiter.wrap(socket), 'Get');
+    limiter
+      .wrap(socket)
+      .requestResponse({
+        data: Buffer.from('Get'),
+        metadata: encodeMetadata('foo.Bar', 'Get', undefined, Buffer.alloc(0)),
+      })
+      .subscribe({onSubscribe: cancel => cancel()});
+    expect(limiter.waiting('foo.Bar', 'Get')).to.equal(0);
+
+    pending.shift().respond();
+    expect(pending.length).to.equal(0);
+  });
+
+  it('applies the hints a publisher pushes', () => {
+    const limiter = new RateLimiter();
+    const responder = limiter.responder();
+    const publisher = new RateHintPublisher();
+    publisher.add(
+      connection(payload => responder.metadataPush(payload)).socket,
+    );
+
+    publisher.publish([hint('Get', 4, 0)]);
+    expect(limiter.hint('foo.Bar', 'Get')).to.deep.equal(hint('Get', 4, 0));
+
+    // New clients get the hints in effect, and lifted hints are forgotten
+    const late = new RateLimiter();
+    const lateResponder = late.responder();
+    publisher.add(
+      connection(payload => lateResponder.metadataPush(payload)).socket,
+    );
+    expect(late.hint('foo.Bar', 'Get')).to.deep.equal(hint('Get', 4, 0));
+    publisher.publish([hint('Get', 0, 0)]);
+    expect(limiter.hint('foo.Bar', 'Get')).to.equal(null);
+    expect(publisher.size()).to.equal(2);
+  });
+
+  it('throttles calls that name their service by id', () => {
+    const limiter = new RateLimiter();
+    const {pending, socket} = connection();
+    const rsocket = limiter.wrap(socket);
+    limiter.update([hint('Get', 1, 0)]);
+
+    const id = serviceId('foo.Bar');
+    const empty = Buffer.alloc(0);
+    const metadata = encodeMetadataV2('', 'Get', undefined, empty, id);
+    [1, 2].forEach(() =>
+      rsocket
+        .requestResponse({data: Buffer.from('Get'), metadata})
+        .subscribe(),
+    );
+    expect(pending.length).to.equal(1);
+    expect(limiter.waiting('foo.Bar', 'Get')).to.equal(1);
+  });
+
+  it('hints at the methods with calls waiting in a scheduler', done => {
+    const scheduler = new PriorityScheduler(2);
+    const publisher = new RateHintPublisher();
+    const limiter = new RateLimiter();
+    const responder = limiter.responder();
+    publisher.add(
+      connection(payload => responder.metadataPush(payload)).socket,
+    );
+    const running = [];
+    const call = () =>
+      scheduler
+        .single(
+          3,
+          () =>
+            new Single(subscriber => {
+              subscriber.onSubscribe();
+              running.push(() => subscriber.onComplete());
+            }),
+          'foo.Bar',
+          'Get',
+        )
+        .subscribe();
+    [1, 2, 3, 4].forEach(call);
+
+    const stop = publisher.track(scheduler, 10);
+    setTimeout(() => {
+      // Two calls run and two wait
+      expect(limiter.hint('foo.Bar', 'Get')).to.deep.equal(
+        hint('Get', 2, 0, 2),
+      );
+      running.forEach(complete => complete());
+      setTimeout(() => {
+        expect(limiter.hint('foo.Bar', 'Get')).to.equal(null);
+        stop();
+        done();
+      }, 25);
+    }, 25);
+  });
+});
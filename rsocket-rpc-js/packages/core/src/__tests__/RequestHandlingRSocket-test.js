@@ -0,0 +1,119 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Flowable, Single} from 'rsocket-flowable';
+import {encodeMetadata} from 'rsocket-rpc-frames';
+
+import PriorityScheduler from '../PriorityScheduler';
+import RequestHandlingRSocket from '../RequestHandlingRSocket';
+
+function channel(service) {
+  return Flowable.just(
+    {
+      data: Buffer.from('first'),
+      metadata: encodeMetadata(
+        service,
+        'method',
+        Buffer.alloc(0),
+        Buffer.alloc(0),
+      ),
+    },
+    {data: Buffer.from('second'), metadata: Buffer.alloc(0)},
+  );
+}
+
+function collect(flowable) {
+  const values = [];
+  flowable.subscribe({
+    onNext: payload => values.push(payload.data.toString()),
+    onSubscribe: subscription => subscription.request(10),
+  });
+  return values;
+}
+
+describe('RequestHandlingRSocket', () => {
+  it('hands the peeked first payload of a channel to the service', () => {
+    const firsts = [];
+    const rsocket = new RequestHandlingRSocket();
+    rsocket.addService('foo.Bar', {
+      handleChannel: (payload, payloads) => {
+        firsts.push(payload.data.toString());
+        return payloads;
+      },
+      requestChannel: () => Flowable.error(new Error('not peeked')),
+    });
+
+    const values = collect(rsocket.requestChannel(channel('foo.Bar')));
+    expect(firsts).to.deep.equal(['first']);
+    expect(values).to.deep.equal(['first', 'second']);
+  });
+
+  it('observes the requests of a channel through its handler', () => {
+    const events = [];
+    const rsocket = new RequestHandlingRSocket();
+    rsocket.addService('foo.Bar', {
+      channelFlow: payload => {
+        events.push('flow ' + payload.data.toString());
+        return {
+          buffer: value => events.push('buffer ' + value.data.toString()),
+          close: () => events.push('close'),
+          next: value => events.push('next ' + value.data.toString()),
+          request: n => events.push('request ' + n),
+          unbuffer: value => events.push('unbuffer ' + value.data.toString()),
+        };
+      },
+      handleChannel: (payload, payloads) => payloads,
+    });
+
+    collect(rsocket.requestChannel(channel('foo.Bar')));
+    expect(events).to.deep.equal([
+      'flow first',
+      'buffer first',
+      'request 10',
+      'unbuffer first',
+      'next first',
+      'next second',
+      'close',
+    ]);
+  });
+
+  it('falls back to requestChannel for other services', () => {
+    const rsocket = new RequestHandlingRSocket();
+    rsocket.addService('foo.Bar', {requestChannel: payloads => payloads});
+
+    const values = collect(rsocket.requestChannel(channel('foo.Bar')));
+    expect(values).to.deep.equal(['first', 'second']);
+  });
+
+  it('admits requests by the priorities of their methods', () => {
+    const started = [];
+    const pending = [];
+    const rsocket = new RequestHandlingRSocket(new PriorityScheduler(1));
+    rsocket.addService('foo.Bar', {
+      priorities: {Health: 1, Export: 4, Query: 2},
+      requestResponse: payload =>
+        new Single(subscriber => {
+          subscriber.onSubscribe();
+          started.push(payload.data.toString());
+          pending.push(() => subscriber.onComplete(payload));
+        }),
+    });
+    const request = method =>
+      rsocket
+        .requestResponse({
+          data: Buffer.from(method),
+          metadata: encodeMetadata(
+            'foo.Bar',
+            method,
+            Buffer.alloc(0),
+            Buffer.alloc(0),
+          ),
+        })
+        .subscribe();
+
+    ['Export', 'Export', 'Query', 'Health'].forEach(request);
+    expect(started).to.deep.equal(['Export', 'Health']);
+    pending.shift()();
+    pending.shift()();
+    expect(started).to.deep.equal(['Export', 'Health', 'Query']);
+  });
+});
@@ -0,0 +1,49 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+
+import ResponseCache from '../ResponseCache';
+
+function counter() {
+  return {
+    count: 0,
+    inc() {
+      this.count++;
+    },
+  };
+}
+
+describe('ResponseCache', () => {
+  it('counts hits and misses', () => {
+    const hits = counter();
+    const misses = counter();
+    const cache = new ResponseCache(10, 0, hits, misses);
+    expect(cache.get('key')).to.equal(null);
+    cache.put('key', Buffer.from('value'));
+    expect(cache.get('key').toString()).to.equal('value');
+    expect(hits.count).to.equal(1);
+    expect(misses.count).to.equal(1);
+  });
+
+  it('evicts the least recently used entry', () => {
+    const cache = new ResponseCache(2, 0);
+    cache.put('a', Buffer.from('a'));
+    cache.put('b', Buffer.from('b'));
+    cache.get('a');
+    cache.put('c', Buffer.from('c'));
+    expect(cache.size()).to.equal(2);
+    expect(cache.get('b')).to.equal(null);
+    expect(cache.get('a')).to.not.equal(null);
+    expect(cache.get('c')).to.not.equal(null);
+  });
+
+  it('expires entries after the ttl', done => {
+    const cache = new ResponseCache(10, 10);
+    cache.put('a', Buffer.from('a'));
+    expect(cache.get('a')).to.not.equal(null);
+    setTimeout(() => {
+      expect(cache.get('a')).to.equal(null);
+      expect(cache.size()).to.equal(0);
+      done();
+    }, 30);
+  });
+});
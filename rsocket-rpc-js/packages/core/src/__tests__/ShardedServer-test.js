@@ -0,0 +1,111 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import net from 'net';
+import path from 'path';
+
+import PortDuplexConnection, {ACK_SIZE} from '../PortDuplexConnection';
+import ShardedServer from '../ShardedServer';
+
+const WORKER = path.join(__dirname, 'echoShard.js');
+const PORT = 9898;
+
+function connect() {
+  return new Promise((resolve, reject) => {
+    const socket = net.connect(PORT, () => resolve(socket));
+    socket.on('error', reject);
+  });
+}
+
+function send(socket, data) {
+  return new Promise(resolve => {
+    socket.once('data', reply => resolve(reply.toString()));
+    socket.write(data);
+  });
+}
+
+function delay() {
+  return new Promise(resolve => setTimeout(resolve, 50));
+}
+
+function listen(server) {
+  return new Promise((resolve, reject) =>
+    server.listen(PORT).subscribe({onComplete: resolve, onError: reject}),
+  );
+}
+
+describe('ShardedServer', () => {
+  it('hands connections to the workers serving the fewest', done => {
+    const server = new ShardedServer(WORKER, {workers: 2});
+    let sockets;
+    listen(server)
+      .then(() => Promise.all([connect(), connect(), connect()]))
+      .then(connected => {
+        sockets = connected;
+        return delay();
+      })
+      .then(() => {
+        expect(server.connections()).to.deep.equal([2, 1]);
+        sockets[0].destroy();
+        sockets[2].destroy();
+        return delay();
+      })
+      .then(() => connect())
+      .then(socket => {
+        sockets.push(socket);
+        return delay();
+      })
+      .then(() => {
+        expect(server.connections()).to.deep.equal([1, 1]);
+        server.close();
+        sockets.forEach(socket => socket.destroy());
+        done();
+      })
+      .catch(done);
+  });
+
+  it('acknowledges the bytes a worker handled', () => {
+    const posted = [];
+    let receive = null;
+    const port = {
+      close: () => {},
+      on: (event, listener) => {
+        if (event === 'message') {
+          receive = listener;
+        }
+      },
+      postMessage: message => posted.push(message),
+    };
+    new PortDuplexConnection(port);
+
+    // The start of a frame too large to be handled at once
+    const chunk = Buffer.alloc(ACK_SIZE / 4, 0xff);
+    receive(chunk);
+    receive(chunk);
+    receive(chunk);
+    expect(posted).to.deep.equal([]);
+    receive(chunk);
+    expect(posted).to.deep.equal([ACK_SIZE]);
+  });
+
+  it('moves the bytes of a connection to and from its worker', done => {
+    const server = new ShardedServer(WORKER, {workers: 2});
+    let sockets;
+    listen(server)
+      .then(() => Promise.all([connect(), connect()]))
+      .then(connected => {
+        sockets = connected;
+        return Promise.all(sockets.map(socket => send(socket, 'ping')));
+      })
+      .then(replies => {
+        const [first, second] = replies.map(reply => reply.split('@'));
+        expect(first[0]).to.equal('ping');
+        expect(second[0]).to.equal('ping');
+        // Each connection went to a worker of its own
+        expect(first[1] === second[1]).to.equal(false);
+        server.close();
+        sockets.forEach(socket => socket.destroy());
+        done();
+      })
+      .catch(done);
+  });
+});
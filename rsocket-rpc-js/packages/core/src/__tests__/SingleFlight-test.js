@@ -0,0 +1,90 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import {Single} from 'rsocket-flowable';
+
+import requestKey from '../RequestKey';
+import SingleFlight from '../SingleFlight';
+
+function deferred(state) {
+  return () =>
+    new Single(subscriber => {
+      state.subscriptions++;
+      state.complete = value => subscriber.onComplete(value);
+      subscriber.onSubscribe(() => state.cancellations++);
+    });
+}
+
+describe('SingleFlight', () => {
+  it('shares one in-flight call between identical requests', () => {
+    const state = {subscriptions: 0, cancellations: 0};
+    const flights = new SingleFlight();
+    const results = [];
+    flights.share('a', deferred(state)).subscribe({
+      onComplete: value => results.push(value),
+    });
+    flights.share('a', deferred(state)).subscribe({
+      onComplete: value => results.push(value),
+    });
+    expect(state.subscriptions).to.equal(1);
+    state.complete('done');
+    expect(results).to.deep.equal(['done', 'done']);
+    expect(flights.inFlight()).to.equal(0);
+  });
+
+  it('cancels the source once every caller has cancelled', () => {
+    const state = {subscriptions: 0, cancellations: 0};
+    const flights = new SingleFlight();
+    const cancels = [];
+    const subscriber = {onSubscribe: cancel => cancels.push(cancel)};
+    flights.share('a', deferred(state)).subscribe(subscriber);
+    flights.share('a', deferred(state)).subscribe(subscriber);
+    cancels[0]();
+    expect(state.cancellations).to.equal(0);
+    cancels[1]();
+    expect(state.cancellations).to.equal(1);
+    expect(flights.inFlight()).to.equal(0);
+  });
+
+  it('keys requests on data and metadata', () => {
+    const data = Buffer.from('request');
+    expect(requestKey(data)).to.equal(requestKey(data, Buffer.alloc(0)));
+    expect(requestKey(data, Buffer.from('a'))).to.not.equal(
+      requestKey(data, Buffer.from('b')),
+    );
+    expect(requestKey(Buffer.from('ab'), Buffer.from('c'))).to.not.equal(
+      requestKey(Buffer.from('a'), Buffer.from('bc')),
+    );
+  });
+
+  it('keys requests on the named entries of their metadata', () => {
+    const entries = (...pairs) =>
+      Buffer.concat(
+        pairs.map(pair => {
+          const buffer = Buffer.alloc(4 + pair[0].length + pair[1].length);
+          buffer.writeUInt16BE(pair[0].length, 0);
+          buffer.write(pair[0], 2);
+          buffer.writeUInt16BE(pair[1].length, 2 + pair[0].length);
+          buffer.write(pair[1], 4 + pair[0].length);
+          return buffer;
+        }),
+      );
+    const data = Buffer.from('request');
+    const names = ['tenant', 'locale'];
+
+    expect(
+      requestKey(data, entries(['tenant', 'a'], ['request-id', '1']), names),
+    ).to.equal(
+      requestKey(data, entries(['request-id', '2'], ['tenant', 'a']), names),
+    );
+    expect(requestKey(data, entries(['tenant', 'a']), names)).to.not.equal(
+      requestKey(data, entries(['tenant', 'b']), names),
+    );
+    expect(requestKey(data, entries(['tenant', 'a']), names)).to.not.equal(
+      requestKey(data, entries(['locale', 'a']), names),
+    );
+    // Metadata that holds no key/value pairs is keyed as a whole
+    expect(requestKey(data, Buffer.from([0, 9, 1]), names)).to.not.equal(
+      requestKey(data, Buffer.from([0, 9, 2]), names),
+    );
+  });
+});
@@ -0,0 +1,76 @@
+import {expect} from 'chai';
+import {describe, it} from 'mocha';
+import path from 'path';
+
+import WorkerPool from '../WorkerPool';
+
+const WORKER = path.join(__dirname, 'echoWorker.js');
+
+function run(pool, method, data, metadata) {
+  return new Promise((resolve, reject) =>
+    pool
+      .run('test.Echo', method, Buffer.from(data), Buffer.from(metadata || ''))
+      .subscribe({onComplete: resolve, onError: reject}),
+  );
+}
+
+function observer() {
+  const state = {busy: 0, queued: 0, workers: 0};
+  state.observer = {
+    busy: count => (state.busy = Math.max(state.busy, count)),
+    queued: count => (state.queued = Math.max(state.queued, count)),
+    workers: count => (state.workers = count),
+  };
+  return state;
+}
+
+describe('WorkerPool', () => {
+  it('runs calls on a worker', done => {
+    const pool = new WorkerPool(WORKER, {size: 1});
+    run(pool, 'Echo', 'request', '+metadata')
+      .then(response => {
+        expect(response.toString()).to.equal('request+metadata');
+        pool.close();
+        done();
+      })
+      .catch(done);
+  });
+
+  it('queues calls once every worker is busy', done => {
+    const state = observer();
+    const pool = new WorkerPool(WORKER, {observer: state.observer, size: 2});
+    Promise.all([1, 2, 3, 4, 5].map(i => run(pool, 'Wait', String(i))))
+      .then(responses => {
+        expect(responses.map(String)).to.deep.equal(['1', '2', '3', '4', '5']);
+        expect(state.workers).to.equal(2);
+        expect(state.busy).to.equal(2);
+        expect(state.queued).to.equal(3);
+        pool.close();
+        done();
+      })
+      .catch(done);
+  });
+
+  it('fails calls the worker fails', done => {
+    const pool = new WorkerPool(WORKER, {size: 1});
+    run(pool, 'Missing', 'request')
+      .then(() => done(new Error('completed')))
+      .catch(error => {
+        expect(error.message).to.equal('unknown method');
+        pool.close();
+        done();
+      })
+      .catch(done);
+  });
+
+  it('fails calls once closed', done => {
+    const pool = new WorkerPool(WORKER, {size: 1});
+    pool.close();
+    run(pool, 'Echo', 'request')
+      .then(() => done(new Error('completed')))
+      .catch(error => {
+        expect(error.message).to.equal('WorkerPool is closed');
+        done();
+      });
+  });
+});
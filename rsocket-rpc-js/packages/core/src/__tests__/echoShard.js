@@ -0,0 +1,16 @@
+'use strict';
+
+// Runs on the workers of ShardedServer-test.js, answering each chunk of a
+// connection's bytes with the chunk and the worker's thread id
+const {parentPort, threadId} = require('worker_threads');
+
+parentPort.on('message', ({port}) => {
+  port.on('message', data => {
+    if (data == null) {
+      port.close();
+      return;
+    }
+    const reply = Buffer.from(Buffer.from(data).toString() + '@' + threadId);
+    port.postMessage(reply);
+  });
+});
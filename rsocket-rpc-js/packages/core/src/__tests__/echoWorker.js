@@ -0,0 +1,24 @@
+'use strict';
+
+// Runs on the workers of WorkerPool-test.js and LoopbackRSocket-test.js, from
+// the built package
+const {Single} = require('rsocket-flowable');
+const {serveOffloaded} = require('../../dist/WorkerPool');
+
+serveOffloaded({
+  service: 'test.Echo',
+  handleOffloaded: (method, data, metadata) => {
+    switch (method) {
+      case 'Echo':
+        return Single.of(Buffer.concat([Buffer.from(data), metadata]));
+      case 'Wait': {
+        // Keeps the worker busy
+        const end = Date.now() + 20;
+        while (Date.now() < end) {}
+        return Single.of(new Uint8Array(data));
+      }
+      default:
+        return Single.error(new Error('unknown method'));
+    }
+  },
+});
@@ -20,17 +20,55 @@
 
 import RequestHandlingRSocket from './RequestHandlingRSocket';
 import RpcClient from './RpcClient';
+import RSocketPool from './RSocketPool';
 import QueuingFlowableProcessor from './QueuingFlowableProcessor';
 import SwitchTransformOperator from './SwitchTransformOperator';
+import hedgeSingle from './HedgingSingle';
+import ResponseCache from './ResponseCache';
+import requestKey from './RequestKey';
+import SingleFlight from './SingleFlight';
+import Compression from './Compression';
+import {packPayloads, unpackPayloads} from './PackedPayloads';
+import {chunkPayloads, joinChunks, repeatedField} from './ChunkedPayloads';
+import {toFlowable, withAsyncIterator} from './AsyncIterables';
+import LoopbackRSocket, {localServer} from './LoopbackRSocket';
+import WorkerPool, {serveOffloaded} from './WorkerPool';
+import ShardedServer, {serveShard} from './ShardedServer';
+import PriorityScheduler from './PriorityScheduler';
+import RateLimiter from './RateLimiter';
+import RateHintPublisher from './RateHintPublisher';
 
 /**
  * The public API of the `core` package.
  */
 export type {ClientConfig} from './RpcClient';
+export type {OffloadedService, WorkerPoolObserver} from './WorkerPool';
 
 export {
   RequestHandlingRSocket,
   RpcClient,
+  RSocketPool,
   QueuingFlowableProcessor,
   SwitchTransformOperator,
+  hedgeSingle,
+  ResponseCache,
+  requestKey,
+  SingleFlight,
+  Compression,
+  packPayloads,
+  unpackPayloads,
+  chunkPayloads,
+  joinChunks,
+  repeatedField,
+  toFlowable,
+  withAsyncIterator,
+  LoopbackRSocket,
+  localServer,
+  WorkerPool,
+  serveOffloaded,
+  ShardedServer,
+  serveShard,
+  PriorityScheduler,
+  RateLimiter,
+  RateHintPublisher,
 };
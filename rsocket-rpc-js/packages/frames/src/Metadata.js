@@ -24,16 +24,33 @@ import type {Encodable} from 'rsocket-types';
 
 import {UTF8Encoder, BufferEncoder, createBuffer} from 'rsocket-core';
 
+import {readVarint, varintSize, writeVarint} from './Varint';
+
 /**
  * Version
  */
 export const VERSION = 1;
+export const VERSION_2 = 2;
+// Rate hints pushed by servers, see encodeRateHints()
+export const VERSION_RATE_HINTS = 3;
 
 export const VERSION_SIZE = 2;
 export const SERVICE_LENGTH_SIZE = 2;
 export const METHOD_LENGTH_SIZE = 2;
 export const TRACING_LENGTH_SIZE = 2;
 
+/**
+ * Flags, carried in the high nibble of the first byte of the header
+ */
+export const FLAG_DEFLATE = 0x10;
+export const FLAG_GZIP = 0x20;
+// Version 2 only: a tracing segment follows the method
+export const FLAG_TRACING = 0x40;
+// Version 2 only: the service is sent as its interned id instead of its name
+export const FLAG_SERVICE_ID = 0x80;
+export const FLAGS_MASK = 0xf0;
+const VERSION_2_MASK = 0x0f;
+
 export function encodeMetadata(
   service: string,
   method: string,
@@ -82,11 +99,267 @@ export function encodeMetadata(
   return buffer;
 }
 
+/**
+ * Encodes a version 2 header: a single byte holding the version and flags,
+ * followed by varint length-prefixed service, method and, when present,
+ * tracing segments. Passing the service's interned id, see serviceId(),
+ * sends it in place of the service name.
+ */
+export function encodeMetadataV2(
+  service: string,
+  method: string,
+  tracing: Encodable,
+  metadata: Encodable,
+  serviceId?: number,
+): Buffer {
+  const interned = serviceId !== undefined && serviceId !== null;
+  const serviceLength = interned ? 0 : UTF8Encoder.byteLength(service);
+  const methodLength = UTF8Encoder.byteLength(method);
+  const tracingLength =
+    tracing === undefined ? 0 : BufferEncoder.byteLength(tracing);
+  const metadataLength = BufferEncoder.byteLength(metadata);
+
+  let flags = 0;
+  let size = 1 + varintSize(methodLength) + methodLength + metadataLength;
+  if (interned) {
+    flags |= FLAG_SERVICE_ID;
+    size += varintSize((serviceId: any));
+  } else {
+    size += varintSize(serviceLength) + serviceLength;
+  }
+  if (tracingLength > 0) {
+    flags |= FLAG_TRACING;
+    size += varintSize(tracingLength) + tracingLength;
+  }
+
+  const buffer = createBuffer(size);
+  buffer[0] = flags | VERSION_2;
+  let offset = 1;
+
+  if (interned) {
+    offset = writeVarint(buffer, (serviceId: any), offset);
+  } else {
+    offset = writeVarint(buffer, serviceLength, offset);
+    offset = UTF8Encoder.encode(
+      service,
+      buffer,
+      offset,
+      offset + serviceLength,
+    );
+  }
+
+  offset = writeVarint(buffer, methodLength, offset);
+  offset = UTF8Encoder.encode(method, buffer, offset, offset + methodLength);
+
+  if (tracingLength > 0) {
+    offset = writeVarint(buffer, tracingLength, offset);
+    offset = BufferEncoder.encode(
+      tracing,
+      buffer,
+      offset,
+      offset + tracingLength,
+    );
+  }
+
+  BufferEncoder.encode(metadata, buffer, offset, offset + metadataLength);
+
+  return buffer;
+}
+
+/**
+ * Services known by interned id, see internService()
+ */
+const INTERNED_SERVICES: Map<number, string> = new Map();
+
+/**
+ * Returns the id a service is interned under: the 32-bit FNV-1a hash of its
+ * UTF-8 encoded name. The code generator computes the same hash.
+ */
+export function serviceId(service: string): number {
+  const bytes = Buffer.from(service, 'utf8');
+  let hash = 0x811c9dc5;
+  for (let i = 0; i < bytes.length; i++) {
+    hash ^= bytes[i];
+    hash = Math.imul(hash, 0x01000193);
+  }
+  return hash >>> 0;
+}
+
+/**
+ * Registers a service so that headers carrying its interned id can be
+ * decoded, and returns that id.
+ */
+export function internService(service: string): number {
+  const id = serviceId(service);
+  const existing = INTERNED_SERVICES.get(id);
+  if (existing !== undefined && existing !== service) {
+    throw new Error(
+      'Services ' + existing + ' and ' + service + ' have the same id ' + id,
+    );
+  }
+  INTERNED_SERVICES.set(id, service);
+  return id;
+}
+
 export function getVersion(buffer: Buffer): number {
-  return buffer.readUInt16BE(0);
+  const version = buffer[0] & VERSION_2_MASK;
+  return version === 0 ? buffer.readUInt16BE(0) & ~(FLAGS_MASK << 8) : version;
+}
+
+/**
+ * Returns the flags of a request header, or of the flags-only metadata sent
+ * with responses. Empty metadata has no flags set.
+ */
+export function getFlags(buffer: ?Buffer): number {
+  return buffer && buffer.length > 0 ? buffer[0] & FLAGS_MASK : 0;
+}
+
+/**
+ * Returns a copy of a version 2 header, or of flags-only metadata, with
+ * `flags` set besides those already set. Version 1 headers have no room for
+ * flags, which would change their version field, so null is returned for
+ * them and for any other metadata.
+ */
+export function setFlags(buffer: Buffer, flags: number): ?Buffer {
+  if (buffer.length === 0 || !isVersion2(buffer)) {
+    return null;
+  }
+  const copy = createBuffer(buffer.length);
+  BufferEncoder.encode(buffer, copy, 0, buffer.length);
+  copy[0] |= flags & FLAGS_MASK;
+  return copy;
+}
+
+/**
+ * Encodes flags on their own, for response metadata which carries no routing
+ * information: a single version 2 byte.
+ */
+export function encodeFlags(flags: number): Buffer {
+  const buffer = createBuffer(1);
+  buffer[0] = VERSION_2 | (flags & FLAGS_MASK);
+  return buffer;
+}
+
+/**
+ * The limits a server asks its clients to call one of its methods within:
+ * how many calls a client should have in flight at most, 0 for no limit, and
+ * for how many milliseconds it should hold off calling it, 0 for not at all.
+ * The queue depth tells how many calls to the method wait on the server.
+ */
+export type RateHint = {
+  service: string,
+  method: string,
+  queueDepth: number,
+  maxInFlight: number,
+  retryAfter: number,
+};
+
+// Two length prefixes, a queue depth, a max in flight and a retry after of a
+// byte each
+const MIN_RATE_HINT_SIZE = 5;
+
+/**
+ * Encodes rate hints, sent by servers as the metadata of a metadata push: a
+ * single byte holding the version, followed by the varint count of the hints,
+ * each a varint length-prefixed service and method followed by its varint
+ * queue depth, max in flight and retry after.
+ */
+export function encodeRateHints(hints: Array<RateHint>): Buffer {
+  let size = 1 + varintSize(hints.length);
+  hints.forEach(hint => {
+    const serviceLength = UTF8Encoder.byteLength(hint.service);
+    const methodLength = UTF8Encoder.byteLength(hint.method);
+    size +=
+      varintSize(serviceLength) +
+      serviceLength +
+      varintSize(methodLength) +
+      methodLength +
+      varintSize(hint.queueDepth) +
+      varintSize(hint.maxInFlight) +
+      varintSize(hint.retryAfter);
+  });
+
+  const buffer = createBuffer(size);
+  buffer[0] = VERSION_RATE_HINTS;
+  let offset = writeVarint(buffer, hints.length, 1);
+
+  hints.forEach(hint => {
+    const serviceLength = UTF8Encoder.byteLength(hint.service);
+    offset = writeVarint(buffer, serviceLength, offset);
+    offset = UTF8Encoder.encode(
+      hint.service,
+      buffer,
+      offset,
+      offset + serviceLength,
+    );
+    const methodLength = UTF8Encoder.byteLength(hint.method);
+    offset = writeVarint(buffer, methodLength, offset);
+    offset = UTF8Encoder.encode(
+      hint.method,
+      buffer,
+      offset,
+      offset + methodLength,
+    );
+    offset = writeVarint(buffer, hint.queueDepth, offset);
+    offset = writeVarint(buffer, hint.maxInFlight, offset);
+    offset = writeVarint(buffer, hint.retryAfter, offset);
+  });
+
+  return buffer;
+}
+
+/**
+ * Decodes the rate hints a server pushed, or returns null when the metadata
+ * holds something else or is cut short. As it comes from the peer, every
+ * length is checked against the buffer.
+ */
+export function decodeRateHints(buffer: ?Buffer): ?Array<RateHint> {
+  if (!buffer || buffer.length === 0 || buffer[0] !== VERSION_RATE_HINTS) {
+    return null;
+  }
+  let count = readBoundedVarint(buffer, 1);
+  if (count < 0 || count * MIN_RATE_HINT_SIZE > buffer.length - varintEnd) {
+    return null;
+  }
+  const hints = [];
+  let offset = varintEnd;
+  while (count-- > 0) {
+    const service = readBoundedString(buffer, offset);
+    if (service == null) {
+      return null;
+    }
+    const method = readBoundedString(buffer, varintEnd);
+    if (method == null) {
+      return null;
+    }
+    const queueDepth = readBoundedVarint(buffer, varintEnd);
+    const maxInFlight =
+      queueDepth < 0 ? -1 : readBoundedVarint(buffer, varintEnd);
+    const retryAfter =
+      maxInFlight < 0 ? -1 : readBoundedVarint(buffer, varintEnd);
+    if (retryAfter < 0) {
+      return null;
+    }
+    offset = varintEnd;
+    hints.push({maxInFlight, method, queueDepth, retryAfter, service});
+  }
+  return offset === buffer.length ? hints : null;
 }
 
 export function getService(buffer: Buffer): string {
+  if (isVersion2(buffer)) {
+    const value =
+      buffer[0] & FLAG_SERVICE_ID
+        ? readHeaderVarint(buffer, 1)
+        : readHeaderLength(buffer, 1);
+    if (buffer[0] & FLAG_SERVICE_ID) {
+      const service = INTERNED_SERVICES.get(value);
+      // An unknown id fails the service lookup like any unknown name would
+      return service !== undefined ? service : '#' + value;
+    }
+    return UTF8Encoder.decode(buffer, varintEnd, varintEnd + value);
+  }
+
   let offset = VERSION_SIZE;
 
   const serviceLength = buffer.readUInt16BE(offset);
@@ -95,7 +368,23 @@ export function getService(buffer: Buffer): string {
   return UTF8Encoder.decode(buffer, offset, offset + serviceLength);
 }
 
+/**
+ * Returns the interned id of the service of a request, see serviceId(),
+ * whether the header carries the id or the name of the service.
+ */
+export function getServiceId(buffer: Buffer): number {
+  if (isVersion2(buffer) && buffer[0] & FLAG_SERVICE_ID) {
+    return readHeaderVarint(buffer, 1);
+  }
+  return serviceId(getService(buffer));
+}
+
 export function getMethod(buffer: Buffer): string {
+  if (isVersion2(buffer)) {
+    const methodLength = readHeaderLength(buffer, methodOffsetV2(buffer));
+    return UTF8Encoder.decode(buffer, varintEnd, varintEnd + methodLength);
+  }
+
   let offset = VERSION_SIZE;
 
   const serviceLength = buffer.readUInt16BE(offset);
@@ -108,6 +397,15 @@ export function getMethod(buffer: Buffer): string {
 }
 
 export function getTracing(buffer: Buffer): Buffer {
+  if (isVersion2(buffer)) {
+    const offset = tracingOffsetV2(buffer);
+    if ((buffer[0] & FLAG_TRACING) === 0) {
+      return BufferEncoder.decode(buffer, offset, offset);
+    }
+    const tracingLength = readHeaderLength(buffer, offset);
+    return BufferEncoder.decode(buffer, varintEnd, varintEnd + tracingLength);
+  }
+
   let offset = VERSION_SIZE;
 
   const serviceLength = buffer.readUInt16BE(offset);
@@ -122,7 +420,41 @@ export function getTracing(buffer: Buffer): Buffer {
   return BufferEncoder.decode(buffer, offset, offset + tracingLength);
 }
 
+/**
+ * Returns the offset of the contents of the tracing segment of a request
+ * header, past its length, for it to be filled in place once encoded.
+ */
+export function getTracingOffset(buffer: Buffer): number {
+  if (isVersion2(buffer)) {
+    const offset = tracingOffsetV2(buffer);
+    if ((buffer[0] & FLAG_TRACING) === 0) {
+      return offset;
+    }
+    readHeaderLength(buffer, offset);
+    return varintEnd;
+  }
+
+  let offset = VERSION_SIZE;
+
+  const serviceLength = buffer.readUInt16BE(offset);
+  offset += SERVICE_LENGTH_SIZE + serviceLength;
+
+  const methodLength = buffer.readUInt16BE(offset);
+  offset += METHOD_LENGTH_SIZE + methodLength;
+
+  return offset + TRACING_LENGTH_SIZE;
+}
+
 export function getMetadata(buffer: Buffer): Buffer {
+  if (isVersion2(buffer)) {
+    let offset = tracingOffsetV2(buffer);
+    if (buffer[0] & FLAG_TRACING) {
+      const tracingLength = readHeaderLength(buffer, offset);
+      offset = varintEnd + tracingLength;
+    }
+    return BufferEncoder.decode(buffer, offset, buffer.length);
+  }
+
   let offset = VERSION_SIZE;
 
   const serviceLength = buffer.readUInt16BE(offset);
@@ -136,3 +468,66 @@ export function getMetadata(buffer: Buffer): Buffer {
 
   return BufferEncoder.decode(buffer, offset, buffer.length);
 }
+
+function isVersion2(buffer: Buffer): boolean {
+  return (buffer[0] & VERSION_2_MASK) === VERSION_2;
+}
+
+function methodOffsetV2(buffer: Buffer): number {
+  if (buffer[0] & FLAG_SERVICE_ID) {
+    readHeaderVarint(buffer, 1);
+    return varintEnd;
+  }
+  const serviceLength = readHeaderLength(buffer, 1);
+  return varintEnd + serviceLength;
+}
+
+function tracingOffsetV2(buffer: Buffer): number {
+  const methodLength = readHeaderLength(buffer, methodOffsetV2(buffer));
+  return varintEnd + methodLength;
+}
+
+// Offset just past the last varint read, saves allocating a result object
+let varintEnd = 0;
+const cursor = {offset: 0};
+
+// Reads a varint that ends within the buffer, or returns -1
+function readBoundedVarint(buffer: Buffer, offset: number): number {
+  cursor.offset = offset;
+  const value = readVarint(buffer, cursor);
+  varintEnd = cursor.offset;
+  return value;
+}
+
+// Reads a varint of a request header. Headers come from the peer, so one
+// cut short or overlong is rejected, as version 1 headers are when their
+// lengths run past the buffer.
+function readHeaderVarint(buffer: Buffer, offset: number): number {
+  const value = readBoundedVarint(buffer, offset);
+  if (value < 0) {
+    throw new RangeError('Malformed request header');
+  }
+  return value;
+}
+
+// Reads the varint length of a segment of a request header, which must end
+// within the buffer
+function readHeaderLength(buffer: Buffer, offset: number): number {
+  const length = readHeaderVarint(buffer, offset);
+  if (length > buffer.length - varintEnd) {
+    throw new RangeError('Malformed request header');
+  }
+  return length;
+}
+
+// Reads a varint length-prefixed string that ends within the buffer, or
+// returns null
+function readBoundedString(buffer: Buffer, offset: number): ?string {
+  const length = readBoundedVarint(buffer, offset);
+  if (length < 0 || length > buffer.length - varintEnd) {
+    return null;
+  }
+  const start = varintEnd;
+  varintEnd = start + length;
+  return UTF8Encoder.decode(buffer, start, varintEnd);
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+/* eslint-disable no-bitwise */
+
+/**
+ * Base 128 varints, as protobuf encodes lengths with, prefixing the segments
+ * of version 2 request headers and rate hints, and the messages of packed
+ * and chunked payloads.
+ */
+
+// Bytes of a varint of a uint32, at most
+export const MAX_VARINT_SIZE = 5;
+
+/**
+ * Writes `value` at `offset`, returning the offset just past it
+ */
+export function writeVarint(
+  buffer: Buffer,
+  value: number,
+  offset: number,
+): number {
+  while (value > 0x7f) {
+    buffer[offset++] = (value & 0x7f) | 0x80;
+    value = Math.floor(value / 128);
+  }
+  buffer[offset++] = value;
+  return offset;
+}
+
+/**
+ * The number of bytes writeVarint() writes `value` in
+ */
+export function varintSize(value: number): number {
+  let size = 1;
+  while (value > 0x7f) {
+    value = Math.floor(value / 128);
+    size++;
+  }
+  return size;
+}
+
+/**
+ * Reads the varint at `cursor.offset`, moving the cursor past it. As varints
+ * come from the peer, one that runs past the end of the buffer or over
+ * MAX_VARINT_SIZE bytes is not read: -1 is returned and the cursor is left
+ * as it is.
+ */
+export function readVarint(buffer: Buffer, cursor: {offset: number}): number {
+  let offset = cursor.offset;
+  let value = 0;
+  for (let i = 0; i < MAX_VARINT_SIZE && offset < buffer.length; i++) {
+    const byte = buffer[offset++];
+    value += (byte & 0x7f) * Math.pow(2, 7 * i);
+    if ((byte & 0x80) === 0) {
+      cursor.offset = offset;
+      return value;
+    }
+  }
+  return -1;
+}
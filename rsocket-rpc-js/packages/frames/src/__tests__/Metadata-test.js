@@ -3,11 +3,26 @@ import {describe, it} from 'mocha';
 
 import {
   encodeMetadata,
+  encodeMetadataV2,
+  serviceId,
+  internService,
   getService,
+  getServiceId,
   getMethod,
   getTracing,
+  getTracingOffset,
   getMetadata,
+  getVersion,
+  getFlags,
+  setFlags,
+  encodeFlags,
+  encodeRateHints,
+  decodeRateHints,
+  FLAG_GZIP,
+  VERSION,
+  VERSION_2,
 } from '../Metadata';
+import {readVarint, varintSize, writeVarint} from '../Varint';
 
 function randomBytes(min, max) {
   let size = Math.floor(Math.random() * (max - min)) + min;
@@ -47,4 +62,219 @@ describe('METADATA', () => {
     expect(tracing).to.deep.equal(getTracing(encoded));
     expect(metadata).to.deep.equal(getMetadata(encoded));
   });
+
+  it('sets flags on a copy without disturbing the header', () => {
+    const tracing = Buffer.from(randomBytes(5, 20));
+    const encoded = encodeMetadataV2(
+      'service',
+      'foo',
+      tracing,
+      Buffer.alloc(0),
+    );
+
+    const flags = getFlags(encoded);
+    const flagged = setFlags(encoded, FLAG_GZIP);
+
+    expect(getFlags(encoded)).to.equal(flags);
+    expect(getFlags(flagged)).to.equal(flags | FLAG_GZIP);
+    expect(getVersion(flagged)).to.equal(VERSION_2);
+    expect(getService(flagged)).to.equal('service');
+    expect(getMethod(flagged)).to.equal('foo');
+    expect(getTracing(flagged)).to.deep.equal(tracing);
+  });
+
+  it('sets no flags on version 1 headers', () => {
+    const tracing = Buffer.from(randomBytes(5, 20));
+    const encoded = encodeMetadata('service', 'foo', tracing, Buffer.alloc(0));
+
+    expect(setFlags(encoded, FLAG_GZIP)).to.equal(null);
+    expect(getFlags(encoded)).to.equal(0);
+    expect(getVersion(encoded)).to.equal(VERSION);
+  });
+
+  it('encodes flags on their own', () => {
+    expect(getFlags(encodeFlags(FLAG_GZIP))).to.equal(FLAG_GZIP);
+    expect(getFlags(Buffer.alloc(0))).to.equal(0);
+    expect(getFlags(null)).to.equal(0);
+  });
+
+  it('serializes/deserializes version 2 metadata', () => {
+    const method = 'foo'.repeat(50);
+    const tracing = Buffer.from(randomBytes(5, 20));
+    const metadata = Buffer.from(randomBytes(5, 20));
+
+    const encoded = encodeMetadataV2('service', method, tracing, metadata);
+
+    expect(getVersion(encoded)).to.equal(VERSION_2);
+    expect(getService(encoded)).to.equal('service');
+    expect(getMethod(encoded)).to.equal(method);
+    expect(getTracing(encoded)).to.deep.equal(tracing);
+    expect(getMetadata(encoded)).to.deep.equal(metadata);
+  });
+
+  it('omits an empty tracing segment from version 2 metadata', () => {
+    const metadata = Buffer.from([1, 2, 3]);
+
+    const encoded = encodeMetadataV2('service', 'foo', undefined, metadata);
+
+    expect(encoded.length).to.equal(1 + 8 + 4 + 3);
+    expect(getTracing(encoded)).to.deep.equal(Buffer.from([]));
+    expect(getMetadata(encoded)).to.deep.equal(metadata);
+  });
+
+  it('locates the tracing segment of either version', () => {
+    const tracing = Buffer.from([4, 5]);
+    const metadata = Buffer.from([1, 2, 3]);
+
+    const v1 = encodeMetadata('service', 'foo', tracing, metadata);
+    expect(getTracingOffset(v1)).to.equal(2 + 9 + 5 + 2);
+    const v2 = encodeMetadataV2('service', 'foo', tracing, metadata);
+    expect(getTracingOffset(v2)).to.equal(1 + 8 + 4 + 1);
+  });
+
+  it('rejects version 2 headers cut short or overlong', () => {
+    const encoded = encodeMetadataV2(
+      'service',
+      'foo',
+      Buffer.from([4, 5]),
+      Buffer.alloc(0),
+    );
+    // Cut within the service name, the method name and the tracing segment
+    [3, 12, 15].forEach(length => {
+      const cut = encoded.slice(0, length);
+      expect(() => {
+        getService(cut);
+        getMethod(cut);
+        getTracing(cut);
+      }).to.throw(RangeError);
+    });
+    // A service length that never ends
+    const overlong = Buffer.from([encoded[0], 0xff, 0xff, 0xff, 0xff, 0xff, 1]);
+    expect(() => getService(overlong)).to.throw(RangeError);
+    expect(() => getMethod(overlong)).to.throw(RangeError);
+  });
+
+  it('reads varints within the buffer and their size only', () => {
+    const buffer = Buffer.alloc(5);
+    [0, 127, 128, 16384, 0xffffffff].forEach(value => {
+      const end = writeVarint(buffer, value, 0);
+      expect(end).to.equal(varintSize(value));
+      const cursor = {offset: 0};
+      expect(readVarint(buffer.slice(0, end), cursor)).to.equal(value);
+      expect(cursor.offset).to.equal(end);
+      expect(readVarint(buffer.slice(0, end - 1), {offset: 0})).to.equal(-1);
+    });
+    const cursor = {offset: 0};
+    expect(readVarint(Buffer.alloc(6, 0x80), cursor)).to.equal(-1);
+    expect(cursor.offset).to.equal(0);
+  });
+
+  it('sends interned services by id', () => {
+    const id = internService('io.rsocket.rpc.Interned');
+    const encoded = encodeMetadataV2(
+      'io.rsocket.rpc.Interned',
+      'foo',
+      undefined,
+      Buffer.alloc(0),
+      id,
+    );
+
+    expect(encoded.length).to.equal(1 + 5 + 4);
+    expect(getService(encoded)).to.equal('io.rsocket.rpc.Interned');
+    expect(getMethod(encoded)).to.equal('foo');
+
+    setFlags(encoded, FLAG_GZIP);
+    expect(getService(encoded)).to.equal('io.rsocket.rpc.Interned');
+    expect(getVersion(encoded)).to.equal(VERSION_2);
+  });
+
+  it('fails the lookup of unknown interned services', () => {
+    const encoded = encodeMetadataV2('x', 'foo', undefined, Buffer.alloc(0), 7);
+
+    expect(getService(encoded)).to.equal('#7');
+  });
+
+  it('hashes service names with 32-bit FNV-1a', () => {
+    expect(serviceId('')).to.equal(0x811c9dc5);
+    expect(serviceId('a')).to.equal(0xe40c292c);
+    expect(serviceId('foobar')).to.equal(0xbf9cf968);
+  });
+
+  it('serializes/deserializes rate hints', () => {
+    const hints = [
+      {
+        maxInFlight: 0,
+        method: 'foo',
+        queueDepth: 0,
+        retryAfter: 0,
+        service: 'service',
+      },
+      {
+        maxInFlight: 16,
+        method: 'bär',
+        queueDepth: 300,
+        retryAfter: 2500,
+        service: 'other.Service',
+      },
+    ];
+
+    const encoded = encodeRateHints(hints);
+
+    expect(getVersion(encoded)).to.equal(3);
+    expect(decodeRateHints(encoded)).to.deep.equal(hints);
+    expect(decodeRateHints(encodeRateHints([]))).to.deep.equal([]);
+  });
+
+  it('tells rate hints from request headers', () => {
+    const encoded = encodeMetadataV2(
+      'service',
+      'foo',
+      undefined,
+      Buffer.from([3]),
+    );
+
+    expect(decodeRateHints(encoded)).to.equal(null);
+    expect(decodeRateHints(Buffer.alloc(0))).to.equal(null);
+    expect(decodeRateHints(null)).to.equal(null);
+  });
+
+  it('rejects rate hints cut short or overrunning', () => {
+    const encoded = encodeRateHints([
+      {
+        maxInFlight: 4,
+        method: 'foo',
+        queueDepth: 7,
+        retryAfter: 100,
+        service: 'service',
+      },
+    ]);
+
+    for (let length = 1; length < encoded.length; length++) {
+      expect(decodeRateHints(encoded.slice(0, length))).to.equal(null);
+    }
+    expect(
+      decodeRateHints(Buffer.concat([encoded, Buffer.from([0])])),
+    ).to.equal(null);
+    // A count far beyond what the buffer could hold
+    expect(
+      decodeRateHints(Buffer.from([3, 0xff, 0xff, 0xff, 0xff, 0x07, 0, 0])),
+    ).to.equal(null);
+    // A varint that never ends
+    expect(decodeRateHints(Buffer.from([3, 0xff, 0xff, 0xff]))).to.equal(
+      null,
+    );
+  });
+
+  it('reads the id of a service sent by id or by name', () => {
+    const id = serviceId('service');
+
+    const metadata = Buffer.alloc(0);
+
+    expect(
+      getServiceId(encodeMetadataV2('service', 'foo', undefined, metadata, id)),
+    ).to.equal(id);
+    expect(
+      getServiceId(encodeMetadata('service', 'foo', undefined, metadata)),
+    ).to.equal(id);
+  });
 });
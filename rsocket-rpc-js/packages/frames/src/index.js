@@ -18,9 +18,30 @@
 
 export {
   encodeMetadata,
+  encodeMetadataV2,
+  serviceId,
+  internService,
   getVersion,
   getService,
+  getServiceId,
   getMethod,
   getMetadata,
   getTracing,
+  getTracingOffset,
+  getFlags,
+  setFlags,
+  encodeFlags,
+  FLAG_DEFLATE,
+  FLAG_GZIP,
+  encodeRateHints,
+  decodeRateHints,
 } from './Metadata';
+
+export {
+  MAX_VARINT_SIZE,
+  readVarint,
+  varintSize,
+  writeVarint,
+} from './Varint';
+
+export type {RateHint} from './Metadata';
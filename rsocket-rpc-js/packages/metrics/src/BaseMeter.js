@@ -26,6 +26,8 @@ export default class BaseMeter implements IMeter {
   description: ?string;
   statistic: string;
   units: string;
+  sharedCells: ?Int32Array;
+  sharedIndex: number;
 
   constructor(name: string, description?: string, tags?: RawMeterTag[]) {
     this.m1Rate = EWMA.createM1EWMA();
@@ -38,6 +40,8 @@ export default class BaseMeter implements IMeter {
     this.name = name;
     this.description = description;
     this.statistic = 'unknown';
+    this.sharedCells = null;
+    this.sharedIndex = 0;
   }
 
   convert(converter: IMeter => Meter[]): Meter[] {
@@ -65,6 +69,11 @@ export default class BaseMeter implements IMeter {
     this.m5Rate.update(n);
     this.m15Rate.update(n);
 
+    // Meters bound by a SharedMeterRegistry also count into shared memory
+    if (this.sharedCells) {
+      Atomics.add(this.sharedCells, this.sharedIndex, n);
+    }
+
     return n;
   }
 
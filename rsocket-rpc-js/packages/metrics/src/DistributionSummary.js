@@ -0,0 +1,68 @@
+/**
+ * @flow
+ */
+
+'use strict';
+
+import BaseMeter from './BaseMeter';
+import RawMeterTag from './RawMeterTag';
+import {Histogram} from './Histogram';
+import {LogLinearSample} from './stats';
+
+/*
+ *  A distribution summary tracks the rate of events and histograms their
+ *  amounts, e.g. payload sizes in bytes
+ */
+export default class DistributionSummary extends BaseMeter {
+  histogram: Histogram;
+
+  constructor(
+    name: string,
+    description?: string,
+    units: string,
+    tags?: RawMeterTag[],
+  ) {
+    super(name, description, tags);
+    // Amounts are whole units, so they are bucketed as they are
+    this.histogram = new Histogram(new LogLinearSample(1));
+    this.clear();
+    this.type = 'distributionSummary';
+    this.statistic = 'value';
+    this.units = units;
+  }
+
+  update(amount: number): void {
+    this.histogram.update(amount);
+    this.mark();
+  }
+
+  // delegate these to histogram
+  clear(): void {
+    return this.histogram.clear();
+  }
+  totalCount(): ?number {
+    return this.histogram.count;
+  }
+  min(): ?number {
+    return this.histogram.min;
+  }
+  max(): ?number {
+    return this.histogram.max;
+  }
+  mean(): ?number {
+    return this.histogram.mean();
+  }
+  percentiles(percentiles?: number[]): Object {
+    return this.histogram.percentiles(percentiles);
+  }
+
+  toObject() {
+    return {
+      type: this.type,
+      amount: this.histogram.toObject(),
+      count: this.count,
+      tags: this.tags,
+      name: this.name,
+    };
+  }
+}
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import {ISubscription, ISubscriber} from 'rsocket-types';
+import StreamFlow from './StreamFlow';
+
+/*
+ * Reports the demand of a subscriber, and the elements delivered to it, to
+ * the StreamFlow of its stream
+ */
+export default class FlowControlSubscriber<T>
+  implements ISubscription, ISubscriber<T> {
+  _source: ISubscriber<T>;
+  _flow: StreamFlow;
+  _subscription: ISubscription;
+
+  constructor(actual: ISubscriber<T>, flow: StreamFlow) {
+    this._source = actual;
+    this._flow = flow;
+  }
+
+  onSubscribe(s: ISubscription) {
+    this._subscription = s;
+    this._source.onSubscribe(this);
+  }
+
+  onNext(t: T) {
+    this._flow.next(t);
+    this._source.onNext(t);
+  }
+
+  onError(t: Error) {
+    this._flow.close();
+    this._source.onError(t);
+  }
+
+  onComplete() {
+    this._flow.close();
+    this._source.onComplete();
+  }
+
+  request(n: number) {
+    this._flow.request(n);
+    this._subscription && this._subscription.request(n);
+  }
+
+  cancel() {
+    this._flow.close();
+    this._subscription && this._subscription.cancel();
+  }
+}
@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import BaseMeter from './BaseMeter';
+import RawMeterTag from './RawMeterTag';
+
+/*
+ * A value that goes up and down, e.g. the number of active streams. Its count
+ * is the number of times the value changed, so that exporters can tell when
+ * to send it again.
+ */
+export default class Gauge extends BaseMeter {
+  _value: number;
+
+  constructor(
+    name: string,
+    description?: string,
+    units: string,
+    tags?: RawMeterTag[],
+  ) {
+    super(name, description, tags);
+    this._value = 0;
+    this.type = 'gauge';
+    this.statistic = 'value';
+    this.units = units;
+  }
+
+  set(value: number): void {
+    if (value !== this._value) {
+      this._value = value;
+      this.count++;
+    }
+  }
+
+  inc(val?: number): void {
+    this.set(this._value + (val === undefined ? 1 : val));
+  }
+
+  dec(val?: number): void {
+    this.set(this._value - (val === undefined ? 1 : val));
+  }
+
+  value(): number {
+    return this._value;
+  }
+
+  clear(): void {
+    this.set(0);
+  }
+
+  toObject() {
+    return {
+      type: this.type,
+      value: this._value,
+      tags: this.tags,
+      name: this.name,
+    };
+  }
+}
@@ -6,6 +6,7 @@
 
 import {
   ExponentiallyDecayingSample,
+  LogLinearSample,
   UniformSample,
   ISample,
   Sample,
@@ -63,6 +64,12 @@ export class Histogram {
   static createUniformHistogram(size: number): Histogram {
     return new Histogram(new UniformSample(size || 1028));
   }
+  static createLogLinearHistogram(
+    unitsPerValue?: number,
+    window?: number,
+  ): Histogram {
+    return new Histogram(new LogLinearSample(unitsPerValue, window));
+  }
 
   clear = function(): void {
     this.sample.clear();
@@ -108,6 +115,10 @@ export class Histogram {
     if (!percentiles) {
       percentiles = DEFAULT_PERCENTILES;
     }
+    // Bucketed samples answer directly rather than sorting their values
+    if (typeof this.sample.percentiles === 'function') {
+      return this.sample.percentiles(percentiles);
+    }
     var values = this.sample
         .getValues()
         .map(function(v) {
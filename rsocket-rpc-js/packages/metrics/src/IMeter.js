@@ -27,6 +27,7 @@ export interface IMeter {
   statistic: string;
   type: string;
   tags: RawMeterTag[];
+  count: number;
   units?: string;
   rates(): Object;
   convert(converter: (IMeter) => Meter[]): Meter[];
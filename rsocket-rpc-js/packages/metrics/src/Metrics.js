@@ -19,6 +19,13 @@
 'use strict';
 
 import Counter from './Counter';
+import DistributionSummary from './DistributionSummary';
+import FlowControlSubscriber from './FlowControlSubscriber';
+import Gauge from './Gauge';
+import PayloadSizes from './PayloadSizes';
+import PhaseTimers from './PhaseTimers';
+import StreamFlow from './StreamFlow';
+import type {FlowGauges} from './StreamFlow';
 import Timer from './Timer';
 import {IMeterRegistry} from './IMeterRegistry';
 import RawMeterTag from './RawMeterTag';
@@ -26,9 +33,141 @@ import embedMetricsSingleSubscriber from './MetricsSingleSubscriber';
 import MetricsSubscriber from './MetricsSubscriber';
 import {Flowable, Single} from 'rsocket-flowable';
 
+// Minimum number of recorded latencies before a percentile is trusted
+const MIN_PERCENTILE_SAMPLES = 100;
+// Percentiles are recomputed at most this often, in milliseconds
+const PERCENTILE_REFRESH_INTERVAL = 1000;
+
+// Timers created by timed() and timedSingle(), keyed by the returned function
+const TIMERS: WeakMap<Function, Timer> = new WeakMap();
+// Gauges behind the functions returned by flowControlled()
+const FLOWS: WeakMap<Function, FlowGauges> = new WeakMap();
+
+// Meters and metered functions, interned per registry by name and tags so
+// that every client and server of a method shares the same meters
+const INTERNED: WeakMap<IMeterRegistry, Map<string, any>> = new WeakMap();
+
+// Interning keys of the tags precomputed by tags()
+const TAG_KEYS: WeakMap<RawMeterTag[], string> = new WeakMap();
+
+// Returned by payloadSizes() when there is no registry to record into
+const NO_PAYLOAD_SIZES = new PayloadSizes(null, null, null, null);
+const NO_PHASE_TIMERS = new PhaseTimers(null, null, null);
+
+// Observes a WorkerPool of rsocket-rpc-core
+type WorkerPoolGauges = {
+  workers: (count: number) => void,
+  busy: (count: number) => void,
+  queued: (count: number) => void,
+};
+
+type Instruments = {
+  next: Counter,
+  complete: Counter,
+  error: Counter,
+  cancelled: Counter,
+  timer: Timer,
+};
+
+function convertTags(tags: Object[]): RawMeterTag[] {
+  const convertedTags = [];
+  if (tags) {
+    tags.forEach(tag => {
+      Object.keys(tag).forEach(key => {
+        convertedTags.push(new RawMeterTag(key, tag[key]));
+      });
+    });
+  }
+  return convertedTags;
+}
+
+// Accepts either tag objects or a single array precomputed by tags()
+function resolveTags(tags: Object[]): RawMeterTag[] {
+  return tags.length === 1 && Array.isArray(tags[0])
+    ? (tags[0]: any)
+    : convertTags(tags);
+}
+
+function tagsKey(tags: RawMeterTag[]): string {
+  let key = TAG_KEYS.get(tags);
+  if (key === undefined) {
+    key = tags.map(tag => tag.key + '=' + tag.value).join(',');
+  }
+  return key;
+}
+
+function intern<T>(registry: IMeterRegistry, key: string, create: () => T): T {
+  let interned = INTERNED.get(registry);
+  if (!interned) {
+    interned = new Map();
+    INTERNED.set(registry, interned);
+  }
+  let value = interned.get(key);
+  if (value === undefined) {
+    value = create();
+    interned.set(key, value);
+  }
+  return value;
+}
+
+function instruments(
+  registry: IMeterRegistry,
+  name: string,
+  tags: RawMeterTag[],
+  key: string,
+): Instruments {
+  return intern(registry, 'instruments:' + key, () => {
+    const meters = {
+      next: new Counter(
+        name + '.request',
+        'onNext calls',
+        'integer',
+        [new RawMeterTag('status', 'next')].concat(tags),
+      ),
+      complete: new Counter(
+        name + '.request',
+        'onComplete calls',
+        'integer',
+        [new RawMeterTag('status', 'complete')].concat(tags),
+      ),
+      error: new Counter(
+        name + '.request',
+        'onError calls',
+        'integer',
+        [new RawMeterTag('status', 'error')].concat(tags),
+      ),
+      cancelled: new Counter(
+        name + '.request',
+        'cancel calls',
+        'integer',
+        [new RawMeterTag('status', 'cancelled')].concat(tags),
+      ),
+      timer: new Timer(name + '.latency', undefined, tags),
+    };
+    registry.registerMeters([
+      meters.next,
+      meters.complete,
+      meters.error,
+      meters.cancelled,
+      meters.timer,
+    ]);
+    return meters;
+  });
+}
+
 export default class Metrics {
   constructor() {}
 
+  /**
+   * Converts tags once, e.g. when a generated module loads, so that they can
+   * be passed to timed(), timedSingle() and counter() in place of tag objects.
+   */
+  static tags(...tags: Object[]): RawMeterTag[] {
+    const convertedTags = convertTags(tags);
+    TAG_KEYS.set(convertedTags, tagsKey(convertedTags));
+    return convertedTags;
+  }
+
   static timed<T>(
     registry?: IMeterRegistry,
     name: string,
@@ -39,55 +178,33 @@ export default class Metrics {
       return any => any;
     }
 
-    const convertedTags = [];
-    if (tags) {
-      tags.forEach(tag => {
-        Object.keys(tag).forEach(key => {
-          convertedTags.push(new RawMeterTag(key, tag[key]));
-        });
-      });
-    }
+    const convertedTags = resolveTags(tags);
+    const key = name + '|' + tagsKey(convertedTags);
+    const meterRegistry = registry;
 
-    const next = new Counter(
-      name + '.request',
-      'onNext calls',
-      'integer',
-      [new RawMeterTag('status', 'next')].concat(convertedTags),
-    );
-    const complete = new Counter(
-      name + '.request',
-      'onComplete calls',
-      'integer',
-      [new RawMeterTag('status', 'complete')].concat(convertedTags),
-    );
-    const error = new Counter(
-      name + '.request',
-      'onError calls',
-      'integer',
-      [new RawMeterTag('status', 'error')].concat(convertedTags),
-    );
-    const cancelled = new Counter(
-      name + '.request',
-      'cancel calls',
-      'integer',
-      [new RawMeterTag('status', 'cancelled')].concat(convertedTags),
-    );
-    const timer = new Timer(name + '.latency', undefined, convertedTags);
-
-    registry.registerMeters([next, complete, error, cancelled, timer]);
-
-    return (flowable: Flowable<T>) =>
-      flowable.lift(
-        subscriber =>
-          new MetricsSubscriber(
-            subscriber,
-            next,
-            complete,
-            error,
-            cancelled,
-            timer,
-          ),
+    return intern(meterRegistry, 'timed:' + key, () => {
+      const {next, complete, error, cancelled, timer} = instruments(
+        meterRegistry,
+        name,
+        convertedTags,
+        key,
       );
+
+      const metered = (flowable: Flowable<T>) =>
+        flowable.lift(
+          subscriber =>
+            new MetricsSubscriber(
+              subscriber,
+              next,
+              complete,
+              error,
+              cancelled,
+              timer,
+            ),
+        );
+      TIMERS.set(metered, timer);
+      return metered;
+    });
   }
 
   static timedSingle<T>(
@@ -100,51 +217,336 @@ export default class Metrics {
       return any => any;
     }
 
-    const convertedTags = [];
-    if (tags) {
-      tags.forEach(tag => {
-        Object.keys(tag).forEach(key => {
-          convertedTags.push(new RawMeterTag(key, tag[key]));
-        });
-      });
+    const convertedTags = resolveTags(tags);
+    const key = name + '|' + tagsKey(convertedTags);
+    const meterRegistry = registry;
+
+    return intern(meterRegistry, 'timedSingle:' + key, () => {
+      const {next, complete, error, cancelled, timer} = instruments(
+        meterRegistry,
+        name,
+        convertedTags,
+        key,
+      );
+
+      const metered = (single: Single<T>) =>
+        embedMetricsSingleSubscriber(
+          single,
+          next,
+          complete,
+          error,
+          cancelled,
+          timer,
+        );
+      TIMERS.set(metered, timer);
+      return metered;
+    });
+  }
+
+  /**
+   * Times each attempt of a hedged call on its own, as
+   * `<name>.attempt.latency`, for latencyPercentile() to read the latency of
+   * a single request from. Attempts cancelled, e.g. because another one won,
+   * are not recorded, so that hedging does not pull the percentile it hedges
+   * by down.
+   */
+  static timedAttempt<T>(
+    registry?: IMeterRegistry,
+    name: string,
+    ...tags: Object[]
+  ): (Single<T>) => Single<T> {
+    //Registry is optional - if not provided, return identity function
+    if (!registry) {
+      return any => any;
     }
 
-    const next = new Counter(
-      name + '.request',
-      'onNext calls',
-      'integer',
-      [new RawMeterTag('status', 'next')].concat(convertedTags),
+    const convertedTags = resolveTags(tags);
+    const meterRegistry = registry;
+
+    return intern(
+      meterRegistry,
+      'timedAttempt:' + name + '|' + tagsKey(convertedTags),
+      () => {
+        const timer = new Timer(
+          name + '.attempt.latency',
+          undefined,
+          convertedTags,
+        );
+        meterRegistry.registerMeters([timer]);
+
+        const metered = (single: Single<T>) =>
+          new Single(subscriber => {
+            let start = 0;
+            single.subscribe({
+              onComplete: value => {
+                timer.update(Date.now() - start);
+                subscriber.onComplete(value);
+              },
+              onError: error => {
+                timer.update(Date.now() - start);
+                subscriber.onError(error);
+              },
+              onSubscribe: cancel => {
+                start = Date.now();
+                subscriber.onSubscribe(cancel);
+              },
+            });
+          });
+        TIMERS.set(metered, timer);
+        return metered;
+      },
     );
-    const complete = new Counter(
-      name + '.request',
-      'onComplete calls',
-      'integer',
-      [new RawMeterTag('status', 'complete')].concat(convertedTags),
+  }
+
+  static counter(
+    registry?: IMeterRegistry,
+    name: string,
+    description: string,
+    ...tags: Object[]
+  ): ?Counter {
+    //Registry is optional - if not provided, there is nothing to count into
+    if (!registry) {
+      return null;
+    }
+
+    const convertedTags = resolveTags(tags);
+    const meterRegistry = registry;
+    return intern(
+      meterRegistry,
+      'counter:' + name + '|' + tagsKey(convertedTags),
+      () => {
+        const counter = new Counter(
+          name,
+          description,
+          'integer',
+          convertedTags,
+        );
+        meterRegistry.registerMeter(counter);
+        return counter;
+      },
     );
-    const error = new Counter(
-      name + '.request',
-      'onError calls',
-      'integer',
-      [new RawMeterTag('status', 'error')].concat(convertedTags),
+  }
+
+  /**
+   * Returns the recorder of the payload sizes of a method, as distribution
+   * summaries of the bytes of request and response data and metadata.
+   */
+  static payloadSizes(
+    registry?: IMeterRegistry,
+    name: string,
+    ...tags: Object[]
+  ): PayloadSizes {
+    //Registry is optional - if not provided, sizes are not recorded
+    if (!registry) {
+      return NO_PAYLOAD_SIZES;
+    }
+
+    const convertedTags = resolveTags(tags);
+    const meterRegistry = registry;
+    return intern(
+      meterRegistry,
+      'payloadSizes:' + name + '|' + tagsKey(convertedTags),
+      () => {
+        const summary = (direction, part) =>
+          new DistributionSummary(
+            name + '.payload',
+            direction + ' ' + part + ' sizes',
+            'bytes',
+            [
+              new RawMeterTag('direction', direction),
+              new RawMeterTag('part', part),
+            ].concat(convertedTags),
+          );
+        const summaries = [
+          summary('request', 'data'),
+          summary('request', 'metadata'),
+          summary('response', 'data'),
+          summary('response', 'metadata'),
+        ];
+        meterRegistry.registerMeters(summaries);
+        return new PayloadSizes(...summaries);
+      },
     );
-    const cancelled = new Counter(
-      name + '.request',
-      'cancel calls',
-      'integer',
-      [new RawMeterTag('status', 'cancelled')].concat(convertedTags),
+  }
+
+  /**
+   * Returns the timers of the decode, handler and encode phases of a method,
+   * which generated code records when built with phase_timing=true.
+   */
+  static phaseTimers(
+    registry?: IMeterRegistry,
+    name: string,
+    ...tags: Object[]
+  ): PhaseTimers {
+    //Registry is optional - if not provided, phases are not recorded
+    if (!registry) {
+      return NO_PHASE_TIMERS;
+    }
+
+    const convertedTags = resolveTags(tags);
+    const meterRegistry = registry;
+    return intern(
+      meterRegistry,
+      'phaseTimers:' + name + '|' + tagsKey(convertedTags),
+      () => {
+        const timer = phase =>
+          new Timer(
+            name + '.phase',
+            phase + ' time',
+            [new RawMeterTag('phase', phase)].concat(convertedTags),
+          );
+        const timers = [timer('decode'), timer('handler'), timer('encode')];
+        meterRegistry.registerMeters(timers);
+        return new PhaseTimers(...timers);
+      },
     );
-    const timer = new Timer(name + '.latency', undefined, convertedTags);
-
-    registry.registerMeters([next, complete, error, cancelled, timer]);
-
-    return (single: Single<T>) =>
-      embedMetricsSingleSubscriber(
-        single,
-        next,
-        complete,
-        error,
-        cancelled,
-        timer,
-      );
+  }
+
+  /**
+   * Returns a function that tracks the flow control of the streams passed to
+   * it in gauges of active streams, outstanding request(n) credit, streams
+   * waiting with no credit and the total milliseconds they waited. The
+   * direction, `request` or `response`, tells a method's streams apart.
+   */
+  static flowControlled<T>(
+    registry?: IMeterRegistry,
+    name: string,
+    direction: string,
+    ...tags: Object[]
+  ): (Flowable<T>) => Flowable<T> {
+    //Registry is optional - if not provided, return identity function
+    if (!registry) {
+      return any => any;
+    }
+
+    const convertedTags = resolveTags(tags);
+    const meterRegistry = registry;
+    return intern(
+      meterRegistry,
+      'flowControlled:' + name + '|' + direction + '|' + tagsKey(convertedTags),
+      () => {
+        const gauge = (suffix, description, units) =>
+          new Gauge(
+            name + '.stream.' + suffix,
+            description,
+            units,
+            [new RawMeterTag('direction', direction)].concat(convertedTags),
+          );
+        const gauges = {
+          active: gauge('active', 'active streams', 'streams'),
+          credit: gauge('credit', 'outstanding credit', 'elements'),
+          stalled: gauge('stalled', 'streams with no credit', 'streams'),
+          stalledTime: gauge(
+            'stalled.time',
+            'time spent with no credit',
+            'milliseconds',
+          ),
+          buffered: gauge('buffered', 'buffered elements', 'elements'),
+          bufferedBytes: gauge('buffered.bytes', 'buffered bytes', 'bytes'),
+        };
+        meterRegistry.registerMeters([
+          gauges.active,
+          gauges.credit,
+          gauges.stalled,
+          gauges.stalledTime,
+          gauges.buffered,
+          gauges.bufferedBytes,
+        ]);
+
+        const controlled = (flowable: Flowable<T>) =>
+          flowable.lift(
+            subscriber =>
+              new FlowControlSubscriber(subscriber, new StreamFlow(gauges)),
+          );
+        FLOWS.set(controlled, gauges);
+        return controlled;
+      },
+    );
+  }
+
+  /**
+   * Returns a tracker of one more stream reporting into the gauges behind a
+   * function returned from flowControlled(), e.g. for the operators of
+   * rsocket-rpc-core that buffer elements. Returns null when the function is
+   * not backed by a registry.
+   */
+  static streamFlow(controlled: Function): ?StreamFlow {
+    const gauges = FLOWS.get(controlled);
+    return gauges ? new StreamFlow(gauges) : null;
+  }
+
+  /**
+   * Returns gauges of the workers started by a WorkerPool of rsocket-rpc-core,
+   * of those running a call and of the calls waiting for a worker, to pass
+   * to the pool as its observer. Returns null without a registry.
+   */
+  static workerPool(
+    registry?: IMeterRegistry,
+    name: string,
+    ...tags: Object[]
+  ): ?WorkerPoolGauges {
+    if (!registry) {
+      return null;
+    }
+
+    const convertedTags = resolveTags(tags);
+    const meterRegistry = registry;
+    return intern(
+      meterRegistry,
+      'workerPool:' + name + '|' + tagsKey(convertedTags),
+      () => {
+        const gauge = (suffix, description, units) =>
+          new Gauge(
+            name + '.offload.' + suffix,
+            description,
+            units,
+            convertedTags,
+          );
+        const workers = gauge('workers', 'started workers', 'workers');
+        const busy = gauge('busy', 'workers running a call', 'workers');
+        const queued = gauge('queued', 'calls waiting for a worker', 'calls');
+        meterRegistry.registerMeters([workers, busy, queued]);
+        return {
+          workers: count => workers.set(count),
+          busy: count => busy.set(count),
+          queued: count => queued.set(count),
+        };
+      },
+    );
+  }
+
+  /**
+   * Returns a supplier of the given latency percentile, in milliseconds, as
+   * recorded by the timer behind a function returned from timed(),
+   * timedSingle() or timedAttempt(). The supplier returns `fallback` until
+   * enough latencies have been recorded, or when the function is not backed
+   * by a registry.
+   */
+  static latencyPercentile(
+    metered: Function,
+    percentile: number,
+    fallback: number,
+  ): () => number {
+    const timer = TIMERS.get(metered);
+    if (!timer) {
+      return () => fallback;
+    }
+
+    let value = fallback;
+    let refreshed = 0;
+    return () => {
+      const now = Date.now();
+      if (now - refreshed >= PERCENTILE_REFRESH_INTERVAL) {
+        refreshed = now;
+        const count = timer.totalCount();
+        if (count != null && count >= MIN_PERCENTILE_SAMPLES) {
+          const latency = timer.percentiles([percentile])[percentile];
+          if (latency != null) {
+            value = latency;
+          }
+        }
+      }
+      return value;
+    };
   }
 }
@@ -33,28 +33,67 @@ import {
 import {MetricsSnapshotHandlerClient} from './proto/metrics_rsocket_pb';
 import RawMeterTag from './RawMeterTag';
 import Timer from './Timer';
+import DistributionSummary from './DistributionSummary';
+import Gauge from './Gauge';
+import {LogLinearSample} from './stats';
 import {IMeterRegistry} from './IMeterRegistry';
 import type {IMeter} from './IMeter';
 
+// Snapshot size, in meters, when the constructor isn't given a batch size
+const DEFAULT_BATCH_SIZE = 1024;
+// Every meter is exported at least once in this many ticks, even when it saw
+// no events, so that the collector follows decaying rates and recovers from
+// lost snapshots
+const FULL_EXPORT_TICKS = 10;
+
+/*
+ * Protobuf messages of one meter, reused between ticks so that exporting
+ * only updates their measurements
+ */
+type MeterMessages = {
+  tags: MeterTag[],
+  meters: Map<string, Meter>,
+};
+
+/**
+ * Streams snapshots of the meters of a registry to a MetricsSnapshotHandler.
+ * Histograms are exported as fixed percentiles, a total count and a max.
+ * Given `exportBuckets`, those backed by a LogLinearSample also export the
+ * cumulative count of the buckets recorded into, as series tagged by their
+ * upper bound, `le`, so that the collector can merge distributions; as many
+ * as fit in a batch next to the other series, the rest being merged into
+ * their neighbours.
+ */
 export default class MetricsExporter {
   handler: MetricsSnapshotHandlerClient;
   registry: IMeterRegistry;
   exportPeriodSeconds: number;
   batchSize: number;
+  exportBuckets: boolean;
   intervalHandle: any;
   remoteSubscriber: ?ISubscriber<MetricsSnapshot>;
   remoteCancel: () => void;
+  exportedCounts: WeakMap<IMeter, number>;
+  messages: WeakMap<IMeter, MeterMessages>;
+  snapshot: MetricsSnapshot;
+  ticks: number;
 
   constructor(
     handler: MetricsSnapshotHandlerClient,
     registry: IMeterRegistry,
     exportPeriodSeconds: number,
     batchSize: number,
+    exportBuckets?: boolean,
   ) {
     this.handler = handler;
     this.registry = registry;
     this.exportPeriodSeconds = exportPeriodSeconds;
-    this.batchSize = batchSize; // TODO: use this to window the snapshots
+    this.batchSize = batchSize > 0 ? batchSize : DEFAULT_BATCH_SIZE;
+    this.exportBuckets = !!exportBuckets;
+    this.exportedCounts = new WeakMap();
+    this.messages = new WeakMap();
+    this.snapshot = new MetricsSnapshot();
+    this.ticks = 0;
   }
 
   start() {
@@ -116,24 +155,42 @@ function getMetricsSnapshotStream(
     exporter.remoteSubscriber = subscriber;
 
     let pending = 0;
+    let exporting = false;
+
+    // Sends one batch, then yields to the event loop before the next one so
+    // that large registries don't stall it
+    const exportBatch = (meters: IMeter[], full: boolean, index: number) => {
+      if (pending === 0 || exporter.remoteSubscriber !== subscriber) {
+        exporting = false;
+        return;
+      }
+      const batch = [];
+      const next = fillBatch(exporter, meters, full, index, batch);
+      if (batch.length > 0) {
+        // Serialized as soon as it is emitted, so the snapshot can be reused
+        exporter.snapshot.setMetersList(batch);
+        subscriber.onNext(exporter.snapshot);
+        pending--;
+      }
+      if (next < meters.length) {
+        setImmediate(() => exportBatch(meters, full, next));
+      } else {
+        exporting = false;
+      }
+    };
+
+    exporter.ticks = 0;
     console.log(
       'Setting interval for ' +
         exporter.exportPeriodSeconds * 1000 +
         ' milliseconds',
     );
     exporter.intervalHandle = setInterval(() => {
-      if (pending > 0) {
-        const allMeters = Array.prototype.concat.apply(
-          [],
-          exporter.registry.meters().map(convert),
-        );
-        const meterSnapshot = allMeters.reduce((snapshot, meter) => {
-          snapshot.addMeters(meter);
-          return snapshot;
-        }, new MetricsSnapshot());
-
-        subscriber.onNext(meterSnapshot);
-        pending--;
+      if (pending > 0 && !exporting) {
+        exporting = true;
+        const full = exporter.ticks % FULL_EXPORT_TICKS === 0;
+        exporter.ticks++;
+        exportBatch(exporter.registry.meters(), full, 0);
       }
     }, exporter.exportPeriodSeconds * 1000);
 
@@ -150,17 +207,68 @@ function getMetricsSnapshotStream(
   });
 }
 
-function convert(meter: IMeter): Meter[] {
+/**
+ * Converts the meters from `index` on that changed since they were last
+ * exported, or all of them on a full export, into `batch` until it holds
+ * batchSize meters. Returns the index of the first meter left out.
+ */
+function fillBatch(
+  exporter: MetricsExporter,
+  meters: IMeter[],
+  full: boolean,
+  index: number,
+  batch: Meter[],
+): number {
+  let i = index;
+  for (; i < meters.length; i++) {
+    const meter = meters[i];
+    const count = meter.count;
+    if (!full && exporter.exportedCounts.get(meter) === count) {
+      continue;
+    }
+    const converted = convert(exporter, meter);
+    const size = batch.length + converted.length;
+    if (batch.length > 0 && size > exporter.batchSize) {
+      break;
+    }
+    exporter.exportedCounts.set(meter, count);
+    for (let j = 0; j < converted.length; j++) {
+      batch.push(converted[j]);
+    }
+    if (batch.length >= exporter.batchSize) {
+      return i + 1;
+    }
+  }
+  return i;
+}
+
+function convert(exporter: MetricsExporter, meter: IMeter): Meter[] {
+  let messages = exporter.messages.get(meter);
+  if (!messages) {
+    messages = {tags: convertTags(meter.tags), meters: new Map()};
+    exporter.messages.set(meter, messages);
+  }
+  const meterMessages = messages;
   const meterType = meterTypeLookup(meter.type);
+  const buckets = exporter.exportBuckets ? exporter.batchSize : 0;
   switch (meterType) {
     case MeterType.TIMER:
-      return meter.convert(convertTimer);
-    case MeterType.COUNTER:
+      return meter.convert(imeter =>
+        convertTimer(imeter, meterMessages, buckets),
+      );
+    case MeterType.DISTRIBUTION_SUMMARY:
+      return meter.convert(imeter =>
+        convertDistributionSummary(imeter, meterMessages, buckets),
+      );
     case MeterType.GAUGE:
+      if (meter instanceof Gauge) {
+        return meter.convert(imeter => convertGauge(imeter, meterMessages));
+      }
+      return meter.convert(imeter => basicConverter(imeter, meterMessages));
+    case MeterType.COUNTER:
     case MeterType.LONG_TASK_TIMER:
-    case MeterType.DISTRIBUTION_SUMMARY:
     case MeterType.OTHER:
-      return meter.convert(basicConverter);
+      return meter.convert(imeter => basicConverter(imeter, meterMessages));
     default:
       throw new Error('unsupported type ' + meterType);
   }
@@ -208,106 +316,219 @@ function statisticTypeLookup(statistic: string): MeterStatistic {
   }
 }
 
-function convertTimer(imeter: IMeter): Meter[] {
+/**
+ * Returns the message of one series of a meter, creating it on first use
+ */
+function seriesMeter(
+  messages: MeterMessages,
+  key: string,
+  imeter: IMeter,
+  type: MeterType,
+  baseUnit: ?string,
+  tagKey?: string,
+  tagValue?: string,
+): Meter {
+  let meter = messages.meters.get(key);
+  if (!meter) {
+    const meterId = new MeterId();
+    meterId.setName(imeter.name);
+    messages.tags.forEach(t => meterId.addTag(t));
+    if (tagKey !== undefined) {
+      meterId.addTag(meterTag(tagKey, (tagValue: any)));
+    }
+    meterId.setType(type);
+    meterId.setDescription(imeter.description);
+    meterId.setBaseunit(baseUnit);
+
+    meter = new Meter();
+    meter.setId(meterId);
+    messages.meters.set(key, meter);
+  }
+  return meter;
+}
+
+function setMeasure(
+  meter: Meter,
+  index: number,
+  statistic: MeterStatistic,
+  value: ?number,
+): void {
+  let measure = meter.getMeasureList()[index];
+  if (!measure) {
+    measure = new MeterMeasurement();
+    measure.setStatistic(statistic);
+    meter.addMeasure(measure);
+  }
+  measure.setValue(value);
+}
+
+function meterTag(key: string, value: string): MeterTag {
+  const tag = new MeterTag();
+  tag.setKey(key);
+  tag.setValue(value);
+  return tag;
+}
+
+function convertTimer(
+  imeter: IMeter,
+  messages: MeterMessages,
+  maxSeries: number,
+): Meter[] {
   if (!(imeter instanceof Timer)) {
     throw new Error('Meter is not an instance of Timer');
   }
 
-  const timer = (imeter: Timer);
+  return convertHistogram(
+    imeter,
+    messages,
+    MeterType.TIMER,
+    'nanoseconds',
+    toNanoseconds,
+    maxSeries,
+  );
+}
+
+function convertDistributionSummary(
+  imeter: IMeter,
+  messages: MeterMessages,
+  maxSeries: number,
+): Meter[] {
+  if (!(imeter instanceof DistributionSummary)) {
+    throw new Error('Meter is not an instance of DistributionSummary');
+  }
+
+  return convertHistogram(
+    imeter,
+    messages,
+    MeterType.DISTRIBUTION_SUMMARY,
+    imeter.units,
+    amount => amount,
+    maxSeries,
+  );
+}
+
+/**
+ * Converts a histogram into the series of its percentiles and, when
+ * `maxSeries` leaves room for them, of its buckets, so that the histogram
+ * takes at most `maxSeries` of a batch
+ */
+function convertHistogram(
+  histogramMeter: Timer | DistributionSummary,
+  messages: MeterMessages,
+  type: MeterType,
+  baseUnit: string,
+  toBaseUnit: number => number,
+  maxSeries: number,
+): Meter[] {
   const meters = [];
-  const name = timer.name;
-  const tags = convertTags(timer.tags);
+  const statistic = statisticTypeLookup(histogramMeter.statistic);
 
   //Add meters for percentiles of interest
-  const valuesSnapshot = timer.percentiles();
+  const valuesSnapshot = histogramMeter.percentiles();
   Object.keys(valuesSnapshot).forEach(percentile => {
-    const value = toNanoseconds(valuesSnapshot[percentile]);
+    const value = toBaseUnit(valuesSnapshot[percentile]);
     // Make sure we're dealing with a real value before pushing
     if (!isNaN(value)) {
-      const meter = new Meter();
-
-      const percentileTag = new MeterTag();
-      percentileTag.setKey('percentile');
-      percentileTag.setValue(percentile);
-
-      const meterId = new MeterId();
-      meterId.setName(name);
-      tags.forEach(tag => meterId.addTag(tag));
-      meterId.addTag(percentileTag);
-      meterId.setType(MeterType.TIMER);
-      meterId.setDescription(timer.description);
-      meterId.setBaseunit('nanoseconds');
-
-      meter.setId(meterId);
-
-      const measure = new MeterMeasurement();
-      measure.setValue(value);
-      measure.setStatistic(statisticTypeLookup(timer.statistic));
-
-      meter.addMeasure(measure);
-
+      const meter = seriesMeter(
+        messages,
+        'percentile:' + percentile,
+        histogramMeter,
+        type,
+        baseUnit,
+        'percentile',
+        percentile,
+      );
+      setMeasure(meter, 0, statistic, value);
       meters.push(meter);
     }
   });
 
-  //add a meter for total count and max time
-  const histMeter = new Meter();
-
-  const meterId = new MeterId();
-  meterId.setName(name);
-  tags.forEach(tag => meterId.addTag(tag));
-  meterId.setType(MeterType.TIMER);
-  meterId.setDescription(timer.description);
-  meterId.setBaseunit('nanoseconds');
-
-  const totalCount = new MeterMeasurement();
-  totalCount.setValue(timer.totalCount());
-  totalCount.setStatistic(MeterStatistic.COUNT);
-  histMeter.addMeasure(totalCount);
-
-  const maxTime = new MeterMeasurement();
-  maxTime.setValue(timer.max());
-  maxTime.setStatistic(MeterStatistic.MAX);
-  histMeter.addMeasure(maxTime);
-
-  histMeter.setId(meterId);
+  //Add meters for the cumulative count of the buckets recorded into, keyed
+  //by their upper bound, next to the percentiles and the total
+  const sample = histogramMeter.histogram.sample;
+  const maxBuckets = maxSeries - meters.length - 1;
+  if (sample instanceof LogLinearSample && maxBuckets > 0) {
+    const counts = sample.counts();
+    const recorded = [];
+    for (let i = 0; i < counts.length; i++) {
+      if (counts[i] > 0) {
+        recorded.push(i);
+      }
+    }
+    // Cumulative counts stay right when buckets are left out, which merges
+    // them into the next one exported; the last one always is
+    const exported = Math.min(recorded.length, maxBuckets);
+    let cumulative = 0;
+    let next = 0;
+    for (let k = 1; k <= exported; k++) {
+      const last = Math.ceil((k * recorded.length) / exported) - 1;
+      for (; next <= last; next++) {
+        cumulative += counts[recorded[next]];
+      }
+      const i = recorded[last];
+      const meter = seriesMeter(
+        messages,
+        'le:' + i,
+        histogramMeter,
+        type,
+        baseUnit,
+        'le',
+        String(toBaseUnit(sample.bucketUpperBound(i))),
+      );
+      setMeasure(meter, 0, MeterStatistic.COUNT, cumulative);
+      meters.push(meter);
+    }
+  }
 
+  //add a meter for total count and max
+  const histMeter = seriesMeter(
+    messages,
+    'total',
+    histogramMeter,
+    type,
+    baseUnit,
+  );
+  setMeasure(histMeter, 0, MeterStatistic.COUNT, histogramMeter.totalCount());
+  setMeasure(histMeter, 1, MeterStatistic.MAX, histogramMeter.max());
   meters.push(histMeter);
 
   return meters;
 }
 
-function basicConverter(imeter: IMeter): Meter[] {
+function convertGauge(imeter: IMeter, messages: MeterMessages): Meter[] {
+  if (!(imeter instanceof Gauge)) {
+    throw new Error('Meter is not an instance of Gauge');
+  }
+
+  const meter = seriesMeter(
+    messages,
+    'value',
+    imeter,
+    MeterType.GAUGE,
+    imeter.units,
+  );
+  setMeasure(meter, 0, MeterStatistic.VALUE, imeter.value());
+  return [meter];
+}
+
+function basicConverter(imeter: IMeter, messages: MeterMessages): Meter[] {
   const meters = [];
-  const name = imeter.name;
-  const tags = convertTags(imeter.tags);
+  const type = meterTypeLookup(imeter.type);
+  const statistic = statisticTypeLookup(imeter.statistic);
 
   //Add meters for different windowed EWMAs
   const valuesSnapshot = imeter.rates();
   Object.keys(valuesSnapshot).forEach(rate => {
-    const meter = new Meter();
-
-    const value = valuesSnapshot[rate];
-    const ewmaTag = new MeterTag();
-    ewmaTag.setKey('moving-average-minutes');
-    ewmaTag.setValue(rate);
-
-    const meterId = new MeterId();
-    meterId.setName(name);
-    tags.forEach(tag => meterId.addTag(tag));
-    meterId.addTag(ewmaTag);
-    meterId.setType(meterTypeLookup(imeter.type));
-    meterId.setDescription(imeter.description);
-    meterId.setBaseunit(imeter.units);
-
-    meter.setId(meterId);
-
-    const measure = new MeterMeasurement();
-    measure.setValue(value);
-    measure.setStatistic(statisticTypeLookup(imeter.statistic));
-
-    meter.addMeasure(measure);
-
+    const meter = seriesMeter(
+      messages,
+      'rate:' + rate,
+      imeter,
+      type,
+      imeter.units,
+      'moving-average-minutes',
+      rate,
+    );
+    setMeasure(meter, 0, statistic, valuesSnapshot[rate]);
     meters.push(meter);
   });
 
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import DistributionSummary from './DistributionSummary';
+
+type Sized = ?{length: number};
+
+/*
+ * Records the sizes, in bytes, of the data and metadata of a method's
+ * requests and responses. Created by Metrics.payloadSizes(); without a
+ * registry every method is a no-op.
+ */
+export default class PayloadSizes {
+  requestData: ?DistributionSummary;
+  requestMetadata: ?DistributionSummary;
+  responseData: ?DistributionSummary;
+  responseMetadata: ?DistributionSummary;
+
+  constructor(
+    requestData: ?DistributionSummary,
+    requestMetadata: ?DistributionSummary,
+    responseData: ?DistributionSummary,
+    responseMetadata: ?DistributionSummary,
+  ) {
+    this.requestData = requestData;
+    this.requestMetadata = requestMetadata;
+    this.responseData = responseData;
+    this.responseMetadata = responseMetadata;
+  }
+
+  request(data: Sized, metadata: Sized): void {
+    record(this.requestData, data);
+    record(this.requestMetadata, metadata);
+  }
+
+  response(data: Sized, metadata?: Sized): void {
+    record(this.responseData, data);
+    record(this.responseMetadata, metadata);
+  }
+}
+
+function record(summary: ?DistributionSummary, buffer: Sized): void {
+  if (summary) {
+    summary.update(buffer ? buffer.length : 0);
+  }
+}
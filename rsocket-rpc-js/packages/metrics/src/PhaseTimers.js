@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import Timer from './Timer';
+
+// A process.hrtime.bigint() reading, in nanoseconds. Flow has no bigint type.
+export type Instant = any;
+
+const NANOS_PER_MILLI = 1e6;
+
+/*
+ * Times the phases of a call separately from its overall latency: decoding
+ * messages, the handler's time to its first result, and encoding messages.
+ * On a client the handler phase is the time from sending a request to its
+ * first response. Created by Metrics.phaseTimers(); without a registry
+ * nothing is recorded.
+ */
+export default class PhaseTimers {
+  decode: ?Timer;
+  handler: ?Timer;
+  encode: ?Timer;
+
+  constructor(decode: ?Timer, handler: ?Timer, encode: ?Timer) {
+    this.decode = decode;
+    this.handler = handler;
+    this.encode = encode;
+  }
+
+  now(): Instant {
+    return (process.hrtime: any).bigint();
+  }
+
+  /**
+   * Records a decode that began at `start`, and returns the current time
+   */
+  decoded(start: Instant): Instant {
+    return record(this.decode, start);
+  }
+
+  /**
+   * Records an encode that began at `start`, and returns the current time
+   */
+  encoded(start: Instant): Instant {
+    return record(this.encode, start);
+  }
+
+  /**
+   * Records the handler phase on the first result only: returns null, which
+   * callers store in place of `start` so that later results are ignored.
+   */
+  handled(start: ?Instant): null {
+    if (start != null) {
+      record(this.handler, start);
+    }
+    return null;
+  }
+}
+
+function record(timer: ?Timer, start: Instant): Instant {
+  const now = (process.hrtime: any).bigint();
+  if (timer) {
+    timer.update(Number(now - start) / NANOS_PER_MILLI);
+  }
+  return now;
+}
@@ -0,0 +1,410 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+/* eslint-disable no-bitwise */
+
+import type {IMeter} from './IMeter';
+import {IMeterRegistry} from './IMeterRegistry';
+import Counter from './Counter';
+import DistributionSummary from './DistributionSummary';
+import RawMeterTag from './RawMeterTag';
+import Timer from './Timer';
+import {LogLinearSample} from './stats';
+import {BUCKET_COUNT} from './stats/LogLinearSample';
+
+// Header cells, sizes are in cells and bytes
+const MAGIC = 0x4d455452;
+const HEADER_MAGIC = 0;
+const HEADER_ENTRIES = 1;
+const HEADER_CELLS = 2;
+const HEADER_BYTES = 3;
+const HEADER_CELL_TOP = 4;
+const HEADER_BYTE_TOP = 5;
+const HEADER_SIZE = 8;
+
+// Directory entry cells. An entry is claimed by setting its hash, and is
+// ready once its key and data have been written.
+const ENTRY_HASH = 0;
+const ENTRY_STATE = 1;
+const ENTRY_KIND = 2;
+const ENTRY_DATA = 3;
+const ENTRY_KEY_OFFSET = 4;
+const ENTRY_KEY_LENGTH = 5;
+const ENTRY_SIZE = 6;
+
+const STATE_CLAIMED = 0;
+const STATE_READY = 1;
+
+const KIND_COUNTER = 1;
+const KIND_TIMER = 2;
+const KIND_DISTRIBUTION_SUMMARY = 3;
+
+// Timer and distribution summary cells: the count, the max in scaled units,
+// then the bucket counts
+const TIMER_COUNT = 0;
+const TIMER_MAX = 1;
+const TIMER_BUCKETS = 2;
+const TIMER_SIZE = TIMER_BUCKETS + BUCKET_COUNT;
+
+const DEFAULT_ENTRIES = 4096;
+const DEFAULT_CELLS = 1 << 18;
+const DEFAULT_BYTES = 1 << 18;
+
+export type SharedMeterRegistryOptions = {
+  entries?: number,
+  cells?: number,
+  bytes?: number,
+};
+
+/*
+ * A registry whose counters and timer buckets live in a SharedArrayBuffer,
+ * updated with Atomics, so that the worker threads of a process count into
+ * the same meters. Create it in one thread, hand its buffer to the others,
+ * e.g. through workerData, and wrap the buffer there:
+ *
+ *   const registry = new SharedMeterRegistry(workerData.metrics);
+ *
+ * Meters registered with any of these registries are matched by type, name,
+ * description and tags. meters() reports the process-wide values, so a
+ * single MetricsExporter, in any thread, exports for all of them. Meters
+ * other than counters, timers and distribution summaries, or that don't fit
+ * in the buffer, are only kept locally.
+ */
+export default class SharedMeterRegistry implements IMeterRegistry {
+  buffer: SharedArrayBuffer;
+  cells: Int32Array;
+  bytes: Uint8Array;
+  entries: number;
+  entryBase: number;
+  dataBase: number;
+  dataSize: number;
+  views: Map<number, SharedMeterView>;
+  local: IMeter[];
+
+  constructor(
+    buffer?: SharedArrayBuffer,
+    options?: SharedMeterRegistryOptions,
+  ) {
+    let entries, cells, bytes;
+    if (buffer) {
+      const header = new Int32Array(buffer, 0, HEADER_SIZE);
+      if (header[HEADER_MAGIC] !== MAGIC) {
+        throw new Error('Not the buffer of a SharedMeterRegistry');
+      }
+      entries = header[HEADER_ENTRIES];
+      cells = header[HEADER_CELLS];
+      bytes = header[HEADER_BYTES];
+    } else {
+      entries = (options && options.entries) || DEFAULT_ENTRIES;
+      cells = (options && options.cells) || DEFAULT_CELLS;
+      bytes = (options && options.bytes) || DEFAULT_BYTES;
+    }
+
+    const cellCount = HEADER_SIZE + entries * ENTRY_SIZE + cells;
+    if (!buffer) {
+      buffer = new SharedArrayBuffer(cellCount * 4 + bytes);
+      const header = new Int32Array(buffer, 0, HEADER_SIZE);
+      header[HEADER_ENTRIES] = entries;
+      header[HEADER_CELLS] = cells;
+      header[HEADER_BYTES] = bytes;
+      header[HEADER_MAGIC] = MAGIC;
+    }
+
+    this.buffer = buffer;
+    this.cells = new Int32Array(buffer, 0, cellCount);
+    this.bytes = new Uint8Array(buffer, cellCount * 4, bytes);
+    this.entries = entries;
+    this.entryBase = HEADER_SIZE;
+    this.dataBase = HEADER_SIZE + entries * ENTRY_SIZE;
+    this.dataSize = cells;
+    this.views = new Map();
+    this.local = [];
+  }
+
+  registerMeter(meter: IMeter): void {
+    let data = -1;
+    if (meter instanceof Timer || meter instanceof DistributionSummary) {
+      const kind =
+        meter instanceof Timer ? KIND_TIMER : KIND_DISTRIBUTION_SUMMARY;
+      data = this._entry(kind, TIMER_SIZE, keyOf(meter));
+      if (data >= 0) {
+        const sample: LogLinearSample = (meter.histogram.sample: any);
+        meter.sharedCells = this.cells;
+        meter.sharedIndex = data + TIMER_COUNT;
+        meter.histogram.sample = new SharedLogLinearSample(
+          this.cells,
+          data,
+          sample.unitsPerValue,
+        );
+      }
+    } else if (meter instanceof Counter) {
+      data = this._entry(KIND_COUNTER, 1, keyOf(meter));
+      if (data >= 0) {
+        meter.sharedCells = this.cells;
+        meter.sharedIndex = data;
+      }
+    }
+    if (data < 0 && this.local.indexOf(meter) === -1) {
+      this.local.push(meter);
+    }
+  }
+
+  registerMeters(meters: IMeter[]): void {
+    (meters || []).forEach(meter => this.registerMeter(meter));
+  }
+
+  /**
+   * Returns the process-wide meters, brought up to date with what every
+   * thread recorded since the last call.
+   */
+  meters(): IMeter[] {
+    const meters = [];
+    const now = Date.now();
+    for (let slot = 0; slot < this.entries; slot++) {
+      const entry = this.entryBase + slot * ENTRY_SIZE;
+      if (Atomics.load(this.cells, entry + ENTRY_STATE) !== STATE_READY) {
+        continue;
+      }
+      let view = this.views.get(slot);
+      if (!view) {
+        const data = this.cells[entry + ENTRY_DATA];
+        if (data < 0) {
+          continue;
+        }
+        view = new SharedMeterView(
+          this.cells[entry + ENTRY_KIND],
+          data,
+          this._key(entry),
+        );
+        this.views.set(slot, view);
+      }
+      view.sync(this.cells, now);
+      meters.push(view.meter);
+    }
+    return meters.concat(this.local);
+  }
+
+  /**
+   * Finds or claims the entry of a meter and returns the index of its data
+   * cells, or -1 when it can't be shared.
+   */
+  _entry(kind: number, size: number, key: string): number {
+    const cells = this.cells;
+    const hash = hashKey(key);
+    const keyBytes = Buffer.from(key, 'utf8');
+    for (let probe = 0; probe < this.entries; probe++) {
+      const slot = ((hash >>> 0) + probe) % this.entries;
+      const entry = this.entryBase + slot * ENTRY_SIZE;
+      const existing = Atomics.compareExchange(
+        cells,
+        entry + ENTRY_HASH,
+        0,
+        hash,
+      );
+      if (existing === 0) {
+        const data = this._allocate(entry, kind, size, keyBytes);
+        Atomics.store(cells, entry + ENTRY_STATE, STATE_READY);
+        Atomics.notify(cells, entry + ENTRY_STATE);
+        return data;
+      }
+      if (existing === hash) {
+        // Another thread may still be writing the entry it just claimed
+        while (Atomics.load(cells, entry + ENTRY_STATE) === STATE_CLAIMED) {
+          Atomics.wait(cells, entry + ENTRY_STATE, STATE_CLAIMED, 1);
+        }
+        if (this._keyEquals(entry, keyBytes)) {
+          return cells[entry + ENTRY_KIND] === kind
+            ? cells[entry + ENTRY_DATA]
+            : -1;
+        }
+      }
+    }
+    return -1;
+  }
+
+  _allocate(
+    entry: number,
+    kind: number,
+    size: number,
+    keyBytes: Buffer,
+  ): number {
+    const cells = this.cells;
+    const keyOffset = Atomics.add(cells, HEADER_BYTE_TOP, keyBytes.length);
+    const cellOffset = Atomics.add(cells, HEADER_CELL_TOP, size);
+
+    let data = -1;
+    if (keyOffset + keyBytes.length <= this.bytes.length) {
+      this.bytes.set(keyBytes, keyOffset);
+      cells[entry + ENTRY_KEY_OFFSET] = keyOffset;
+      cells[entry + ENTRY_KEY_LENGTH] = keyBytes.length;
+      if (cellOffset + size <= this.dataSize) {
+        data = this.dataBase + cellOffset;
+      }
+    } else {
+      // Without its key nobody can match the entry, so it stays unused
+      cells[entry + ENTRY_KEY_LENGTH] = -1;
+    }
+    cells[entry + ENTRY_KIND] = kind;
+    cells[entry + ENTRY_DATA] = data;
+    return data;
+  }
+
+  _keyEquals(entry: number, keyBytes: Buffer): boolean {
+    const length = this.cells[entry + ENTRY_KEY_LENGTH];
+    if (length !== keyBytes.length) {
+      return false;
+    }
+    const offset = this.cells[entry + ENTRY_KEY_OFFSET];
+    for (let i = 0; i < length; i++) {
+      if (this.bytes[offset + i] !== keyBytes[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  _key(entry: number): string {
+    const offset = this.cells[entry + ENTRY_KEY_OFFSET];
+    const length = this.cells[entry + ENTRY_KEY_LENGTH];
+    return Buffer.from(
+      this.bytes.buffer,
+      this.bytes.byteOffset + offset,
+      length,
+    ).toString('utf8');
+  }
+}
+
+function keyOf(meter: IMeter): string {
+  return JSON.stringify([
+    meter.type,
+    meter.name,
+    meter.description,
+    meter.units,
+    (meter.tags || []).map(tag => [tag.key, tag.value]),
+  ]);
+}
+
+// 32-bit FNV-1a of the key's UTF-16 code units, never 0 which marks a free
+// entry
+function hashKey(key: string): number {
+  let hash = 0x811c9dc5;
+  for (let i = 0; i < key.length; i++) {
+    hash ^= key.charCodeAt(i);
+    hash = Math.imul(hash, 0x01000193);
+  }
+  return hash === 0 ? 1 : hash;
+}
+
+/*
+ * A sample that also counts into the shared buckets
+ */
+class SharedLogLinearSample extends LogLinearSample {
+  cells: Int32Array;
+  data: number;
+
+  constructor(cells: Int32Array, data: number, unitsPerValue: number) {
+    super(unitsPerValue);
+    this.cells = cells;
+    this.data = data;
+  }
+
+  update(val: number, timestamp?: number): void {
+    const index = this.indexOf(val);
+    this.add(index, 1, timestamp);
+    Atomics.add(this.cells, this.data + TIMER_BUCKETS + index, 1);
+
+    const scaled = Math.min(Math.round(val * this.unitsPerValue), 0x7fffffff);
+    let max = Atomics.load(this.cells, this.data + TIMER_MAX);
+    while (scaled > max) {
+      const previous = Atomics.compareExchange(
+        this.cells,
+        this.data + TIMER_MAX,
+        max,
+        scaled,
+      );
+      if (previous === max) {
+        break;
+      }
+      max = previous;
+    }
+  }
+}
+
+/*
+ * A process-wide meter, fed with what was counted into the shared cells
+ * since it was last synced
+ */
+class SharedMeterView {
+  kind: number;
+  data: number;
+  meter: Counter | Timer | DistributionSummary;
+  lastCount: number;
+  lastBuckets: ?Int32Array;
+
+  constructor(kind: number, data: number, key: string) {
+    const [, name, description, units, tags] = JSON.parse(key);
+    const rawTags = tags.map(([k, v]) => new RawMeterTag(k, v));
+    this.kind = kind;
+    this.data = data;
+    this.lastCount = 0;
+    if (kind === KIND_TIMER) {
+      this.meter = new Timer(name, description, rawTags);
+      this.lastBuckets = new Int32Array(BUCKET_COUNT);
+    } else if (kind === KIND_DISTRIBUTION_SUMMARY) {
+      this.meter = new DistributionSummary(name, description, units, rawTags);
+      this.lastBuckets = new Int32Array(BUCKET_COUNT);
+    } else {
+      this.meter = new Counter(name, description, units, rawTags);
+      this.lastBuckets = null;
+    }
+  }
+
+  sync(cells: Int32Array, now: number): void {
+    const count = Atomics.load(cells, this.data);
+    const delta = (count - this.lastCount) | 0;
+    this.lastCount = count;
+    if (delta !== 0) {
+      this.meter.mark(delta);
+    }
+
+    const lastBuckets = this.lastBuckets;
+    const meter = this.meter;
+    if (
+      lastBuckets &&
+      (meter instanceof Timer || meter instanceof DistributionSummary)
+    ) {
+      const histogram = meter.histogram;
+      const sample: LogLinearSample = (histogram.sample: any);
+      for (let i = 0; i < BUCKET_COUNT; i++) {
+        const bucket = Atomics.load(cells, this.data + TIMER_BUCKETS + i);
+        const added = (bucket - lastBuckets[i]) | 0;
+        if (added !== 0) {
+          lastBuckets[i] = bucket;
+          sample.add(i, added, now);
+          histogram.count += added;
+        }
+      }
+      const max = Atomics.load(cells, this.data + TIMER_MAX);
+      if (max > 0) {
+        histogram.max = max / sample.unitsPerValue;
+      }
+    }
+  }
+}
@@ -29,17 +29,20 @@ export default class SimpleMeterRegistry implements IMeterRegistry {
   }
 
   registerMeter(meter: IMeter): void {
-    const id = {
-      name: meter.name,
-      tags: meter.tags,
-      type: meter.type,
-    };
+    const id =
+      meter.type +
+      ':' +
+      meter.name +
+      (meter.tags || []).map(tag => ',' + tag.key + '=' + tag.value).join('');
 
     if (!this.meterMap[id]) {
       this.meterMap[id] = [];
     }
 
-    this.meterMap[id].push(meter);
+    // Registering the same meter again, e.g. from another client, is a no-op
+    if (this.meterMap[id].indexOf(meter) === -1) {
+      this.meterMap[id].push(meter);
+    }
   }
 
   registerMeters(meters: IMeter[]): void {
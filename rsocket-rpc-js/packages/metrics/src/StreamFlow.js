@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2017-present, Netifi Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * @flow
+ */
+
+'use strict';
+
+import Gauge from './Gauge';
+
+const MAX_REQUEST_N = 0x7fffffff; // uint31
+
+/*
+ * The flow control gauges of one method and direction, summed over its
+ * streams; each stream reports into them through a StreamFlow.
+ */
+export type FlowGauges = {
+  active: Gauge,
+  credit: Gauge,
+  stalled: Gauge,
+  stalledTime: Gauge,
+  buffered: Gauge,
+  bufferedBytes: Gauge,
+};
+
+/*
+ * Tracks the demand and buffers of a single stream: the credit granted by
+ * request(n) and not yet used up by elements, how long the stream waited
+ * with no credit, and the elements an operator holds on to until there is
+ * demand for them. Unbounded streams, those that requested 2^31-1 elements
+ * or more, have no credit to track and never stall.
+ */
+export default class StreamFlow {
+  _gauges: FlowGauges;
+  _credit: number;
+  _unbounded: boolean;
+  _stalledSince: ?number;
+  _buffered: number;
+  _bufferedBytes: number;
+  _closed: boolean;
+
+  constructor(gauges: FlowGauges) {
+    this._gauges = gauges;
+    this._credit = 0;
+    this._unbounded = false;
+    this._stalledSince = null;
+    this._buffered = 0;
+    this._bufferedBytes = 0;
+    this._closed = false;
+    gauges.active.inc();
+    // No credit is granted until the first request(n)
+    this._stall();
+  }
+
+  request(n: number): void {
+    if (this._closed || this._unbounded) {
+      return;
+    }
+    if (n >= MAX_REQUEST_N - this._credit) {
+      this._gauges.credit.dec(this._credit);
+      this._credit = 0;
+      this._unbounded = true;
+    } else {
+      this._gauges.credit.inc(n);
+      this._credit += n;
+    }
+    this._unstall();
+  }
+
+  next(value: mixed): void {
+    if (this._closed || this._unbounded || this._credit === 0) {
+      return;
+    }
+    this._gauges.credit.dec();
+    if (--this._credit === 0) {
+      this._stall();
+    }
+  }
+
+  buffer(value: mixed): void {
+    if (this._closed) {
+      return;
+    }
+    const bytes = sizeOf(value);
+    this._buffered++;
+    this._bufferedBytes += bytes;
+    this._gauges.buffered.inc();
+    this._gauges.bufferedBytes.inc(bytes);
+  }
+
+  unbuffer(value: mixed): void {
+    if (this._closed || this._buffered === 0) {
+      return;
+    }
+    const bytes = Math.min(sizeOf(value), this._bufferedBytes);
+    this._buffered--;
+    this._bufferedBytes -= bytes;
+    this._gauges.buffered.dec();
+    this._gauges.bufferedBytes.dec(bytes);
+  }
+
+  close(): void {
+    if (this._closed) {
+      return;
+    }
+    this._closed = true;
+    this._unstall();
+    const gauges = this._gauges;
+    gauges.credit.dec(this._credit);
+    gauges.buffered.dec(this._buffered);
+    gauges.bufferedBytes.dec(this._bufferedBytes);
+    gauges.active.dec();
+  }
+
+  _stall(): void {
+    this._stalledSince = Date.now();
+    this._gauges.stalled.inc();
+  }
+
+  _unstall(): void {
+    const since = this._stalledSince;
+    if (since != null) {
+      this._stalledSince = null;
+      this._gauges.stalled.dec();
+      this._gauges.stalledTime.inc(Date.now() - since);
+    }
+  }
+}
+
+// Bytes of a payload or buffer, or zero for anything else, e.g. messages
+function sizeOf(value: any): number {
+  if (value == null) {
+    return 0;
+  }
+  if (typeof value.length === 'number') {
+    return value.length;
+  }
+  return sizeOf(value.data) + sizeOf(value.metadata);
+}
@@ -7,7 +7,7 @@
 import BaseMeter from './BaseMeter';
 import RawMeterTag from './RawMeterTag';
 import {Histogram} from './Histogram';
-import {ExponentiallyDecayingSample} from './stats';
+import {LogLinearSample} from './stats';
 
 /*
  *  Basically a timer tracks the rate of events and histograms the durations
@@ -17,9 +17,7 @@ export default class Timer extends BaseMeter {
 
   constructor(name: string, description?: string, tags?: RawMeterTag[]) {
     super(name, description, tags);
-    this.histogram = new Histogram(
-      new ExponentiallyDecayingSample(1028, 0.015),
-    );
+    this.histogram = new Histogram(new LogLinearSample());
     this.clear();
     this.type = 'timer';
     this.statistic = 'duration';
@@ -0,0 +1,52 @@
+var expect = require('chai').expect,
+  describe = require('mocha').describe,
+  it = require('mocha').it,
+  LogLinearSample = require('../stats/LogLinearSample').default;
+
+describe('LogLinearSample', function() {
+  it('should report percentiles within the bucket resolution.', function() {
+    var sample = new LogLinearSample();
+
+    for (var i = 1; i <= 10000; i++) {
+      sample.update(i / 10, 0);
+    }
+
+    var scores = sample.percentiles([0.5, 0.99, 0.999]);
+    expect(sample.size()).to.equal(10000);
+    expect(Math.abs(scores[0.5] - 500) / 500).to.be.below(0.02);
+    expect(Math.abs(scores[0.99] - 990) / 990).to.be.below(0.02);
+    expect(Math.abs(scores[0.999] - 999) / 999).to.be.below(0.02);
+  });
+
+  it('should only report percentiles of recent windows.', function() {
+    var sample = new LogLinearSample(1000, 100);
+    sample.windowStart = 0;
+
+    sample.update(1, 0);
+    sample.update(1000, 150);
+    expect(sample.percentiles([0.01])[0.01]).to.be.below(2);
+
+    sample.update(1000, 250);
+    expect(sample.percentiles([0.01])[0.01]).to.be.above(900);
+    expect(sample.size()).to.equal(3);
+  });
+
+  it('should merge bucket counts.', function() {
+    var a = new LogLinearSample();
+    var b = new LogLinearSample();
+    a.update(5, 0);
+    b.update(5, 0);
+    b.update(50, 0);
+
+    a.merge(b);
+
+    var counts = a.counts();
+    var total = 0;
+    for (var i = 0; i < counts.length; i++) {
+      total += counts[i];
+    }
+    expect(total).to.equal(3);
+    expect(a.size()).to.equal(3);
+    expect(a.getValues().length).to.equal(3);
+  });
+});
@@ -0,0 +1,102 @@
+var expect = require('chai').expect,
+  describe = require('mocha').describe,
+  it = require('mocha').it,
+  Single = require('rsocket-flowable').Single,
+  Metrics = require('../Metrics').default,
+  SimpleMeterRegistry = require('../SimpleMeterRegistry').default;
+
+describe('Metrics', function() {
+  it('should share meters between instances of the same method.', function() {
+    var registry = new SimpleMeterRegistry();
+    var tags = Metrics.tags({service: 'foo.Bar'}, {method: 'baz'});
+
+    var first = Metrics.timedSingle(registry, 'Bar', tags);
+    var second = Metrics.timedSingle(
+      registry,
+      'Bar',
+      {service: 'foo.Bar'},
+      {method: 'baz'},
+    );
+    var streaming = Metrics.timed(registry, 'Bar', tags);
+
+    expect(second).to.equal(first);
+    expect(registry.meters().length).to.equal(5);
+    expect(Metrics.latencyPercentile(streaming, 0.5, -1)()).to.equal(-1);
+
+    var other = new SimpleMeterRegistry();
+    expect(Metrics.timedSingle(other, 'Bar', tags)).to.not.equal(first);
+    expect(registry.meters().length).to.equal(5);
+  });
+
+  it('should time completed attempts only.', function() {
+    var registry = new SimpleMeterRegistry();
+    var attempt = Metrics.timedAttempt(registry, 'Bar', {method: 'baz'});
+    var timer = registry.meters()[0];
+
+    var pending = new Single(subscriber => subscriber.onSubscribe(() => {}));
+    attempt(pending).subscribe({onSubscribe: cancel => cancel()});
+    expect(timer.totalCount()).to.equal(0);
+
+    attempt(Single.of(1)).subscribe({});
+    expect(timer.totalCount()).to.equal(1);
+    expect(registry.meters().length).to.equal(1);
+  });
+
+  it('should share counters with the same name and tags.', function() {
+    var registry = new SimpleMeterRegistry();
+    var tags = Metrics.tags({result: 'hit'});
+
+    var counter = Metrics.counter(registry, 'Bar.cache', 'cache hits', tags);
+    counter.inc();
+
+    expect(
+      Metrics.counter(registry, 'Bar.cache', 'cache hits', {result: 'hit'}),
+    ).to.equal(counter);
+    expect(
+      Metrics.counter(registry, 'Bar.cache', 'cache hits', {result: 'miss'}),
+    ).to.not.equal(counter);
+    expect(registry.meters().length).to.equal(2);
+  });
+
+  it('should record payload sizes per part and direction.', function() {
+    var registry = new SimpleMeterRegistry();
+    var sizes = Metrics.payloadSizes(registry, 'Bar', {method: 'baz'});
+
+    sizes.request(Buffer.alloc(100), Buffer.alloc(10));
+    sizes.response(Buffer.alloc(1000));
+
+    expect(Metrics.payloadSizes(registry, 'Bar', {method: 'baz'})).to.equal(
+      sizes,
+    );
+    expect(
+      registry.meters().map(function(meter) {
+        var tags = meter.tags.map(tag => tag.value);
+        return tags[0] + ' ' + tags[1] + ' ' + meter.max();
+      }),
+    ).to.deep.equal([
+      'request data 100',
+      'request metadata 10',
+      'response data 1000',
+      'response metadata 0',
+    ]);
+
+    Metrics.payloadSizes(undefined, 'Bar').request(Buffer.alloc(1), null);
+  });
+
+  it('should time the first result of the handler phase only.', function() {
+    var registry = new SimpleMeterRegistry();
+    var phases = Metrics.phaseTimers(registry, 'Bar', {method: 'baz'});
+
+    var handlerStart = phases.decoded(phases.now());
+    handlerStart = phases.handled(handlerStart);
+    handlerStart = phases.handled(handlerStart);
+    phases.encoded(phases.now());
+
+    expect(handlerStart).to.equal(null);
+    expect(
+      registry.meters().map(function(meter) {
+        return meter.tags[0].value + ' ' + meter.totalCount();
+      }),
+    ).to.deep.equal(['decode 1', 'handler 1', 'encode 1']);
+  });
+});
@@ -0,0 +1,46 @@
+var expect = require('chai').expect,
+  describe = require('mocha').describe,
+  it = require('mocha').it,
+  Metrics = require('../Metrics').default,
+  SharedMeterRegistry = require('../SharedMeterRegistry').default,
+  Timer = require('../Timer').default;
+
+describe('SharedMeterRegistry', function() {
+  it('should aggregate counters registered over the same buffer.', function() {
+    var exporting = new SharedMeterRegistry();
+    var first = new SharedMeterRegistry(exporting.buffer);
+    var second = new SharedMeterRegistry(exporting.buffer);
+
+    Metrics.counter(first, 'calls', 'calls', {method: 'foo'}).inc(2);
+    Metrics.counter(second, 'calls', 'calls', {method: 'foo'}).inc(3);
+    Metrics.counter(second, 'calls', 'calls', {method: 'bar'}).inc();
+
+    var meters = exporting.meters();
+    expect(meters.length).to.equal(2);
+    expect(meters.map(m => m.count).sort()).to.deep.equal([1, 5]);
+
+    Metrics.counter(first, 'calls', 'calls', {method: 'foo'}).inc();
+    expect(exporting.meters().map(m => m.count).sort()).to.deep.equal([1, 6]);
+  });
+
+  it('should aggregate timers registered over the same buffer.', function() {
+    var exporting = new SharedMeterRegistry();
+    var first = new Timer('svc.latency', undefined, []);
+    var second = new Timer('svc.latency', undefined, []);
+    new SharedMeterRegistry(exporting.buffer).registerMeter(first);
+    new SharedMeterRegistry(exporting.buffer).registerMeter(second);
+
+    first.update(10);
+    second.update(1000);
+    second.update(1000);
+
+    var timer = exporting.meters()[0];
+    expect(timer.type).to.equal('timer');
+    expect(timer.count).to.equal(3);
+    expect(timer.totalCount()).to.equal(3);
+    expect(timer.max()).to.equal(1000);
+    var percentiles = timer.percentiles([0.1, 0.9]);
+    expect(Math.abs(percentiles[0.1] - 10)).to.be.below(0.2);
+    expect(Math.abs(percentiles[0.9] - 1000)).to.be.below(20);
+  });
+});
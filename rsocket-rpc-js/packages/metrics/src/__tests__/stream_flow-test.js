@@ -0,0 +1,130 @@
+var expect = require('chai').expect,
+  describe = require('mocha').describe,
+  it = require('mocha').it,
+  QueuingFlowableProcessor = require('rsocket-rpc-core')
+    .QueuingFlowableProcessor,
+  Metrics = require('../Metrics').default,
+  SimpleMeterRegistry = require('../SimpleMeterRegistry').default;
+
+function gauges(registry) {
+  var values = {};
+  registry.meters().forEach(function(meter) {
+    values[meter.name.replace('Bar.stream.', '')] = meter.value();
+  });
+  return values;
+}
+
+describe('StreamFlow', function() {
+  it('should track credit until it runs out.', function() {
+    var registry = new SimpleMeterRegistry();
+    var controlled = Metrics.flowControlled(registry, 'Bar', 'response');
+    var flow = Metrics.streamFlow(controlled);
+
+    expect(gauges(registry).active).to.equal(1);
+    expect(gauges(registry).stalled).to.equal(1);
+
+    flow.request(2);
+    flow.next('a');
+    expect(gauges(registry).credit).to.equal(1);
+    expect(gauges(registry).stalled).to.equal(0);
+
+    flow.next('b');
+    expect(gauges(registry).credit).to.equal(0);
+    expect(gauges(registry).stalled).to.equal(1);
+
+    flow.close();
+    expect(gauges(registry).active).to.equal(0);
+    expect(gauges(registry).stalled).to.equal(0);
+  });
+
+  it('should not count the credit of unbounded streams.', function() {
+    var registry = new SimpleMeterRegistry();
+    var flow = Metrics.streamFlow(
+      Metrics.flowControlled(registry, 'Bar', 'response'),
+    );
+
+    flow.request(10);
+    flow.request(0x7fffffff);
+    flow.next('a');
+
+    expect(gauges(registry).credit).to.equal(0);
+    expect(gauges(registry).stalled).to.equal(0);
+  });
+
+  it('should release buffered elements when closed.', function() {
+    var registry = new SimpleMeterRegistry();
+    var flow = Metrics.streamFlow(
+      Metrics.flowControlled(registry, 'Bar', 'request'),
+    );
+
+    flow.buffer({data: Buffer.alloc(10), metadata: Buffer.alloc(5)});
+    flow.buffer(Buffer.alloc(20));
+    expect(gauges(registry).buffered).to.equal(2);
+    expect(gauges(registry)['buffered.bytes']).to.equal(35);
+
+    flow.unbuffer(Buffer.alloc(20));
+    expect(gauges(registry)['buffered.bytes']).to.equal(15);
+
+    flow.close();
+    expect(gauges(registry).buffered).to.equal(0);
+    expect(gauges(registry)['buffered.bytes']).to.equal(0);
+  });
+
+  it('should track what a QueuingFlowableProcessor buffers.', function() {
+    var registry = new SimpleMeterRegistry();
+    var processor = new QueuingFlowableProcessor(
+      undefined,
+      Metrics.streamFlow(Metrics.flowControlled(registry, 'Bar', 'request')),
+    );
+    var received = [];
+    var subscription;
+    processor.onSubscribe({request: function() {}, cancel: function() {}});
+    processor.subscribe({
+      onSubscribe: function(s) {
+        subscription = s;
+      },
+      onNext: function(value) {
+        received.push(value);
+      },
+      onComplete: function() {},
+    });
+
+    var now = Date.now;
+    var time = now();
+    Date.now = function() {
+      return time;
+    };
+    try {
+      processor.onNext(Buffer.alloc(10));
+      processor.onNext(Buffer.alloc(20));
+      expect(gauges(registry).buffered).to.equal(2);
+      expect(gauges(registry)['buffered.bytes']).to.equal(30);
+      expect(gauges(registry).stalled).to.equal(1);
+
+      // The stream waited 50ms with no credit
+      time += 50;
+      subscription.request(1);
+      expect(received.length).to.equal(1);
+      expect(gauges(registry).buffered).to.equal(1);
+      expect(gauges(registry)['buffered.bytes']).to.equal(20);
+      expect(gauges(registry)['stalled.time']).to.equal(50);
+
+      subscription.request(5);
+      expect(gauges(registry).buffered).to.equal(0);
+      expect(gauges(registry).credit).to.equal(4);
+      expect(gauges(registry).stalled).to.equal(0);
+
+      processor.onComplete();
+      expect(gauges(registry).active).to.equal(0);
+      expect(gauges(registry).credit).to.equal(0);
+    } finally {
+      Date.now = now;
+    }
+  });
+
+  it('should not track streams without a registry.', function() {
+    expect(
+      Metrics.streamFlow(Metrics.flowControlled(undefined, 'Bar', 'request')),
+    ).to.equal(null);
+  });
+});
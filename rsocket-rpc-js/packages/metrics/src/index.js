@@ -37,6 +37,7 @@ import {
 import {
   ExponentiallyDecayingSample,
   ExponentiallyWeightedMovingAverage,
+  LogLinearSample,
   Sample,
   UniformSample,
   ISample,
@@ -50,12 +51,21 @@ import Timer from './Timer';
 
 import Counter from './Counter';
 
+import DistributionSummary from './DistributionSummary';
+import Gauge from './Gauge';
+
+import PayloadSizes from './PayloadSizes';
+import PhaseTimers from './PhaseTimers';
+import StreamFlow from './StreamFlow';
+
 import {IMeter} from './IMeter';
 
 import {IMeterRegistry} from './IMeterRegistry';
 
 import SimpleMeterRegistry from './SimpleMeterRegistry';
 
+import SharedMeterRegistry from './SharedMeterRegistry';
+
 import MetricsExporter from './MetricsExporter';
 
 import Metrics from './Metrics';
@@ -65,11 +75,17 @@ import RawMeterTag from './RawMeterTag';
 export {
   BaseMeter,
   Counter,
+  DistributionSummary,
+  Gauge,
+  PayloadSizes,
+  PhaseTimers,
+  StreamFlow,
   Timer,
   RawMeterTag,
   Histogram,
   ExponentiallyDecayingSample,
   ExponentiallyWeightedMovingAverage,
+  LogLinearSample,
   Sample,
   UniformSample,
   ISample,
@@ -77,6 +93,7 @@ export {
   IMeter,
   IMeterRegistry,
   SimpleMeterRegistry,
+  SharedMeterRegistry,
   Metrics,
   MetricsExporter,
   MeterTag,
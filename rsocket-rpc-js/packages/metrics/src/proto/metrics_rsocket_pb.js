@@ -4,6 +4,7 @@
 var rsocket_rpc_frames = require('rsocket-rpc-frames');
 var rsocket_rpc_core = require('rsocket-rpc-core');
 var rsocket_rpc_tracing = require('rsocket-rpc-tracing');
+var rsocket_rpc_metrics = require('../Metrics').default;
 var rsocket_flowable = require('rsocket-flowable');
 var proto_metrics_pb = require('../proto/metrics_pb.js');
 
@@ -40,10 +41,12 @@ var MetricsSnapshotHandlerClient = function () {
 exports.MetricsSnapshotHandlerClient = MetricsSnapshotHandlerClient;
 
 var MetricsSnapshotHandlerServer = function () {
-  function MetricsSnapshotHandlerServer(service, tracer) {
+  var streamMetricsMeterTags = rsocket_rpc_metrics.tags({"service": "io.rsocket.rpc.metrics.om.MetricsSnapshotHandler"}, {"method": "streamMetrics"}, {"role": "server"});
+  function MetricsSnapshotHandlerServer(service, tracer, meterRegistry) {
     this._service = service;
     this._tracer = tracer;
     this.streamMetricsTrace = rsocket_rpc_tracing.traceAsChild(tracer, "MetricsSnapshotHandler.streamMetrics", {"rsocket.service": "io.rsocket.rpc.metrics.om.MetricsSnapshotHandler"}, {"rsocket.rpc.role": "server"});
+    this.streamMetricsRequestFlow = rsocket_rpc_metrics.flowControlled(meterRegistry, "MetricsSnapshotHandler", "request", streamMetricsMeterTags);
     this._channelSwitch = (payload, restOfMessages) => {
       if (payload.metadata == null) {
         return rsocket_flowable.Flowable.error(new Error('metadata is empty'));
@@ -81,7 +84,7 @@ var MetricsSnapshotHandlerServer = function () {
   MetricsSnapshotHandlerServer.prototype.requestChannel = function requestChannel(payloads) {
     let once = false;
     return new rsocket_flowable.Flowable(subscriber => {
-      const payloadProxy = new rsocket_rpc_core.QueuingFlowableProcessor();
+      const payloadProxy = new rsocket_rpc_core.QueuingFlowableProcessor(undefined, rsocket_rpc_metrics.streamFlow(this.streamMetricsRequestFlow));
       payloads.subscribe({
         onNext: payload => {
           if(!once){
@@ -0,0 +1,186 @@
+/**
+ * @flow
+ */
+
+'use strict';
+
+/* eslint-disable no-bitwise */
+
+import Sample from './Sample';
+
+// Each power of two is split into 2^SUB_BUCKET_BITS linear sub-buckets, which
+// bounds the relative error of a recorded value to about 1.6%
+const SUB_BUCKET_BITS = 5;
+const SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+// Recorded values are scaled to integers, e.g. milliseconds to microseconds
+const DEFAULT_UNITS_PER_VALUE = 1000;
+// Largest scaled value kept apart; anything above lands in the last bucket
+const MAX_SCALED_VALUE = 0x7fffffff;
+export const BUCKET_COUNT = bucketIndex(MAX_SCALED_VALUE) + 1;
+// Percentiles cover the values recorded over the last one to two windows
+const DEFAULT_WINDOW = 60 * 1000; // 1 minute in milliseconds
+
+/*
+ * An HDR-style histogram: values are counted in buckets that are linear
+ * within each power of two. Recording is O(1) and allocation free, high
+ * percentiles are accurate to the bucket resolution, and bucket counts from
+ * several samples can be merged by adding them up.
+ *
+ * counts() accumulates every recorded value, for export. Percentiles are
+ * computed over a pair of rotating windows, so that they follow recent
+ * latencies like the exponentially decaying sample did.
+ */
+export default class LogLinearSample extends Sample<number> {
+  unitsPerValue: number;
+  window: number;
+  totals: Float64Array;
+  current: Float64Array;
+  previous: Float64Array;
+  windowStart: number;
+
+  constructor(unitsPerValue?: number, window?: number) {
+    super();
+    this.unitsPerValue = unitsPerValue || DEFAULT_UNITS_PER_VALUE;
+    this.window = window || DEFAULT_WINDOW;
+    this.totals = new Float64Array(BUCKET_COUNT);
+    this.current = new Float64Array(BUCKET_COUNT);
+    this.previous = new Float64Array(BUCKET_COUNT);
+    this.clear();
+  }
+
+  clear(): void {
+    this.totals.fill(0);
+    this.current.fill(0);
+    this.previous.fill(0);
+    this.values = [];
+    this.count = 0;
+    this.windowStart = Date.now();
+  }
+
+  update(val: number, timestamp?: number): void {
+    this.add(this.indexOf(val), 1, timestamp);
+  }
+
+  /**
+   * Counts `count` values into a bucket, e.g. when aggregating other samples
+   */
+  add(index: number, count: number, timestamp?: number): void {
+    const now = timestamp === undefined ? Date.now() : timestamp;
+    if (now - this.windowStart >= this.window) {
+      this.rotate(now);
+    }
+    this.totals[index] += count;
+    this.current[index] += count;
+    this.count += count;
+  }
+
+  indexOf(val: number): number {
+    const scaled = Math.round(val * this.unitsPerValue);
+    return bucketIndex(scaled > 0 ? Math.min(scaled, MAX_SCALED_VALUE) : 0);
+  }
+
+  rotate(now: number): void {
+    const previous = this.previous;
+    previous.fill(0);
+    // A window with no records in between starts both windows afresh
+    if (now - this.windowStart < 2 * this.window) {
+      this.previous = this.current;
+      this.current = previous;
+    } else {
+      this.current.fill(0);
+    }
+    this.windowStart = now;
+  }
+
+  size(): number {
+    return this.count;
+  }
+
+  /**
+   * Expands the windowed buckets into one representative value per record.
+   * This is a relatively expensive operation, prefer percentiles().
+   */
+  getValues(): number[] {
+    const values = [];
+    for (let i = 0; i < BUCKET_COUNT; i++) {
+      const count = this.current[i] + this.previous[i];
+      if (count > 0) {
+        const value = this.bucketValue(i);
+        for (let j = 0; j < count; j++) {
+          values.push(value);
+        }
+      }
+    }
+    return values;
+  }
+
+  percentiles(percentiles: number[]): Object {
+    const scores = {};
+    let total = 0;
+    for (let i = 0; i < BUCKET_COUNT; i++) {
+      total += this.current[i] + this.previous[i];
+    }
+    if (total === 0) {
+      return scores;
+    }
+    for (let p = 0; p < percentiles.length; p++) {
+      const rank = Math.max(1, Math.ceil(percentiles[p] * total));
+      let seen = 0;
+      for (let i = 0; i < BUCKET_COUNT; i++) {
+        seen += this.current[i] + this.previous[i];
+        if (seen >= rank) {
+          scores[percentiles[p]] = this.bucketValue(i);
+          break;
+        }
+      }
+    }
+    return scores;
+  }
+
+  /**
+   * Cumulative count of every value ever recorded, per bucket
+   */
+  counts(): Float64Array {
+    return this.totals;
+  }
+
+  /**
+   * Upper bound of a bucket, in the units values are recorded in
+   */
+  bucketUpperBound(index: number): number {
+    return bucketLowerBound(index + 1) / this.unitsPerValue;
+  }
+
+  bucketValue(index: number): number {
+    const lower = bucketLowerBound(index);
+    const upper = bucketLowerBound(index + 1);
+    return (lower + (upper - lower - 1) / 2) / this.unitsPerValue;
+  }
+
+  merge(other: LogLinearSample): void {
+    for (let i = 0; i < BUCKET_COUNT; i++) {
+      this.totals[i] += other.totals[i];
+      this.current[i] += other.current[i] + other.previous[i];
+    }
+    this.count += other.count;
+  }
+}
+
+export function bucketIndex(scaled: number): number {
+  if (scaled < SUB_BUCKET_COUNT) {
+    return scaled;
+  }
+  const exponent = 31 - Math.clz32(scaled);
+  const shift = exponent - SUB_BUCKET_BITS;
+  const subBucket = (scaled >>> shift) - SUB_BUCKET_COUNT;
+  return ((shift + 1) << SUB_BUCKET_BITS) + subBucket;
+}
+
+export function bucketLowerBound(index: number): number {
+  if (index < 2 * SUB_BUCKET_COUNT) {
+    return index;
+  }
+  const shift = (index >>> SUB_BUCKET_BITS) - 1;
+  const mantissa = SUB_BUCKET_COUNT + (index & (SUB_BUCKET_COUNT - 1));
+  return mantissa * Math.pow(2, shift);
+}
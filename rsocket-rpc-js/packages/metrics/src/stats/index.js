@@ -2,6 +2,14 @@ import EWMA from './ExponentiallyWeightedMovingAverage';
 import ExponentiallyDecayingSample from './ExponentiallyDecayingSample';
 import Sample from './Sample';
 import ISample from './ISample';
+import LogLinearSample from './LogLinearSample';
 import UniformSample from './UniformSample';
 
-export {EWMA, ExponentiallyDecayingSample, ISample, Sample, UniformSample};
+export {
+  EWMA,
+  ExponentiallyDecayingSample,
+  ISample,
+  LogLinearSample,
+  Sample,
+  UniformSample,
+};
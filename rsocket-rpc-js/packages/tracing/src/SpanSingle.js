@@ -1,5 +1,6 @@
 import {Single, IFutureSubscriber} from 'rsocket-flowable/build/Single';
 import {Tracer, Span, SpanContext, FORMAT_TEXT_MAP} from 'opentracing';
+import {SPAN_CONTEXT} from './SpanSubscriber';
 
 export function createSpanSingle(
   single: Single<T>,
@@ -70,6 +71,9 @@ class SpanSingleSubscriber implements IFutureSubscriber<T> {
       FORMAT_TEXT_MAP,
       metadata === undefined || metadata === null ? {} : metadata,
     );
+    if (metadata) {
+      metadata[SPAN_CONTEXT] = this._span.context();
+    }
   }
 
   cleanup() {
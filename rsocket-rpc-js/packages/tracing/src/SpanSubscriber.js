@@ -1,6 +1,10 @@
 import {ISubscriber, ISubscription} from 'rsocket-types';
 import {Tracer, Span, SpanContext, FORMAT_TEXT_MAP} from 'opentracing';
 
+// Keeps the span context of a call in the map it was injected into, for the
+// binary trace context to be read from, see encodeTracedMetadata()
+export const SPAN_CONTEXT = Symbol('spanContext');
+
 export class SpanSubscriber<T> implements ISubscriber<T>, ISubscription {
   _span: Span;
   _rootSpan: Span;
@@ -56,6 +60,9 @@ export class SpanSubscriber<T> implements ISubscriber<T>, ISubscription {
       FORMAT_TEXT_MAP,
       metadata === undefined || metadata === null ? {} : metadata,
     );
+    if (metadata) {
+      metadata[SPAN_CONTEXT] = this._span.context();
+    }
   }
 
   cleanup() {
@@ -2,11 +2,109 @@ import {UTF8Encoder, BufferEncoder, createBuffer} from 'rsocket-core';
 import {ISubscriber} from 'rsocket-types';
 import {Flowable, Single} from 'rsocket-flowable';
 
-import {SpanSubscriber} from './SpanSubscriber';
+import {SpanSubscriber, SPAN_CONTEXT} from './SpanSubscriber';
 import {createSpanSingle} from './SpanSingle';
 import {SpanContext, Tracer, FORMAT_TEXT_MAP} from 'opentracing';
 
-import {getTracing} from 'rsocket-rpc-frames';
+import {getTracing, getTracingOffset} from 'rsocket-rpc-frames';
+
+/* eslint-disable no-bitwise */
+
+/**
+ * Binary trace context: the W3C traceparent fields in their binary form,
+ * after a marker no encoded map can start with (it would mean a 64KB key)
+ */
+const TRACE_CONTEXT_MARKER = 0xffff;
+const TRACE_CONTEXT_VERSION = 0;
+const TRACE_ID_OFFSET = 4;
+const SPAN_ID_OFFSET = 20;
+export const TRACE_CONTEXT_SIZE = 28;
+
+const TRACE_FLAG_SAMPLED = 0x01;
+
+const TRACEPARENT = 'traceparent';
+// Ids as returned by SpanContext.toTraceId() and toSpanId(), trace ids being
+// 64 or 128 bits
+const TRACE_ID_PATTERN = /^(?:[0-9a-f]{16}){1,2}$/;
+const SPAN_ID_PATTERN = /^[0-9a-f]{16}$/;
+
+// Encoded in place of the binary trace context, then overwritten
+const TRACE_CONTEXT_PLACEHOLDER = createBuffer(TRACE_CONTEXT_SIZE);
+
+/**
+ * Decides whether a call is traced, given its span name
+ */
+export type Sampler = (name: string) => boolean;
+
+const SAMPLERS: WeakMap<Tracer, Sampler> = new WeakMap();
+
+/**
+ * Reads the span context of the binary trace context at `offset` of
+ * `buffer`: a 2 byte marker, the version, the trace flags, the 16 byte trace
+ * id and the 8 byte span id
+ */
+export type TraceContextReader = (
+  buffer: Buffer,
+  offset: number,
+) => SpanContext;
+
+const READERS: WeakMap<Tracer, TraceContextReader> = new WeakMap();
+
+/**
+ * Encodes the routing metadata of a call, e.g. encodeMetadataV2
+ */
+export type MetadataEncoder = (
+  service: string,
+  method: string,
+  tracing: Buffer,
+  metadata: Buffer,
+  serviceId?: number,
+) => Buffer;
+
+/**
+ * The context deserializeTraceData returns when the caller chose not to
+ * sample a call, so that the server skips its span too
+ */
+export const UNSAMPLED = Object.freeze({});
+
+// Marks a client's carrier when the call was not sampled. A symbol, so that
+// it is not encoded as an entry of the map.
+const UNSAMPLED_KEY = Symbol('unsampled');
+
+// A binary trace context that only carries the (unset) sampled flag
+const UNSAMPLED_TRACE_CONTEXT = Buffer.from([0xff, 0xff, 0, 0]);
+
+const identity = publisher => publisher;
+
+/**
+ * Makes the trace helpers created for `tracer` sample calls up front: calls
+ * the sampler rejects get no span and send no trace context beyond a
+ * 'not sampled' flag. Servers follow the caller's decision and only consult
+ * their sampler for calls that arrive without a trace context.
+ */
+export function sampled(tracer: Tracer, sampler: Sampler): Tracer {
+  SAMPLERS.set(tracer, sampler);
+  return tracer;
+}
+
+/**
+ * Makes servers read binary trace contexts into span contexts with `reader`,
+ * rather than handing `tracer` a W3C traceparent carrier to extract
+ */
+export function traceContextReader(
+  tracer: Tracer,
+  reader: TraceContextReader,
+): Tracer {
+  READERS.set(tracer, reader);
+  return tracer;
+}
+
+/**
+ * Samples the given fraction of calls, e.g. 0.01 for 1%
+ */
+export function probabilitySampler(rate: number): Sampler {
+  return () => Math.random() < rate;
+}
 
 export function deserializeTraceData(tracer, metadata) {
   if (!tracer) {
@@ -19,10 +117,124 @@ export function deserializeTraceData(tracer, metadata) {
     return null;
   }
 
+  if (
+    tracingData.length >= 4 &&
+    tracingData.readUInt16BE(0) === TRACE_CONTEXT_MARKER &&
+    (getTraceFlags(tracingData) & TRACE_FLAG_SAMPLED) === 0
+  ) {
+    return UNSAMPLED;
+  }
+
+  if (isTraceContext(tracingData)) {
+    const reader = READERS.get(tracer);
+    if (reader) {
+      return reader(tracingData, 0);
+    }
+    const carrier = {};
+    carrier[TRACEPARENT] = traceContextToTraceparent(tracingData);
+    return tracer.extract(FORMAT_TEXT_MAP, carrier);
+  }
+
   return tracer.extract(FORMAT_TEXT_MAP, bufferToMap(tracingData));
 }
 
+/**
+ * Encodes the routing metadata of a call with `encode`, for clients generated
+ * with the trace_context=binary option. The ids of the span the trace
+ * helpers started for the call are written straight into the tracing segment
+ * as the 28 byte binary trace context. Calls whose span context does not
+ * expose its ids send the map the tracer injected instead, and unsampled
+ * calls only the 4 byte marker and flags. Servers only read the binary trace
+ * context from this version on, so they must be updated first.
+ */
+export function encodeTracedMetadata(
+  encode: MetadataEncoder,
+  map: Object,
+  service: string,
+  method: string,
+  metadata: Buffer,
+  serviceId?: number,
+): Buffer {
+  if (map && map[UNSAMPLED_KEY]) {
+    return encode(
+      service,
+      method,
+      UNSAMPLED_TRACE_CONTEXT,
+      metadata,
+      serviceId,
+    );
+  }
+  const context = map ? map[SPAN_CONTEXT] : undefined;
+  const traceId = context && context.toTraceId ? context.toTraceId() : '';
+  const spanId = context && context.toSpanId ? context.toSpanId() : '';
+  if (!TRACE_ID_PATTERN.test(traceId) || !SPAN_ID_PATTERN.test(spanId)) {
+    return encode(service, method, mapToBuffer(map), metadata, serviceId);
+  }
+
+  const buffer = encode(
+    service,
+    method,
+    TRACE_CONTEXT_PLACEHOLDER,
+    metadata,
+    serviceId,
+  );
+  const offset = getTracingOffset(buffer);
+  buffer.writeUInt16BE(TRACE_CONTEXT_MARKER, offset);
+  buffer[offset + 2] = TRACE_CONTEXT_VERSION;
+  // The trace helpers only start spans for sampled calls
+  buffer[offset + 3] = TRACE_FLAG_SAMPLED;
+  // 64-bit trace ids take the low half of the trace id
+  writeHex(buffer, offset + SPAN_ID_OFFSET - traceId.length / 2, traceId);
+  writeHex(buffer, offset + SPAN_ID_OFFSET, spanId);
+  return buffer;
+}
+
+export function isTraceContext(buffer: Buffer): boolean {
+  return (
+    buffer.length >= TRACE_CONTEXT_SIZE &&
+    buffer.readUInt16BE(0) === TRACE_CONTEXT_MARKER
+  );
+}
+
+/**
+ * Returns the trace flags of a binary trace context, bit 0 being `sampled`.
+ */
+export function getTraceFlags(buffer: Buffer): number {
+  return buffer[3];
+}
+
+function traceContextToTraceparent(buffer: Buffer): string {
+  return (
+    '00-' +
+    buffer.toString('hex', TRACE_ID_OFFSET, SPAN_ID_OFFSET) +
+    '-' +
+    buffer.toString('hex', SPAN_ID_OFFSET, TRACE_CONTEXT_SIZE) +
+    '-' +
+    buffer.toString('hex', 3, 4)
+  );
+}
+
+function writeHex(buffer: Buffer, offset: number, hex: string): void {
+  for (let i = 0; i < hex.length; i += 2) {
+    buffer[offset + i / 2] =
+      (hexDigit(hex.charCodeAt(i)) << 4) | hexDigit(hex.charCodeAt(i + 1));
+  }
+}
+
+function hexDigit(code: number): number {
+  // '0'-'9' or 'a'-'f', as checked by TRACE_ID_PATTERN and SPAN_ID_PATTERN
+  return code <= 57 ? code - 48 : code - 87;
+}
+
+/**
+ * Encodes the carrier the tracer injected a call's span context into. Calls
+ * the client chose not to sample are encoded as the 4 byte 'not sampled'
+ * binary trace context instead, which servers honor in either form.
+ */
 export function mapToBuffer(map: Object): Buffer {
+  if (map && map[UNSAMPLED_KEY]) {
+    return UNSAMPLED_TRACE_CONTEXT;
+  }
   if (!map || Object.keys(map).length <= 0) {
     return createBuffer(0);
   }
@@ -108,7 +320,11 @@ export function trace<T>(
   ...tags: Object
 ): Object => (Flowable<T>) => Flowable<T> {
   if (tracer && name) {
+    const sampler = SAMPLERS.get(tracer);
     return (metadata: Object) => {
+      if (sampler && !sampler(name)) {
+        return unsampled(metadata);
+      }
       return (flowable: Flowable<T>) => {
         return flowable.lift((subscriber: ISubscriber<T>) => {
           return new SpanSubscriber(
@@ -133,7 +349,11 @@ export function traceAsChild<T>(
   ...tags: Object
 ): SpanContext => (Flowable<T>) => Flowable<T> {
   if (tracer && name) {
+    const sampler = SAMPLERS.get(tracer);
     return (context: SpanContext) => {
+      if (!sampledAsChild(context, sampler, name)) {
+        return identity;
+      }
       return (flowable: Flowable<T>) => {
         return flowable.lift((subscriber: ISubscriber<T>) => {
           return new SpanSubscriber(
@@ -158,7 +378,11 @@ export function traceSingle<T>(
   ...tags: Object
 ): Object => (Single<T>) => Single<T> {
   if (tracer && name) {
+    const sampler = SAMPLERS.get(tracer);
     return (metadata: Object) => {
+      if (sampler && !sampler(name)) {
+        return unsampled(metadata);
+      }
       return (single: Single<T>) => {
         return createSpanSingle(single, tracer, name, null, metadata, ...tags);
       };
@@ -174,7 +398,11 @@ export function traceSingleAsChild<T>(
   ...tags: Object
 ): SpanContext => (Single<T>) => Single<T> {
   if (tracer && name) {
+    const sampler = SAMPLERS.get(tracer);
     return (context: SpanContext) => {
+      if (!sampledAsChild(context, sampler, name)) {
+        return identity;
+      }
       return (single: Single<T>) => {
         return createSpanSingle(single, tracer, name, context, null, ...tags);
       };
@@ -183,3 +411,22 @@ export function traceSingleAsChild<T>(
     return (context: SpanContext) => (single: Single<T>) => single;
   }
 }
+
+function unsampled(metadata: Object) {
+  if (metadata) {
+    metadata[UNSAMPLED_KEY] = true;
+  }
+  return identity;
+}
+
+function sampledAsChild(
+  context: ?SpanContext,
+  sampler: ?Sampler,
+  name: String,
+): boolean {
+  if (context === UNSAMPLED) {
+    return false;
+  }
+  // Calls with an upstream context follow the caller's decision
+  return context || !sampler ? true : sampler((name: any));
+}
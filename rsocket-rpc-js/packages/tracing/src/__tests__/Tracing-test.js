@@ -1,7 +1,37 @@
 import {expect} from 'chai';
 import {describe, it} from 'mocha';
 
-import {mapToBuffer, bufferToMap} from '../Tracing';
+import {Single} from 'rsocket-flowable';
+import {encodeMetadata, encodeMetadataV2, getTracing} from 'rsocket-rpc-frames';
+import {
+  mapToBuffer,
+  bufferToMap,
+  encodeTracedMetadata,
+  deserializeTraceData,
+  getTraceFlags,
+  isTraceContext,
+  sampled,
+  traceContextReader,
+  traceSingle,
+  traceSingleAsChild,
+  UNSAMPLED,
+} from '../Tracing';
+
+// A tracer whose spans expose their ids, as opentracing span contexts do
+function spanTracer(traceId) {
+  const context = {
+    toSpanId: () => 'b7ad6b7169203331',
+    toTraceId: () => traceId,
+  };
+  return {
+    inject: () => {},
+    startSpan: () => ({
+      context: () => context,
+      finish: () => {},
+      log: () => {},
+    }),
+  };
+}
 
 function generateMap() {
   const size = Math.floor(Math.random() * 100) + 20;
@@ -36,4 +66,139 @@ describe('TRACING HELPERS', () => {
       expect(testMap).to.deep.equal(baseMap);
     }
   });
+
+  it('writes the ids of the span into the routing metadata', () => {
+    const tracer = spanTracer('0af7651916cd43dd8448eb211c80319c');
+    const map = {};
+    traceSingle(tracer, 'client')(map)(Single.of(1)).subscribe({});
+
+    const metadata = encodeTracedMetadata(
+      encodeMetadataV2,
+      map,
+      'service',
+      'foo',
+      Buffer.alloc(0),
+    );
+    const tracing = getTracing(metadata);
+    expect(tracing.length).to.equal(28);
+    expect(isTraceContext(tracing)).to.equal(true);
+    expect(getTraceFlags(tracing)).to.equal(1);
+
+    const extracted = [];
+    tracer.extract = (format, carrier) => {
+      extracted.push(carrier);
+      return 'context';
+    };
+    expect(deserializeTraceData(tracer, metadata)).to.equal('context');
+    expect(extracted).to.deep.equal([
+      {traceparent: '00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01'},
+    ]);
+  });
+
+  it('reads binary trace contexts with the reader of the tracer', () => {
+    const tracer = spanTracer('8448eb211c80319c');
+    const map = {};
+    traceSingle(tracer, 'client')(map)(Single.of(1)).subscribe({});
+    const metadata = encodeTracedMetadata(
+      encodeMetadata,
+      map,
+      'service',
+      'foo',
+      Buffer.alloc(0),
+    );
+
+    traceContextReader(tracer, (buffer, offset) =>
+      buffer.toString('hex', offset + 4, offset + 28),
+    );
+    expect(deserializeTraceData(tracer, metadata)).to.equal(
+      '00000000000000008448eb211c80319cb7ad6b7169203331',
+    );
+  });
+
+  it('falls back to the encoded map for spans without ids', () => {
+    const map = {'uber-trace-id': 'abc:def:0:1'};
+    const metadata = encodeTracedMetadata(
+      encodeMetadata,
+      map,
+      'service',
+      'foo',
+      Buffer.alloc(0),
+    );
+
+    expect(isTraceContext(getTracing(metadata))).to.equal(false);
+    expect(bufferToMap(getTracing(metadata))).to.deep.equal(map);
+  });
+
+  it('skips spans and trace data for unsampled calls', () => {
+    const spans = [];
+    const tracer = sampled(
+      {
+        startSpan: name => {
+          spans.push(name);
+          return {context: () => ({}), log: () => {}, finish: () => {}};
+        },
+        inject: () => {},
+        extract: () => ({}),
+      },
+      () => false,
+    );
+
+    const map = {};
+    const single = Single.of(1);
+    expect(traceSingle(tracer, 'client')(map)(single)).to.equal(single);
+
+    const metadata = encodeTracedMetadata(
+      encodeMetadata,
+      map,
+      'service',
+      'foo',
+      Buffer.alloc(0),
+    );
+    const tracing = getTracing(metadata);
+    expect(tracing.length).to.equal(4);
+    expect(getTraceFlags(tracing)).to.equal(0);
+
+    const context = deserializeTraceData(tracer, metadata);
+    expect(context).to.equal(UNSAMPLED);
+
+    const traceServer = traceSingleAsChild(sampled(tracer, () => true), 'srv');
+    expect(traceServer(context)(single)).to.equal(single);
+    expect(spans).to.deep.equal([]);
+
+    traceServer({})(single).subscribe({});
+    expect(spans).to.deep.equal(['srv']);
+  });
+
+  it('sends unsampled calls as such in the encoded map', () => {
+    const clientTracer = sampled(
+      {startSpan: () => expect.fail(), inject: () => {}},
+      () => false,
+    );
+    const spans = [];
+    // A server without a sampler of its own
+    const serverTracer = {
+      extract: () => ({}),
+      startSpan: name => {
+        spans.push(name);
+        return {context: () => ({}), log: () => {}, finish: () => {}};
+      },
+    };
+
+    // What generated clients send by default
+    const map = {};
+    const single = Single.of(1);
+    traceSingle(clientTracer, 'client')(map)(single);
+    const metadata = encodeMetadata(
+      'service',
+      'foo',
+      mapToBuffer(map),
+      Buffer.alloc(0),
+    );
+
+    const context = deserializeTraceData(serverTracer, metadata);
+    expect(context).to.equal(UNSAMPLED);
+    const traceServer = traceSingleAsChild(serverTracer, 'srv');
+    traceServer(context)(single).subscribe({});
+    expect(spans).to.deep.equal([]);
+  });
 });
@@ -26,6 +26,13 @@ import {
   mapToBuffer,
   deserializeTraceData,
   bufferToMap,
+  encodeTracedMetadata,
+  traceContextReader,
+  isTraceContext,
+  getTraceFlags,
+  sampled,
+  probabilitySampler,
+  UNSAMPLED,
 } from './Tracing';
 
 export {
@@ -36,4 +43,11 @@ export {
   mapToBuffer,
   deserializeTraceData,
   bufferToMap,
+  encodeTracedMetadata,
+  traceContextReader,
+  isTraceContext,
+  getTraceFlags,
+  sampled,
+  probabilitySampler,
+  UNSAMPLED,
 };
@@ -18,18 +18,21 @@
 
 #include <map>
 
+#include "js_generator.h"
 #include "js_generator_helpers.h"
 #include "rsocket/options.pb.h"
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
 using google::protobuf::Descriptor;
+using google::protobuf::FieldDescriptor;
 using google::protobuf::FileDescriptor;
 using google::protobuf::MethodDescriptor;
 using google::protobuf::ServiceDescriptor;
 using google::protobuf::io::Printer;
 using google::protobuf::io::StringOutputStream;
 using io::rsocket::rpc::RSocketMethodOptions;
+using io::rsocket::rpc::RSocketServiceOptions;
 
 namespace rsocket_rpc_js_generator {
 namespace {
@@ -115,47 +118,436 @@ string NodeObjectPath(const Descriptor* descriptor) {
   return module_alias + "." + name;
 }
 
-void PrintMethod(const MethodDescriptor* method, Printer* out) {
-  const Descriptor* input_type = method->input_type();
+bool IsCompressed(const MethodDescriptor* method) {
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  return options.compression() != io::rsocket::rpc::COMPRESSION_NONE && !options.fire_and_forget();
+}
+
+// Prints the recorder of a method's payload sizes, registered next to its
+// latency timer
+void PrintPayloadSizes(const MethodDescriptor* method, Printer* out) {
+  std::map<string, string> vars;
+  vars["service_short_name"] = method->service()->name();
+  vars["method_name"] = LowercaseFirstLetter(method->name());
+  out->Print(vars, "this.$method_name$Sizes = rsocket_rpc_metrics.payloadSizes(meterRegistry, \"$service_short_name$\", $method_name$MeterTags);\n");
+}
+
+// Prints the timers of a method's decode, handler and encode phases, when
+// phase timing is enabled
+void PrintPhaseTimers(const MethodDescriptor* method, const Parameters& params, Printer* out) {
+  if (!params.phase_timing) {
+    return;
+  }
+  std::map<string, string> vars;
+  vars["service_short_name"] = method->service()->name();
+  vars["method_name"] = LowercaseFirstLetter(method->name());
+  out->Print(vars, "this.$method_name$Phases = rsocket_rpc_metrics.phaseTimers(meterRegistry, \"$service_short_name$\", $method_name$MeterTags);\n");
+}
+
+// Prints the local the phase timing statements below record into
+void PrintPhases(const MethodDescriptor* method, const Parameters& params, Printer* out) {
+  if (!params.phase_timing) {
+    return;
+  }
+  std::map<string, string> vars;
+  vars["method_name"] = LowercaseFirstLetter(method->name());
+  out->Print(vars, "var phases = this.$method_name$Phases;\n");
+}
+
+// Prints the start of the handler phase, which ends at the first result
+void PrintHandlerStart(const Parameters& params, Printer* out) {
+  if (params.phase_timing) {
+    out->Print("var handlerStart = phases.now();\n");
+  }
+}
+
+void PrintHandled(const Parameters& params, Printer* out) {
+  if (params.phase_timing) {
+    out->Print("handlerStart = phases.handled(handlerStart);\n");
+  }
+}
+
+// Prints the serialization of `message` into `dataBuf`, declared by `decl`
+void PrintEncode(const Parameters& params, const string& decl, Printer* out) {
+  std::map<string, string> vars;
+  vars["decl"] = decl;
+  if (params.phase_timing) {
+    out->Print("var encodeStart = phases.now();\n");
+  }
+  out->Print(vars, "$decl$dataBuf = Buffer.from(message.serializeBinary());\n");
+  if (params.phase_timing) {
+    out->Print("phases.encoded(encodeStart);\n");
+  }
+}
+
+// Prints the return of the message deserialized from `binary`
+void PrintDecode(const Parameters& params, const string& type, Printer* out) {
+  std::map<string, string> vars;
+  vars["type"] = type;
+  if (params.phase_timing) {
+    out->Print("var decodeStart = phases.now();\n");
+    out->Print(vars, "var decoded = $type$.deserializeBinary(binary);\n");
+    out->Print("phases.decoded(decodeStart);\n");
+    out->Print("return decoded;\n");
+  } else {
+    out->Print(vars, "return $type$.deserializeBinary(binary);\n");
+  }
+}
+
+// Prints the request a server handler is called with: an expression, or
+// `request` once it has been decoded into a local
+string PrintDecodeRequest(const Parameters& params, const string& type, Printer* out) {
+  if (!params.phase_timing) {
+    return type + ".deserializeBinary(binary)";
+  }
+  std::map<string, string> vars;
+  vars["type"] = type;
+  out->Print("var decodeStart = phases.now();\n");
+  out->Print(vars, "var request = $type$.deserializeBinary(binary);\n");
+  out->Print("phases.decoded(decodeStart);\n");
+  return "request";
+}
+
+// Prints the flow control gauges of a streaming method's responses and, for
+// client streaming methods, of its requests
+void PrintFlowControl(const MethodDescriptor* method, Printer* out) {
+  std::map<string, string> vars;
+  vars["service_short_name"] = method->service()->name();
+  vars["method_name"] = LowercaseFirstLetter(method->name());
+  out->Print(vars, "this.$method_name$Flow = rsocket_rpc_metrics.flowControlled(meterRegistry, \"$service_short_name$\", \"response\", $method_name$MeterTags);\n");
+  if (method->client_streaming()) {
+    out->Print(vars, "this.$method_name$RequestFlow = rsocket_rpc_metrics.flowControlled(meterRegistry, \"$service_short_name$\", \"request\", $method_name$MeterTags);\n");
+  }
+}
+
+bool IsChunked(const MethodDescriptor* method) {
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  return options.chunked() && method->server_streaming();
+}
+
+bool IsPacked(const MethodDescriptor* method) {
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  return options.pack() && method->server_streaming() && !options.chunked();
+}
+
+bool IsOffloaded(const MethodDescriptor* method) {
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  return options.offload() && !method->client_streaming() && !method->server_streaming();
+}
+
+bool HasOffloaded(const ServiceDescriptor* service) {
+  for (int i = 0; i < service->method_count(); i++) {
+    if (IsOffloaded(service->method(i))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The priority of a method's calls: its own, or else its service's
+int MethodPriority(const MethodDescriptor* method) {
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  if (options.priority() != io::rsocket::rpc::PRIORITY_UNSET) {
+    return options.priority();
+  }
+  const RSocketServiceOptions service_options = method->service()->options().GetExtension(io::rsocket::rpc::service_options);
+  return service_options.priority();
+}
+
+// Prints the priorities of a server's methods, by which a RequestHandlingRSocket
+// given a PriorityScheduler admits their calls
+void PrintPriorities(const ServiceDescriptor* service, Printer* out) {
+  std::map<string, string> vars;
+  vars["server_name"] = service->name() + "Server";
+  bool printed = false;
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    int priority = MethodPriority(method);
+    if (priority == io::rsocket::rpc::PRIORITY_UNSET) {
+      continue;
+    }
+    if (!printed) {
+      out->Print(vars, "$server_name$.prototype.priorities = {\n");
+      out->Indent();
+      printed = true;
+    }
+    vars["name"] = method->name();
+    vars["priority"] = std::to_string(priority);
+    out->Print(vars, "'$name$': $priority$,\n");
+  }
+  if (printed) {
+    out->Outdent();
+    out->Print("};\n");
+  }
+}
+
+// Prints the call of an offloaded method on the server's WorkerPool, which
+// emits the serialized response
+void PrintRunOffloaded(const MethodDescriptor* method, Printer* out) {
+  std::map<string, string> vars;
+  vars["service_name"] = method->service()->full_name();
+  vars["name"] = method->name();
+  out->Print(vars, "this._workers.run('$service_name$', '$name$', binary, payload.metadata)");
+}
+
+// Prints the call of an offloaded method from a client in the same process,
+// which hands the worker the message serialized
+void PrintRunOffloadedLocal(const MethodDescriptor* method, Printer* out) {
+  std::map<string, string> vars;
+  vars["service_name"] = method->service()->full_name();
+  vars["name"] = method->name();
+  out->Print(vars, "this._workers.run('$service_name$', '$name$', message.serializeBinary(), metadata)");
+}
+
+// Prints the packer of a server's responses to a method declared with `pack`
+void PrintPack(const MethodDescriptor* method, Printer* out) {
+  if (!IsPacked(method)) {
+    return;
+  }
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  std::map<string, string> vars;
+  vars["method_name"] = LowercaseFirstLetter(method->name());
+  vars["pack_max_bytes"] = std::to_string(options.pack_max_bytes() > 0 ? options.pack_max_bytes() : 16384);
+  vars["pack_linger_ms"] = std::to_string(options.pack_linger_ms());
+  out->Print(vars, "this.$method_name$Pack = rsocket_rpc_core.packPayloads($pack_max_bytes$, $pack_linger_ms$);\n");
+}
+
+// Prints the splitter of a server's responses to a method declared with
+// `chunked`
+void PrintChunk(const MethodDescriptor* method, Printer* out) {
+  if (!IsChunked(method)) {
+    return;
+  }
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  std::map<string, string> vars;
+  vars["method_name"] = LowercaseFirstLetter(method->name());
+  vars["chunk_size"] = std::to_string(options.chunk_size() > 0 ? options.chunk_size() : 65536);
+  out->Print(vars, "this.$method_name$Chunk = rsocket_rpc_core.chunkPayloads($chunk_size$);\n");
+}
+
+// The lift() a server applies to the encoded responses of a method
+string ResponseLift(const MethodDescriptor* method) {
+  string method_name = LowercaseFirstLetter(method->name());
+  if (IsChunked(method)) {
+    return ".lift(this." + method_name + "Chunk)";
+  }
+  if (IsPacked(method)) {
+    return ".lift(this." + method_name + "Pack)";
+  }
+  return "";
+}
+
+// The repeated message fields of a chunked method's response that its client
+// can read element by element, those whose type the generated file imports
+std::vector<const FieldDescriptor*> ElementFields(const MethodDescriptor* method) {
+  std::vector<const FieldDescriptor*> fields;
+  if (!IsChunked(method)) {
+    return fields;
+  }
+  const FileDescriptor* file = method->service()->file();
   const Descriptor* output_type = method->output_type();
+  for (int i = 0; i < output_type->field_count(); i++) {
+    const FieldDescriptor* field = output_type->field(i);
+    if (!field->is_repeated() || field->type() != FieldDescriptor::TYPE_MESSAGE) {
+      continue;
+    }
+    const FileDescriptor* element_file = field->message_type()->file();
+    bool imported = element_file == file;
+    for (int j = 0; j < file->dependency_count() && !imported; j++) {
+      imported = file->dependency(j) == element_file;
+    }
+    if (imported) {
+      fields.push_back(field);
+    }
+  }
+  return fields;
+}
+
+// Prints the compressor shared by a method's client and server code
+void PrintCompression(const MethodDescriptor* method, Printer* out) {
+  if (!IsCompressed(method)) {
+    return;
+  }
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  std::map<string, string> vars;
+  vars["method_name"] = LowercaseFirstLetter(method->name());
+  vars["compression"] = std::to_string(options.compression());
+  vars["compression_threshold"] = std::to_string(options.compression_threshold() > 0 ? options.compression_threshold() : 1024);
+  vars["compression_max_bytes"] = std::to_string(options.compression_max_bytes() > 0 ? options.compression_max_bytes() : 16 * 1024 * 1024);
+  out->Print(vars, "this.$method_name$Compression = new rsocket_rpc_core.Compression($compression$, $compression_threshold$, $compression_max_bytes$);\n");
+}
+
+// The names of the `cache_key_metadata` option as a JavaScript array, or an
+// empty string when the whole metadata goes into the cache key
+string CacheKeyMetadata(const MethodDescriptor* method) {
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  if (options.cache_key_metadata_size() == 0) {
+    return "";
+  }
+  string names;
+  for (int i = 0; i < options.cache_key_metadata_size(); i++) {
+    string name = StringReplace(options.cache_key_metadata(i), "\\", "\\\\", true);
+    names += (i > 0 ? ", \"" : "[\"") + StringReplace(name, "\"", "\\\"", true) + "\"";
+  }
+  return names + "]";
+}
+
+// The id a service is interned under: the 32-bit FNV-1a hash of its name, as
+// computed by serviceId() in rsocket-rpc-frames
+uint32_t ServiceId(const string& service) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < service.size(); i++) {
+    hash ^= static_cast<uint8_t>(service[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Prints metadataBuf, the routing metadata of a client call, carrying the
+// trace context injected into map
+void PrintRoutingMetadata(const std::map<string, string>& vars, Printer* out) {
+  if (vars.at("trace_context") == "binary") {
+    out->Print(vars, "var metadataBuf = rsocket_rpc_tracing.encodeTracedMetadata(rsocket_rpc_frames.$encode_metadata$, map, '$service_name$', '$name$', metadata || Buffer.alloc(0)$service_id$);\n");
+  } else {
+    out->Print("var tracingMetadata = rsocket_rpc_tracing.mapToBuffer(map);\n");
+    out->Print(vars, "var metadataBuf = rsocket_rpc_frames.$encode_metadata$('$service_name$', '$name$', tracingMetadata, metadata || Buffer.alloc(0)$service_id$);\n");
+  }
+}
+
+// Prints the call of a generated server in the same process, when the client
+// was given a LoopbackRSocket serving it. Messages are handed over as they
+// are, while the client's metrics and tracing still apply.
+void PrintLocalCall(const MethodDescriptor* method, const std::map<string, string>& method_vars, Printer* out) {
+  const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+  std::map<string, string> vars = method_vars;
+  out->Print(vars, "var local = rsocket_rpc_core.localServer(this._rs, '$service_name$');\n");
+  out->Print("if (local) {\n");
+  out->Indent();
+  out->Print("const map = {};\n");
+  if (method->client_streaming() || method->server_streaming()) {
+    vars["publisher"] = "Flowable";
+    out->Print(vars, "return rsocket_rpc_core.withAsyncIterator(this.$method_name$Flow(this.$method_name$Metrics(\n");
+  } else if (options.fire_and_forget()) {
+    vars["publisher"] = "Single";
+    out->Print(vars, "this.$method_name$Metrics(\n");
+  } else {
+    vars["publisher"] = "Single";
+    out->Print(vars, "return this.$method_name$Metrics(\n");
+  }
+  out->Indent();
+  out->Print(vars, "this.$method_name$Trace(map)(new rsocket_flowable.$publisher$(subscriber => {\n");
+  out->Indent();
+  PrintRoutingMetadata(vars, out);
+  if (method->client_streaming()) {
+    out->Print(vars, "local.requestChannel('$name$', this.$method_name$RequestFlow(messages), metadataBuf).subscribe(subscriber);\n");
+  } else if (method->server_streaming()) {
+    out->Print(vars, "local.requestStream('$name$', message, metadataBuf).subscribe(subscriber);\n");
+  } else if (options.fire_and_forget()) {
+    out->Print(vars, "local.fireAndForget('$name$', message, metadataBuf);\n");
+    out->Print("subscriber.onSubscribe();\n");
+    out->Print("subscriber.onComplete();\n");
+  } else {
+    out->Print(vars, "local.requestResponse('$name$', message, metadataBuf).subscribe(subscriber);\n");
+  }
+  out->Outdent();
+  out->Print("}))\n");
+  out->Outdent();
+  if (method->client_streaming() || method->server_streaming()) {
+    out->Print(")));\n");
+  } else if (options.fire_and_forget()) {
+    out->Print(").subscribe({ onSubscribe: function onSubscribe() {}, onComplete: function onComplete() {} });\n");
+    out->Print("return;\n");
+  } else {
+    out->Print(");\n");
+  }
+  out->Outdent();
+  out->Print("}\n");
+}
+
+// Prints a client method. Given a repeated field of a chunked method's
+// response, prints the method reading the elements of that field instead.
+void PrintMethod(const MethodDescriptor* method, const Parameters& params, Printer* out,
+                 const FieldDescriptor* elements = nullptr) {
+  const Descriptor* input_type = method->input_type();
+  const Descriptor* output_type = elements ? elements->message_type() : method->output_type();
   const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
 
   std::map<string, string> vars;
+  if (params.metadata_version >= 2) {
+    vars["encode_metadata"] = "encodeMetadataV2";
+    vars["service_id"] = ", " + std::to_string(ServiceId(method->service()->full_name()));
+  } else {
+    vars["encode_metadata"] = "encodeMetadata";
+    vars["service_id"] = "";
+  }
+  vars["trace_context"] = params.binary_trace_context ? "binary" : "map";
   vars["client_name"] = method->service()->name() + "Client";
   vars["service_name"] = method->service()->full_name();
   vars["method_name"] = LowercaseFirstLetter(method->name());
+  vars["function_name"] = vars["method_name"];
   vars["name"] = method->name();
   vars["input_type"] = NodeObjectPath(input_type);
   vars["output_type"] = NodeObjectPath(output_type);
+  vars["unpack"] = "";
+  const string chunk_max_bytes =
+      std::to_string(options.chunk_max_bytes() > 0 ? options.chunk_max_bytes() : 16 * 1024 * 1024);
+  if (elements) {
+    vars["function_name"] += LowerUnderscoreToUpperCamel(elements->name());
+    vars["unpack"] = ".lift(rsocket_rpc_core.repeatedField(" + std::to_string(elements->number()) + ", " +
+                     chunk_max_bytes + "))";
+  } else if (IsChunked(method)) {
+    vars["unpack"] = ".lift(rsocket_rpc_core.joinChunks(" + chunk_max_bytes + "))";
+  } else if (IsPacked(method)) {
+    vars["unpack"] = ".lift(rsocket_rpc_core.unpackPayloads)";
+  }
   if (method->client_streaming()) {
-    out->Print(vars, "$client_name$.prototype.$method_name$ = function $method_name$(messages, metadata) {\n");
+    out->Print(vars, "$client_name$.prototype.$function_name$ = function $function_name$(messages, metadata) {\n");
     out->Indent();
+    if (!elements) {
+      PrintLocalCall(method, vars, out);
+    }
+    PrintPhases(method, params, out);
     out->Print("const map = {};\n");
-    out->Print(vars, "return this.$method_name$Metrics(\n");
+    out->Print(vars, "return rsocket_rpc_core.withAsyncIterator(this.$method_name$Flow(this.$method_name$Metrics(\n");
     out->Indent();
     out->Print(vars, "this.$method_name$Trace(map)(new rsocket_flowable.Flowable(subscriber => {\n");
     out->Indent();
     out->Print(vars, "var dataBuf;\n");
-    out->Print(vars, "var tracingMetadata = rsocket_rpc_tracing.mapToBuffer(map);\n");
-    out->Print(vars, "var metadataBuf ;\n");
+    PrintRoutingMetadata(vars, out);
+    out->Print(vars, "var sizes = this.$method_name$Sizes;\n");
+    PrintHandlerStart(params, out);
     out->Indent();
-    out->Print("this._rs.requestChannel(messages.map(function (message) {\n");
+    if (IsCompressed(method)) {
+      out->Print(vars, "this.$method_name$Compression.requestChannel(this.$method_name$RequestFlow(messages).map(function (message) {\n");
+    } else {
+      out->Print(vars, "this._rs.requestChannel(this.$method_name$RequestFlow(messages).map(function (message) {\n");
+    }
     out->Indent();
-    out->Print("dataBuf = Buffer.from(message.serializeBinary());\n");
-    out->Print(vars, "metadataBuf = rsocket_rpc_frames.encodeMetadata('$service_name$', '$name$', tracingMetadata, metadata || Buffer.alloc(0));\n");
-    out->Print("return {\n");
+    PrintEncode(params, "", out);
+    out->Print("sizes.request(dataBuf, metadataBuf);\n");
+    out->Print("var payload = {\n");
     out->Indent();
     out->Print(
         "data: dataBuf,\n"
         "metadata: metadataBuf\n");
     out->Outdent();
     out->Print("};\n");
+    // The server routes a channel on its first frame, so the routing and
+    // tracing headers are only encoded and sent once
+    out->Print("metadataBuf = Buffer.alloc(0);\n");
+    out->Print("return payload;\n");
     out->Outdent();
-    out->Print("})).map(function (payload) {\n");
+    if (IsCompressed(method)) {
+      out->Print(vars, "}), payloads => this._rs.requestChannel(payloads))$unpack$.map(function (payload) {\n");
+    } else {
+      out->Print(vars, "}))$unpack$.map(function (payload) {\n");
+    }
     out->Indent();
     out->Print("//TODO: resolve either 'https://github.com/rsocket/rsocket-js/issues/19' or 'https://github.com/google/protobuf/issues/1319'\n");
     out->Print("var binary = !payload.data || payload.data.constructor === Buffer || payload.data.constructor === Uint8Array ? payload.data : new Uint8Array(payload.data);\n");
-    out->Print(vars, "return $output_type$.deserializeBinary(binary);\n");
+    out->Print("sizes.response(binary, payload.metadata);\n");
+    PrintHandled(params, out);
+    PrintDecode(params, vars["output_type"], out);
     out->Outdent();
     out->Print("}).subscribe(subscriber);\n");
     out->Outdent();
@@ -163,31 +555,47 @@ void PrintMethod(const MethodDescriptor* method, Printer* out) {
     out->Outdent();
     out->Print(")\n");
     out->Outdent();
-    out->Print(");\n");
+    out->Print(")));\n");
   } else {
-    out->Print(vars, "$client_name$.prototype.$method_name$ = function $method_name$(message, metadata) {\n");
+    out->Print(vars, "$client_name$.prototype.$function_name$ = function $function_name$(message, metadata) {\n");
     out->Indent();
+    if (!elements) {
+      PrintLocalCall(method, vars, out);
+    }
+    PrintPhases(method, params, out);
     if (method->server_streaming()) {
       out->Print("const map = {};\n");
-      out->Print(vars, "return this.$method_name$Metrics(\n");
+      out->Print(vars, "return rsocket_rpc_core.withAsyncIterator(this.$method_name$Flow(this.$method_name$Metrics(\n");
       out->Indent();
       out->Print(vars, "this.$method_name$Trace(map)(new rsocket_flowable.Flowable(subscriber => {\n");
       out->Indent();
-      out->Print(vars, "var dataBuf = Buffer.from(message.serializeBinary());\n");
-      out->Print(vars, "var tracingMetadata = rsocket_rpc_tracing.mapToBuffer(map);\n");
-      out->Print(vars, "var metadataBuf = rsocket_rpc_frames.encodeMetadata('$service_name$', '$name$', tracingMetadata, metadata || Buffer.alloc(0));\n");
+      PrintEncode(params, "var ", out);
+      PrintRoutingMetadata(vars, out);
+      out->Print(vars, "var sizes = this.$method_name$Sizes;\n");
+      out->Print("sizes.request(dataBuf, metadataBuf);\n");
+      PrintHandlerStart(params, out);
       out->Indent();
-      out->Print("this._rs.requestStream({\n");
+      if (IsCompressed(method)) {
+        out->Print(vars, "this.$method_name$Compression.requestStream({\n");
+      } else {
+        out->Print("this._rs.requestStream({\n");
+      }
       out->Indent();
       out->Print(
           "data: dataBuf,\n"
           "metadata: metadataBuf\n");
       out->Outdent();
-      out->Print("}).map(function (payload) {\n");
+      if (IsCompressed(method)) {
+        out->Print(vars, "}, payload => this._rs.requestStream(payload))$unpack$.map(function (payload) {\n");
+      } else {
+        out->Print(vars, "})$unpack$.map(function (payload) {\n");
+      }
       out->Indent();
       out->Print("//TODO: resolve either 'https://github.com/rsocket/rsocket-js/issues/19' or 'https://github.com/google/protobuf/issues/1319'\n");
       out->Print("var binary = !payload.data || payload.data.constructor === Buffer || payload.data.constructor === Uint8Array ? payload.data : new Uint8Array(payload.data);\n");
-      out->Print(vars, "return $output_type$.deserializeBinary(binary);\n");
+      out->Print("sizes.response(binary, payload.metadata);\n");
+      PrintHandled(params, out);
+      PrintDecode(params, vars["output_type"], out);
       out->Outdent();
       out->Print("}).subscribe(subscriber);\n");
       out->Outdent();
@@ -195,16 +603,16 @@ void PrintMethod(const MethodDescriptor* method, Printer* out) {
       out->Outdent();
       out->Print(")\n");
       out->Outdent();
-      out->Print(");\n");
+      out->Print(")));\n");
     } else if (options.fire_and_forget()) {
       out->Print("const map = {};\n");
       out->Print(vars, "this.$method_name$Metrics(new rsocket_flowable.Single(subscriber => {\n");
       out->Indent();
       out->Print(vars, "this.$method_name$Trace(map)(new rsocket_flowable.Single(innerSub => {\n");
       out->Indent();
-      out->Print(vars, "var dataBuf = Buffer.from(message.serializeBinary());\n");
-      out->Print(vars, "var tracingMetadata = rsocket_rpc_tracing.mapToBuffer(map);\n");
-      out->Print(vars, "var metadataBuf = rsocket_rpc_frames.encodeMetadata('$service_name$', '$name$', tracingMetadata, metadata || Buffer.alloc(0));\n");
+      PrintEncode(params, "var ", out);
+      PrintRoutingMetadata(vars, out);
+      out->Print(vars, "this.$method_name$Sizes.request(dataBuf, metadataBuf);\n");
       out->Print("this._rs.fireAndForget({\n");
       out->Indent();
       out->Print(
@@ -221,25 +629,82 @@ void PrintMethod(const MethodDescriptor* method, Printer* out) {
 
     } else {
       out->Print("const map = {};\n");
+      if (options.cacheable()) {
+        // Cache hits skip the socket, but are still timed and traced as calls
+        PrintEncode(params, "var ", out);
+        if (CacheKeyMetadata(method).empty()) {
+          out->Print("var cacheKey = rsocket_rpc_core.requestKey(dataBuf, metadata);\n");
+        } else {
+          out->Print(vars, "var cacheKey = rsocket_rpc_core.requestKey(dataBuf, metadata, this.$method_name$CacheKeyMetadata);\n");
+        }
+        out->Print(vars, "var cached = this.$method_name$Cache.get(cacheKey);\n");
+        out->Print("if (cached) {\n");
+        out->Indent();
+        out->Print(vars, "return this.$method_name$Metrics(\n");
+        out->Indent();
+        out->Print(vars, "this.$method_name$Trace(map)(rsocket_flowable.Single.of($output_type$.deserializeBinary(cached)))\n");
+        out->Outdent();
+        out->Print(");\n");
+        out->Outdent();
+        out->Print("}\n");
+      }
       out->Print(vars, "return this.$method_name$Metrics(\n");
       out->Indent();
       out->Print(vars, "this.$method_name$Trace(map)(new rsocket_flowable.Single(subscriber => {\n");
       out->Indent();
-      out->Print(vars, "var dataBuf = Buffer.from(message.serializeBinary());\n");
-      out->Print(vars, "var tracingMetadata = rsocket_rpc_tracing.mapToBuffer(map);\n");
-      out->Print(vars, "var metadataBuf = rsocket_rpc_frames.encodeMetadata('$service_name$', '$name$', tracingMetadata, metadata || Buffer.alloc(0));\n");
+      if (!options.cacheable()) {
+        PrintEncode(params, "var ", out);
+      }
+      PrintRoutingMetadata(vars, out);
+      out->Print(vars, "var sizes = this.$method_name$Sizes;\n");
+      out->Print("sizes.request(dataBuf, metadataBuf);\n");
+      if (options.single_flight() && !options.cacheable()) {
+        out->Print("var flightKey = rsocket_rpc_core.requestKey(dataBuf, metadata);\n");
+      }
+      PrintHandlerStart(params, out);
+      // Wrap the socket call from the inside out: compression, hedging, then
+      // sharing
+      string request_prefix = "this._rs.requestResponse({\n";
+      string request_suffix = "})";
+      if (IsCompressed(method)) {
+        request_prefix = "this.$method_name$Compression.requestResponse({\n";
+        request_suffix = "}, payload => this._rs.requestResponse(payload))";
+      }
+      if (options.idempotent()) {
+        // Each attempt is timed, and gets a view of the socket that sends the
+        // hedge to another connection of a pool
+        if (IsCompressed(method)) {
+          request_suffix = "}, payload => rs.requestResponse(payload))";
+        } else {
+          request_prefix = "rs.requestResponse({\n";
+        }
+        request_prefix = "rsocket_rpc_core.hedgeSingle(rs => this.$method_name$AttemptMetrics(" + request_prefix;
+        request_suffix += "), this.$method_name$HedgeDelay, this._rs)";
+      }
+      if (options.single_flight()) {
+        vars["flight_key"] = options.cacheable() ? "cacheKey" : "flightKey";
+        request_prefix = "this.$method_name$Flights.share($flight_key$, () => " + request_prefix;
+        request_suffix += ")";
+      }
       out->Indent();
-      out->Print("this._rs.requestResponse({\n");
+      out->Print(vars, request_prefix.c_str());
       out->Indent();
       out->Print(
           "data: dataBuf,\n"
           "metadata: metadataBuf\n");
       out->Outdent();
-      out->Print("}).map(function (payload) {\n");
+      // The cache is reached through `this`, so its callback must be an arrow
+      vars["map_callback"] = options.cacheable() ? "payload =>" : "function (payload)";
+      out->Print(vars, (request_suffix + ".map($map_callback$ {\n").c_str());
       out->Indent();
       out->Print("//TODO: resolve either 'https://github.com/rsocket/rsocket-js/issues/19' or 'https://github.com/google/protobuf/issues/1319'\n");
       out->Print("var binary = !payload.data || payload.data.constructor === Buffer || payload.data.constructor === Uint8Array ? payload.data : new Uint8Array(payload.data);\n");
-      out->Print(vars, "return $output_type$.deserializeBinary(binary);\n");
+      out->Print("sizes.response(binary, payload.metadata);\n");
+      PrintHandled(params, out);
+      if (options.cacheable()) {
+        out->Print(vars, "this.$method_name$Cache.put(cacheKey, binary);\n");
+      }
+      PrintDecode(params, vars["output_type"], out);
       out->Outdent();
       out->Print("}).subscribe(subscriber);\n");
       out->Outdent();
@@ -255,15 +720,39 @@ void PrintMethod(const MethodDescriptor* method, Printer* out) {
   out->Print("};\n");
 }
 
-void PrintClient(const ServiceDescriptor* service, Printer* out) {
+// Prints the meter tags of each method, converted once when the module loads
+// so that every client or server instance shares the same interned meters
+void PrintMeterTags(const ServiceDescriptor* service, const string& role, Printer* out) {
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    std::map<string, string> vars;
+    vars["service_name"] = service->full_name();
+    vars["method_name"] = LowercaseFirstLetter(method->name());
+    vars["role"] = role;
+    out->Print(vars, "var $method_name$MeterTags = rsocket_rpc_metrics.tags({\"service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"role\": \"$role$\"});\n");
+    const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+    if (role == "client" && options.cacheable() && !options.fire_and_forget() &&
+        !method->client_streaming() && !method->server_streaming()) {
+      out->Print(vars, "var $method_name$CacheHitTags = rsocket_rpc_metrics.tags({\"service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"role\": \"$role$\"}, {\"result\": \"hit\"});\n");
+      out->Print(vars, "var $method_name$CacheMissTags = rsocket_rpc_metrics.tags({\"service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"role\": \"$role$\"}, {\"result\": \"miss\"});\n");
+    }
+  }
+}
+
+// Prints a client. Given a RateLimiter, whose responder takes the rate hints
+// servers push on the connection, the client calls through the socket the
+// limiter wraps; the hints never reach generated servers, whose metadataPush
+// is not implemented.
+void PrintClient(const ServiceDescriptor* service, const Parameters& params, Printer* out) {
   std::map<string, string> vars;
   out->Print(GetNodeComments(service, true).c_str());
   vars["client_name"] = service->name() + "Client";
   out->Print(vars, "var $client_name$ = function () {\n");
   out->Indent();
-  out->Print(vars, "function $client_name$(rs, tracer, meterRegistry) {\n");
+  PrintMeterTags(service, "client", out);
+  out->Print(vars, "function $client_name$(rs, tracer, meterRegistry, limiter) {\n");
   out->Indent();
-  out->Print("this._rs = rs;\n");
+  out->Print("this._rs = limiter ? limiter.wrap(rs) : rs;\n");
   out->Print("this._tracer = tracer;\n");
 
   //Set up trace things
@@ -276,22 +765,52 @@ void PrintClient(const ServiceDescriptor* service, Printer* out) {
       vars["method_name"] = LowercaseFirstLetter(method->name());
       vars["name"] = method->name();
       vars["output_type"] = NodeObjectPath(output_type);
+      const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
       if(method->client_streaming() ||
          method->server_streaming()){
          out->Print(vars, "this.$method_name$Trace = rsocket_rpc_tracing.trace(tracer, \"$service_short_name$\", {\"rsocket.rpc.service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"rsocket.rpc.role\": \"client\"});\n");
-         out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timed(meterRegistry, \"$service_short_name$\", {\"service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"role\": \"client\"});\n");
+         out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timed(meterRegistry, \"$service_short_name$\", $method_name$MeterTags);\n");
+         PrintFlowControl(method, out);
       } else {
         out->Print(vars, "this.$method_name$Trace = rsocket_rpc_tracing.traceSingle(tracer, \"$service_short_name$\", {\"rsocket.rpc.service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"rsocket.rpc.role\": \"client\"});\n");
-        out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timedSingle(meterRegistry, \"$service_short_name$\", {\"service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"role\": \"client\"});\n");
+        out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timedSingle(meterRegistry, \"$service_short_name$\", $method_name$MeterTags);\n");
+        if (options.idempotent() && !options.fire_and_forget()) {
+          // Hedge once a call has taken longer than the p95 latency of single
+          // attempts, which hedging does not cut short
+          vars["hedge_after_ms"] = std::to_string(options.hedge_after_ms());
+          out->Print(vars, "this.$method_name$AttemptMetrics = rsocket_rpc_metrics.timedAttempt(meterRegistry, \"$service_short_name$\", $method_name$MeterTags);\n");
+          out->Print(vars, "this.$method_name$HedgeDelay = rsocket_rpc_metrics.latencyPercentile(this.$method_name$AttemptMetrics, 0.95, $hedge_after_ms$);\n");
+        }
+        if (options.single_flight() && !options.fire_and_forget()) {
+          out->Print(vars, "this.$method_name$Flights = new rsocket_rpc_core.SingleFlight();\n");
+        }
+        if (options.cacheable() && !options.fire_and_forget()) {
+          vars["cache_max_entries"] = std::to_string(options.cache_max_entries() > 0 ? options.cache_max_entries() : 1024);
+          vars["cache_ttl_ms"] = std::to_string(options.cache_ttl_ms());
+          out->Print(vars, "this.$method_name$Cache = new rsocket_rpc_core.ResponseCache($cache_max_entries$, $cache_ttl_ms$, "
+                           "rsocket_rpc_metrics.counter(meterRegistry, \"$service_short_name$.cache\", \"cache hits\", $method_name$CacheHitTags), "
+                           "rsocket_rpc_metrics.counter(meterRegistry, \"$service_short_name$.cache\", \"cache misses\", $method_name$CacheMissTags));\n");
+          if (!CacheKeyMetadata(method).empty()) {
+            vars["cache_key_metadata"] = CacheKeyMetadata(method);
+            out->Print(vars, "this.$method_name$CacheKeyMetadata = $cache_key_metadata$;\n");
+          }
+        }
       }
+      PrintPayloadSizes(method, out);
+      PrintPhaseTimers(method, params, out);
+      PrintCompression(method, out);
   }
   out->Outdent();
   out->Print("}\n");
 
   for (int i = 0; i < service->method_count(); i++) {
     out->Print(GetNodeComments(service->method(i), true).c_str());
-    PrintMethod(service->method(i), out);
+    PrintMethod(service->method(i), params, out);
     out->Print(GetNodeComments(service->method(i), false).c_str());
+    std::vector<const FieldDescriptor*> fields = ElementFields(service->method(i));
+    for (size_t j = 0; j < fields.size(); j++) {
+      PrintMethod(service->method(i), params, out, fields[j]);
+    }
   }
 
   out->Print(vars, "return $client_name$;\n");
@@ -301,7 +820,110 @@ void PrintClient(const ServiceDescriptor* service, Printer* out) {
   out->Print(GetNodeComments(service, false).c_str());
 }
 
-void PrintServer(const ServiceDescriptor* service, Printer* out) {
+// Prints the entry point of calls from generated clients in the same process,
+// which skip serialization but are timed and traced like any other. Offloaded
+// methods still serialize their messages for the server's WorkerPool.
+void PrintLocalServer(const ServiceDescriptor* service, Printer* out) {
+  std::map<string, string> vars;
+  vars["server_name"] = service->name() + "Server";
+  out->Print(vars, "$server_name$.prototype.handleLocal = function handleLocal(method, message, metadata) {\n");
+  out->Indent();
+  out->Print("var spanContext = rsocket_rpc_tracing.deserializeTraceData(this._tracer, metadata);\n");
+  out->Print("switch (method) {\n");
+  out->Indent();
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+    vars["method_name"] = LowercaseFirstLetter(method->name());
+    vars["name"] = method->name();
+    vars["output_type"] = NodeObjectPath(method->output_type());
+    out->Print(vars, "case '$name$':\n");
+    out->Indent();
+    if (method->client_streaming() || method->server_streaming()) {
+      vars["request"] = method->client_streaming()
+          ? "rsocket_rpc_core.withAsyncIterator(this." + vars["method_name"] + "RequestFlow(message))"
+          : "message";
+      out->Print(vars, "return this.$method_name$Flow(this.$method_name$Metrics(\n");
+      out->Indent();
+      out->Print(vars, "this.$method_name$Trace(spanContext)(new rsocket_flowable.Flowable(subscriber => {\n");
+      out->Indent();
+      out->Print(vars, "rsocket_rpc_core.toFlowable(this._service.$method_name$($request$, metadata)).subscribe(subscriber);\n");
+      out->Outdent();
+      out->Print("}))\n");
+      out->Outdent();
+      out->Print("));\n");
+    } else if (options.fire_and_forget()) {
+      out->Print(vars, "this.$method_name$Metrics(\n");
+      out->Indent();
+      out->Print(vars, "this.$method_name$Trace(spanContext)(new rsocket_flowable.Single(subscriber => {\n");
+      out->Indent();
+      if (IsOffloaded(method)) {
+        out->Print("if (this._workers) {\n");
+        out->Indent();
+        PrintRunOffloadedLocal(method, out);
+        out->Print(".subscribe({ onComplete: function onComplete() {}, onError: function onError() {} });\n");
+        out->Outdent();
+        out->Print("} else {\n");
+        out->Indent();
+      }
+      out->Print(vars, "this._service.$method_name$(message, metadata);\n");
+      if (IsOffloaded(method)) {
+        out->Outdent();
+        out->Print("}\n");
+      }
+      out->Print("subscriber.onSubscribe();\n");
+      out->Print("subscriber.onComplete();\n");
+      out->Outdent();
+      out->Print("}))\n");
+      out->Outdent();
+      out->Print(").subscribe({ onSubscribe: function onSubscribe() {}, onComplete: function onComplete() {} });\n");
+      out->Print("return;\n");
+    } else {
+      out->Print(vars, "return this.$method_name$Metrics(\n");
+      out->Indent();
+      out->Print(vars, "this.$method_name$Trace(spanContext)(new rsocket_flowable.Single(subscriber => {\n");
+      out->Indent();
+      if (IsOffloaded(method)) {
+        // The worker gets the message serialized, as calls over the network
+        out->Print("if (this._workers) {\n");
+        out->Indent();
+        PrintRunOffloadedLocal(method, out);
+        out->Print("\n");
+        out->Indent();
+        out->Print(".map(function (dataBuf) {\n");
+        out->Indent();
+        out->Print(vars, "return $output_type$.deserializeBinary(dataBuf);\n");
+        out->Outdent();
+        out->Print("})\n");
+        out->Print(".subscribe(subscriber);\n");
+        out->Outdent();
+        out->Outdent();
+        out->Print("} else {\n");
+        out->Indent();
+      }
+      out->Print(vars, "this._service.$method_name$(message, metadata).subscribe(subscriber);\n");
+      if (IsOffloaded(method)) {
+        out->Outdent();
+        out->Print("}\n");
+      }
+      out->Outdent();
+      out->Print("}))\n");
+      out->Outdent();
+      out->Print(");\n");
+    }
+    out->Outdent();
+  }
+  out->Print("default:\n");
+  out->Indent();
+  out->Print("throw new Error('unknown method');\n");
+  out->Outdent();
+  out->Outdent();
+  out->Print("}\n");
+  out->Outdent();
+  out->Print("};\n");
+}
+
+void PrintServer(const ServiceDescriptor* service, const Parameters& params, Printer* out) {
 
   std::map<string, string> vars;
 
@@ -334,10 +956,19 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
   vars["server_name"] = service->name() + "Server";
   out->Print(vars, "var $server_name$ = function () {\n");
   out->Indent();
-  out->Print(vars, "function $server_name$(service, tracer, meterRegistry) {\n");
-  out->Indent();
-  out->Print("this._service = service;\n");
-  out->Print("this._tracer = tracer;\n");
+  PrintMeterTags(service, "server", out);
+  if (HasOffloaded(service)) {
+    out->Print(vars, "function $server_name$(service, tracer, meterRegistry, workers) {\n");
+    out->Indent();
+    out->Print("this._service = service;\n");
+    out->Print("this._tracer = tracer;\n");
+    out->Print("this._workers = workers;\n");
+  } else {
+    out->Print(vars, "function $server_name$(service, tracer, meterRegistry) {\n");
+    out->Indent();
+    out->Print("this._service = service;\n");
+    out->Print("this._tracer = tracer;\n");
+  }
 
   for (int i = 0; i < service->method_count(); i++) {
         const MethodDescriptor* method = service->method(i);
@@ -351,13 +982,26 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
         if(method->client_streaming() ||
            method->server_streaming()){
            out->Print(vars, "this.$method_name$Trace = rsocket_rpc_tracing.traceAsChild(tracer, \"$service_short_name$\", {\"rsocket.rpc.service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"rsocket.rpc.role\": \"server\"});\n");
-           out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timed(meterRegistry, \"$service_short_name$\", {\"service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"role\": \"server\"});\n");
+           out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timed(meterRegistry, \"$service_short_name$\", $method_name$MeterTags);\n");
+           PrintFlowControl(method, out);
         } else {
           out->Print(vars, "this.$method_name$Trace = rsocket_rpc_tracing.traceSingleAsChild(tracer, \"$service_short_name$\", {\"rsocket.rpc.service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"rsocket.rpc.role\": \"server\"});\n");
-          out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timedSingle(meterRegistry, \"$service_short_name$\", {\"service\": \"$service_name$\"}, {\"method\": \"$method_name$\"}, {\"role\": \"server\"});\n");
+          out->Print(vars, "this.$method_name$Metrics = rsocket_rpc_metrics.timedSingle(meterRegistry, \"$service_short_name$\", $method_name$MeterTags);\n");
         }
+        PrintPayloadSizes(method, out);
+        PrintPhaseTimers(method, params, out);
+        PrintPack(method, out);
+        PrintChunk(method, out);
+        PrintCompression(method, out);
   }
-  out->Print("this._channelSwitch = (payload, restOfMessages) => {\n");
+  out->Outdent();
+  out->Print("}\n");
+
+  PrintPriorities(service, out);
+
+  // Routes a channel on its first payload, which RequestHandlingRSocket has
+  // already peeked, so that it reaches the method without another switch
+  out->Print(vars, "$server_name$.prototype.handleChannel = function handleChannel(payload, restOfMessages) {\n");
   out->Indent();
   out->Print("if (payload.metadata == null) {\n");
   out->Indent();
@@ -375,36 +1019,57 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
         vars["method_name"] = LowercaseFirstLetter(method->name());
         vars["name"] = method->name();
         vars["input_type"] = NodeObjectPath(input_type);
+        vars["pack"] = ResponseLift(method);
 
         out->Print(vars, "case '$name$':\n");
         out->Indent();
-        out->Print("deserializedMessages = restOfMessages.map(payload => {\n");
+        out->Print(vars, "var sizes = this.$method_name$Sizes;\n");
+        PrintPhases(method, params, out);
+        if (IsCompressed(method)) {
+          out->Print(vars, "deserializedMessages = this.$method_name$Compression.decompressPayloads(restOfMessages).map(payload => {\n");
+        } else {
+          out->Print("deserializedMessages = restOfMessages.map(payload => {\n");
+        }
         out->Indent();
         out->Print("var binary = !payload.data || payload.data.constructor === Buffer || payload.data.constructor === Uint8Array ? payload.data : new Uint8Array(payload.data);\n");
-        out->Print(vars, "return $input_type$.deserializeBinary(binary);\n");
+        out->Print("sizes.request(binary, payload.metadata);\n");
+        PrintDecode(params, vars["input_type"], out);
         out->Outdent();
         out->Print("});\n");
-        out->Print(vars, "return this.$method_name$Metrics(\n");
+        PrintHandlerStart(params, out);
+        out->Print(vars, "return this.$method_name$Flow(this.$method_name$Metrics(\n");
         out->Indent();
         out->Print(vars, "this.$method_name$Trace(spanContext)(\n");
         out->Indent();
-        out->Print("this._service\n");
+        if (IsCompressed(method)) {
+          out->Print(vars, "this.$method_name$Compression.compressResponses(payload,\n");
+          out->Indent();
+        }
+        // Handlers may also be async generators, iterating their requests
+        out->Print("rsocket_rpc_core.toFlowable(this._service\n");
         out->Indent();
-        out->Print(vars, ".$method_name$(deserializedMessages, payload.metadata)\n");
+        out->Print(vars, ".$method_name$(rsocket_rpc_core.withAsyncIterator(deserializedMessages), payload.metadata))\n");
         out->Print(".map(function (message) {\n");
         out->Indent();
+        PrintHandled(params, out);
+        PrintEncode(params, "var ", out);
+        out->Print("sizes.response(dataBuf);\n");
         out->Print("return {\n");
         out->Indent();
-        out->Print("data: Buffer.from(message.serializeBinary()),\n");
+        out->Print("data: dataBuf,\n");
         out->Print("metadata: Buffer.alloc(0)\n");
         out->Outdent();
         out->Print("}\n");
         out->Outdent();
-        out->Print("})\n");
+        out->Print(vars, "})$pack$\n");
         out->Outdent();
+        if (IsCompressed(method)) {
+          out->Print(")\n");
+          out->Outdent();
+        }
         out->Print(")\n");
         out->Outdent();
-        out->Print(");\n");
+        out->Print("));\n");
         out->Outdent();
         out->Outdent();
       }
@@ -417,9 +1082,6 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
   out->Outdent();
   out->Print("};\n");
 
-  out->Outdent();
-  out->Print("}\n");
-
   // Fire and forget
   out->Print(vars, "$server_name$.prototype.fireAndForget = function fireAndForget(payload) {\n");
   out->Indent();
@@ -444,12 +1106,28 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
 
       out->Print(vars, "case '$name$':\n");
       out->Indent();
+      PrintPhases(method, params, out);
       out->Print(vars, "this.$method_name$Metrics(new rsocket_flowable.Single(subscriber => {\n");
       out->Indent();
       out->Print(vars, "this.$method_name$Trace(spanContext)(new rsocket_flowable.Single(innerSub => {\n");
       out->Indent();
       out->Print("var binary = !payload.data || payload.data.constructor === Buffer || payload.data.constructor === Uint8Array ? payload.data : new Uint8Array(payload.data);\n");
-      out->Print(vars, "this._service.$method_name$($input_type$.deserializeBinary(binary), payload.metadata);\n");
+      out->Print(vars, "this.$method_name$Sizes.request(binary, payload.metadata);\n");
+      if (IsOffloaded(method)) {
+        out->Print("if (this._workers) {\n");
+        out->Indent();
+        PrintRunOffloaded(method, out);
+        out->Print(".subscribe({ onComplete: function onComplete() {}, onError: function onError() {} });\n");
+        out->Outdent();
+        out->Print("} else {\n");
+        out->Indent();
+      }
+      vars["request"] = PrintDecodeRequest(params, vars["input_type"], out);
+      out->Print(vars, "this._service.$method_name$($request$, payload.metadata);\n");
+      if (IsOffloaded(method)) {
+        out->Outdent();
+        out->Print("}\n");
+      }
       out->Print("innerSub.onSubscribe();\n");
       out->Print("innerSub.onComplete();\n");
       out->Outdent();
@@ -499,21 +1177,63 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
       out->Indent();
       out->Print(vars, "this.$method_name$Trace(spanContext)(new rsocket_flowable.Single(subscriber => {\n");
       out->Indent();
+      out->Print(vars, "var sizes = this.$method_name$Sizes;\n");
+      PrintPhases(method, params, out);
+      if (IsCompressed(method)) {
+        out->Print(vars, "return this.$method_name$Compression.handleRequestResponse(payload, payload => {\n");
+        out->Indent();
+      }
       out->Print("var binary = !payload.data || payload.data.constructor === Buffer || payload.data.constructor === Uint8Array ? payload.data : new Uint8Array(payload.data);\n");
+      out->Print("sizes.request(binary, payload.metadata);\n");
+      if (IsOffloaded(method)) {
+        // Decoding, handling and encoding all happen on the worker
+        out->Print("if (this._workers) {\n");
+        out->Indent();
+        out->Print("return ");
+        PrintRunOffloaded(method, out);
+        out->Print("\n");
+        out->Indent();
+        out->Print(".map(function (dataBuf) {\n");
+        out->Indent();
+        out->Print("sizes.response(dataBuf);\n");
+        out->Print("return {\n");
+        out->Indent();
+        out->Print("data: dataBuf,\n");
+        out->Print("metadata: Buffer.alloc(0)\n");
+        out->Outdent();
+        out->Print("}\n");
+        out->Outdent();
+        out->Print(IsCompressed(method) ? "});\n" : "}).subscribe(subscriber);\n");
+        out->Outdent();
+        out->Outdent();
+        out->Print("}\n");
+      }
+      vars["request"] = PrintDecodeRequest(params, vars["input_type"], out);
+      PrintHandlerStart(params, out);
       out->Print("return this._service\n");
       out->Indent();
-      out->Print(vars, ".$method_name$($input_type$.deserializeBinary(binary), payload.metadata)\n");
+      out->Print(vars, ".$method_name$($request$, payload.metadata)\n");
       out->Print(".map(function (message) {\n");
       out->Indent();
+      PrintHandled(params, out);
+      PrintEncode(params, "var ", out);
+      out->Print("sizes.response(dataBuf);\n");
       out->Print("return {\n");
       out->Indent();
-      out->Print("data: Buffer.from(message.serializeBinary()),\n");
+      out->Print("data: dataBuf,\n");
       out->Print("metadata: Buffer.alloc(0)\n");
       out->Outdent();
       out->Print("}\n");
       out->Outdent();
-      out->Print("}).subscribe(subscriber);\n");
-      out->Outdent();
+      if (IsCompressed(method)) {
+        out->Print("});\n");
+        out->Outdent();
+        out->Outdent();
+        out->Print("}).subscribe(subscriber);\n");
+      } else {
+        out->Print("}).subscribe(subscriber);\n");
+        out->Outdent();
+      }
       out->Print("}\n");
       out->Outdent();
       out->Print(")\n");
@@ -562,35 +1282,57 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
       vars["method_name"] = LowercaseFirstLetter(method->name());
       vars["name"] = method->name();
       vars["input_type"] = NodeObjectPath(input_type);
+      vars["pack"] = ResponseLift(method);
 
       out->Print(vars, "case '$name$':\n");
       out->Indent();
-      out->Print(vars, "return this.$method_name$Metrics(\n");
+      out->Print(vars, "return this.$method_name$Flow(this.$method_name$Metrics(\n");
       out->Indent();
       out->Print(vars, "this.$method_name$Trace(spanContext)(new rsocket_flowable.Flowable(subscriber => {\n");
       out->Indent();
+      out->Print(vars, "var sizes = this.$method_name$Sizes;\n");
+      PrintPhases(method, params, out);
+      if (IsCompressed(method)) {
+        out->Print(vars, "return this.$method_name$Compression.handleRequestStream(payload, payload => {\n");
+        out->Indent();
+      }
       out->Print("var binary = !payload.data || payload.data.constructor === Buffer || payload.data.constructor === Uint8Array ? payload.data : new Uint8Array(payload.data);\n");
-      out->Print("return this._service\n");
+      out->Print("sizes.request(binary, payload.metadata);\n");
+      vars["request"] = PrintDecodeRequest(params, vars["input_type"], out);
+      PrintHandlerStart(params, out);
+      // Handlers may also be async generators, pulled as responses are
+      // requested
+      out->Print("return rsocket_rpc_core.toFlowable(this._service\n");
       out->Indent();
-      out->Print(vars, ".$method_name$($input_type$.deserializeBinary(binary), payload.metadata)\n");
+      out->Print(vars, ".$method_name$($request$, payload.metadata))\n");
       out->Print(".map(function (message) {\n");
       out->Indent();
+      PrintHandled(params, out);
+      PrintEncode(params, "var ", out);
+      out->Print("sizes.response(dataBuf);\n");
       out->Print("return {\n");
       out->Indent();
-      out->Print("data: Buffer.from(message.serializeBinary()),\n");
+      out->Print("data: dataBuf,\n");
       out->Print("metadata: Buffer.alloc(0)\n");
       out->Outdent();
       out->Print("}\n");
       out->Outdent();
-      out->Print("}).subscribe(subscriber);\n");
-      out->Outdent();
+      if (IsCompressed(method)) {
+        out->Print(vars, "})$pack$;\n");
+        out->Outdent();
+        out->Outdent();
+        out->Print("}).subscribe(subscriber);\n");
+      } else {
+        out->Print(vars, "})$pack$.subscribe(subscriber);\n");
+        out->Outdent();
+      }
       out->Print("}\n");
       out->Outdent();
       out->Print(")\n");
       out->Outdent();
       out->Print(")\n");
       out->Outdent();
-      out->Print(");\n");
+      out->Print("));\n");
     }
     out->Print("default:\n");
     out->Indent();
@@ -609,17 +1351,42 @@ void PrintServer(const ServiceDescriptor* service, Printer* out) {
   out->Outdent();
   out->Print("};\n");
 
+  // Tracks the requests of a channel from its first payload on, which the
+  // SwitchTransformOperator routing the channel holds until requested
+  out->Print(vars, "$server_name$.prototype.channelFlow = function channelFlow(payload) {\n");
+  out->Indent();
+  out->Print("switch (payload.metadata == null ? null : rsocket_rpc_frames.getMethod(payload.metadata)) {\n");
+  out->Indent();
+  for (vector<const MethodDescriptor*>::iterator it = request_channel.begin(); it != request_channel.end(); ++it) {
+    vars["method_name"] = LowercaseFirstLetter((*it)->name());
+    vars["name"] = (*it)->name();
+    out->Print(vars, "case '$name$':\n");
+    out->Indent();
+    out->Print(vars, "return rsocket_rpc_metrics.streamFlow(this.$method_name$RequestFlow);\n");
+    out->Outdent();
+  }
+  out->Print("default:\n");
+  out->Indent();
+  out->Print("return null;\n");
+  out->Outdent();
+  out->Outdent();
+  out->Print("}\n");
+  out->Outdent();
+  out->Print("};\n");
+
   // Request-Channel
   out->Print(vars, "$server_name$.prototype.requestChannel = function requestChannel(payloads) {\n");
   out->Indent();
-  out->Print("return new rsocket_flowable.Flowable(s => payloads.subscribe(s)).lift(s =>\n");
+  out->Print("return payloads.lift(s =>\n");
   out->Indent();
-  out->Print("new rsocket_rpc_core.SwitchTransformOperator(s, (payload, flowable) => this._channelSwitch(payload, flowable)),\n");
+  out->Print("new rsocket_rpc_core.SwitchTransformOperator(s, (payload, flowable) => this.handleChannel(payload, flowable), payload => this.channelFlow(payload)),\n");
   out->Outdent();
   out->Print(");\n");
   out->Outdent();
   out->Print("};\n");
 
+  PrintLocalServer(service, out);
+
   // Metadata-Push
   out->Print(vars, "$server_name$.prototype.metadataPush = function metadataPush(payload) {\n");
   out->Indent();
@@ -662,20 +1429,98 @@ void PrintImports(const FileDescriptor* file, Printer* out) {
   out->Print("\n");
 }
 
-void PrintClients(const FileDescriptor* file, Printer* out) {
+void PrintClients(const FileDescriptor* file, const Parameters& params, Printer* out) {
   for (int i = 0; i < file->service_count(); i++) {
-    PrintClient(file->service(i), out);
+    PrintClient(file->service(i), params, out);
   }
 }
 
-void PrintServers(const FileDescriptor* file, Printer* out) {
+// Prints what serves the offloaded methods of a service on the workers of a
+// WorkerPool, given to rsocket_rpc_core.serveOffloaded() in the worker's file
+void PrintWorker(const ServiceDescriptor* service, Printer* out) {
+  std::map<string, string> vars;
+  vars["worker_name"] = service->name() + "Worker";
+  vars["service_name"] = service->full_name();
+  out->Print(vars, "var $worker_name$ = function () {\n");
+  out->Indent();
+  out->Print(vars, "function $worker_name$(service) {\n");
+  out->Indent();
+  out->Print("this._service = service;\n");
+  out->Print(vars, "this.service = '$service_name$';\n");
+  out->Outdent();
+  out->Print("}\n");
+  out->Print(vars, "$worker_name$.prototype.handleOffloaded = function handleOffloaded(method, binary, metadata) {\n");
+  out->Indent();
+  out->Print("switch (method) {\n");
+  out->Indent();
+  for (int i = 0; i < service->method_count(); i++) {
+    const MethodDescriptor* method = service->method(i);
+    if (!IsOffloaded(method)) {
+      continue;
+    }
+    const RSocketMethodOptions options = method->options().GetExtension(io::rsocket::rpc::options);
+    vars["method_name"] = LowercaseFirstLetter(method->name());
+    vars["name"] = method->name();
+    vars["input_type"] = NodeObjectPath(method->input_type());
+    out->Print(vars, "case '$name$':\n");
+    out->Indent();
+    if (options.fire_and_forget()) {
+      out->Print(vars, "this._service.$method_name$($input_type$.deserializeBinary(binary), metadata);\n");
+      out->Print("return rsocket_flowable.Single.of(new Uint8Array(0));\n");
+    } else {
+      out->Print("return this._service\n");
+      out->Indent();
+      out->Print(vars, ".$method_name$($input_type$.deserializeBinary(binary), metadata)\n");
+      out->Print(".map(function (message) {\n");
+      out->Indent();
+      out->Print("return message.serializeBinary();\n");
+      out->Outdent();
+      out->Print("});\n");
+      out->Outdent();
+    }
+    out->Outdent();
+  }
+  out->Print("default:\n");
+  out->Indent();
+  out->Print("return rsocket_flowable.Single.error(new Error('unknown method'));\n");
+  out->Outdent();
+  out->Outdent();
+  out->Print("}\n");
+  out->Outdent();
+  out->Print("};\n");
+  out->Print(vars, "return $worker_name$;\n");
+  out->Outdent();
+  out->Print("}();\n\n");
+  out->Print(vars, "exports.$worker_name$ = $worker_name$;\n\n");
+}
+
+void PrintServers(const FileDescriptor* file, const Parameters& params, Printer* out) {
   for (int i = 0; i < file->service_count(); i++) {
-    PrintServer(file->service(i), out);
+    PrintServer(file->service(i), params, out);
+    if (HasOffloaded(file->service(i))) {
+      PrintWorker(file->service(i), out);
+    }
   }
 }
 }  // namespace
 
-string GenerateFile(const FileDescriptor* file) {
+bool CheckParameters(const FileDescriptor* file, const Parameters& params, string* error) {
+  for (int i = 0; i < file->service_count(); i++) {
+    const ServiceDescriptor* service = file->service(i);
+    for (int j = 0; j < service->method_count(); j++) {
+      // Version 1 headers carry no flags, so neither side could tell a
+      // compressed payload, or a peer that reads them
+      if (IsCompressed(service->method(j)) && params.metadata_version < 2) {
+        *error = "The compression option of " + service->method(j)->full_name() +
+                 " requires metadata_version=2";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+string GenerateFile(const FileDescriptor* file, const Parameters& params) {
   string output;
   {
     StringOutputStream output_stream(&output);
@@ -696,9 +1541,9 @@ string GenerateFile(const FileDescriptor* file) {
 
     PrintImports(file, &out);
 
-    PrintClients(file, &out);
+    PrintClients(file, params, &out);
 
-    PrintServers(file, &out);
+    PrintServers(file, params, &out);
 
     out.Print(GetNodeComments(file, false).c_str());
   }
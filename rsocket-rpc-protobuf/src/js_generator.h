@@ -27,7 +27,29 @@ using namespace std;
 
 namespace rsocket_rpc_js_generator {
 
-string GenerateFile(const google::protobuf::FileDescriptor* file);
+// Options passed to the plugin, e.g. --rsocket_rpc_out=metadata_version=2:out
+struct Parameters {
+  // Version of the routing metadata generated clients send: 1, or 2 for the
+  // compact encoding with interned service ids
+  int metadata_version;
+  // Whether generated code times the decode, handler and encode phases of
+  // each call with separate timers, e.g. phase_timing=true
+  bool phase_timing;
+  // Whether generated clients send the binary trace context, which servers
+  // only read from that version on, e.g. trace_context=binary
+  bool binary_trace_context;
+
+  Parameters()
+      : metadata_version(1), phase_timing(false), binary_trace_context(false) {}
+};
+
+// Checks that the options of the file's methods can be generated with
+// `params`, setting `error` when they can not
+bool CheckParameters(const google::protobuf::FileDescriptor* file,
+                     const Parameters& params, string* error);
+
+string GenerateFile(const google::protobuf::FileDescriptor* file,
+                    const Parameters& params);
 
 }  // namespace rsocket_rpc_js_generator
 
@@ -27,9 +27,13 @@
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <iostream>
+#include <utility>
+#include <vector>
 
+using rsocket_rpc_js_generator::CheckParameters;
 using rsocket_rpc_js_generator::GenerateFile;
 using rsocket_rpc_js_generator::GetJSServiceFilename;
+using rsocket_rpc_js_generator::Parameters;
 
 class RSocketRpcJsGenerator : public google::protobuf::compiler::CodeGenerator {
  public:
@@ -40,7 +44,31 @@ class RSocketRpcJsGenerator : public google::protobuf::compiler::CodeGenerator {
                 const string& parameter,
                 google::protobuf::compiler::GeneratorContext* context,
                 string* error) const {
-    string code = GenerateFile(file);
+    Parameters params;
+    std::vector<std::pair<string, string> > options;
+    google::protobuf::compiler::ParseGeneratorParameter(parameter, &options);
+    for (size_t i = 0; i < options.size(); i++) {
+      if (options[i].first == "metadata_version" &&
+          (options[i].second == "1" || options[i].second == "2")) {
+        params.metadata_version = std::stoi(options[i].second);
+      } else if (options[i].first == "phase_timing" &&
+                 (options[i].second == "" || options[i].second == "true" ||
+                  options[i].second == "false")) {
+        params.phase_timing = options[i].second != "false";
+      } else if (options[i].first == "trace_context" &&
+                 (options[i].second == "binary" || options[i].second == "map")) {
+        params.binary_trace_context = options[i].second == "binary";
+      } else {
+        *error = "Unknown or invalid generator option: " + options[i].first;
+        return false;
+      }
+    }
+
+    if (!CheckParameters(file, params, error)) {
+      return false;
+    }
+
+    string code = GenerateFile(file, params);
     if (code.size() == 0) {
       return true;
     }
@@ -20,11 +20,17 @@
 // @@protoc_insertion_point(includes)
 
 namespace protobuf_rsocket_2foptions_2eproto {
+extern PROTOBUF_INTERNAL_EXPORT_protobuf_rsocket_2foptions_2eproto ::google::protobuf::internal::SCCInfo<0> scc_info_RSocketServiceOptions;
 extern PROTOBUF_INTERNAL_EXPORT_protobuf_rsocket_2foptions_2eproto ::google::protobuf::internal::SCCInfo<0> scc_info_RSocketMethodOptions;
 }  // namespace protobuf_rsocket_2foptions_2eproto
 namespace io {
 namespace rsocket {
 namespace rpc {
+class RSocketServiceOptionsDefaultTypeInternal {
+ public:
+  ::google::protobuf::internal::ExplicitlyConstructed<RSocketServiceOptions>
+      _instance;
+} _RSocketServiceOptions_default_instance_;
 class RSocketMethodOptionsDefaultTypeInternal {
  public:
   ::google::protobuf::internal::ExplicitlyConstructed<RSocketMethodOptions>
@@ -34,6 +40,20 @@ class RSocketMethodOptionsDefaultTypeInternal {
 }  // namespace rsocket
 }  // namespace io
 namespace protobuf_rsocket_2foptions_2eproto {
+static void InitDefaultsRSocketServiceOptions() {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+  {
+    void* ptr = &::io::rsocket::rpc::_RSocketServiceOptions_default_instance_;
+    new (ptr) ::io::rsocket::rpc::RSocketServiceOptions();
+    ::google::protobuf::internal::OnShutdownDestroyMessage(ptr);
+  }
+  ::io::rsocket::rpc::RSocketServiceOptions::InitAsDefaultInstance();
+}
+
+::google::protobuf::internal::SCCInfo<0> scc_info_RSocketServiceOptions =
+    {{ATOMIC_VAR_INIT(::google::protobuf::internal::SCCInfoBase::kUninitialized), 0, InitDefaultsRSocketServiceOptions}, {}};
+
 static void InitDefaultsRSocketMethodOptions() {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
@@ -49,24 +69,52 @@ static void InitDefaultsRSocketMethodOptions() {
     {{ATOMIC_VAR_INIT(::google::protobuf::internal::SCCInfoBase::kUninitialized), 0, InitDefaultsRSocketMethodOptions}, {}};
 
 void InitDefaults() {
+  ::google::protobuf::internal::InitSCC(&scc_info_RSocketServiceOptions.base);
   ::google::protobuf::internal::InitSCC(&scc_info_RSocketMethodOptions.base);
 }
 
-::google::protobuf::Metadata file_level_metadata[1];
+::google::protobuf::Metadata file_level_metadata[2];
+const ::google::protobuf::EnumDescriptor* file_level_enum_descriptors[2];
 
 const ::google::protobuf::uint32 TableStruct::offsets[] GOOGLE_PROTOBUF_ATTRIBUTE_SECTION_VARIABLE(protodesc_cold) = {
+  ~0u,  // no _has_bits_
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketServiceOptions, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketServiceOptions, priority_),
   ~0u,  // no _has_bits_
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, _internal_metadata_),
   ~0u,  // no _extensions_
   ~0u,  // no _oneof_case_
   ~0u,  // no _weak_field_map_
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, fire_and_forget_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, idempotent_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, hedge_after_ms_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, cacheable_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, cache_ttl_ms_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, cache_max_entries_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, cache_key_metadata_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, single_flight_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, compression_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, compression_threshold_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, compression_max_bytes_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, pack_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, pack_max_bytes_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, pack_linger_ms_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, chunked_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, chunk_size_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, chunk_max_bytes_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, offload_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::io::rsocket::rpc::RSocketMethodOptions, priority_),
 };
 static const ::google::protobuf::internal::MigrationSchema schemas[] GOOGLE_PROTOBUF_ATTRIBUTE_SECTION_VARIABLE(protodesc_cold) = {
-  { 0, -1, sizeof(::io::rsocket::rpc::RSocketMethodOptions)},
+  { 0, -1, sizeof(::io::rsocket::rpc::RSocketServiceOptions)},
+  { 6, -1, sizeof(::io::rsocket::rpc::RSocketMethodOptions)},
 };
 
 static ::google::protobuf::Message const * const file_default_instances[] = {
+  reinterpret_cast<const ::google::protobuf::Message*>(&::io::rsocket::rpc::_RSocketServiceOptions_default_instance_),
   reinterpret_cast<const ::google::protobuf::Message*>(&::io::rsocket::rpc::_RSocketMethodOptions_default_instance_),
 };
 
@@ -74,7 +122,7 @@ void protobuf_AssignDescriptors() {
   AddDescriptors();
   AssignDescriptors(
       "rsocket/options.proto", schemas, file_default_instances, TableStruct::offsets,
-      file_level_metadata, NULL, NULL);
+      file_level_metadata, file_level_enum_descriptors, NULL);
 }
 
 void protobuf_AssignDescriptorsOnce() {
@@ -85,22 +133,43 @@ void protobuf_AssignDescriptorsOnce() {
 void protobuf_RegisterTypes(const ::std::string&) GOOGLE_PROTOBUF_ATTRIBUTE_COLD;
 void protobuf_RegisterTypes(const ::std::string&) {
   protobuf_AssignDescriptorsOnce();
-  ::google::protobuf::internal::RegisterAllTypes(file_level_metadata, 1);
+  ::google::protobuf::internal::RegisterAllTypes(file_level_metadata, 2);
 }
 
 void AddDescriptorsImpl() {
   InitDefaults();
   static const char descriptor[] GOOGLE_PROTOBUF_ATTRIBUTE_SECTION_VARIABLE(protodesc_cold) = {
       "\n\025rsocket/options.proto\022\016io.rsocket.rpc\032"
-      " google/protobuf/descriptor.proto\"/\n\024RSo"
-      "cketMethodOptions\022\027\n\017fire_and_forget\030\001 \001"
-      "(\010:V\n\007options\022\036.google.protobuf.MethodOp"
-      "tions\030\241\010 \001(\0132$.io.rsocket.rpc.RSocketMet"
-      "hodOptionsB\"\n\016io.rsocket.rpcB\016RSocketOpt"
-      "ionsP\001b\006proto3"
+      " google/protobuf/descriptor.proto\"J\n\025RSo"
+      "cketServiceOptions\0221\n\010priority\030\001 \001(\0162\037.i"
+      "o.rsocket.rpc.RSocketPriority\"\211\004\n\024RSocke"
+      "tMethodOptions\022\027\n\017fire_and_forget\030\001 \001(\010\022"
+      "\022\n\nidempotent\030\002 \001(\010\022\026\n\016hedge_after_ms\030\003 "
+      "\001(\r\022\021\n\tcacheable\030\004 \001(\010\022\024\n\014cache_ttl_ms\030\005"
+      " \001(\r\022\031\n\021cache_max_entries\030\006 \001(\r\022\032\n\022cache"
+      "_key_metadata\030\021 \003(\t\022\025\n\rsingle_flight\030\007 \001"
+      "(\010\0227\n\013compression\030\010 \001(\0162\".io.rsocket.rpc"
+      ".RSocketCompression\022\035\n\025compression_thres"
+      "hold\030\t \001(\r\022\035\n\025compression_max_bytes\030\022 \001("
+      "\r\022\014\n\004pack\030\n \001(\010\022\026\n\016pack_max_bytes\030\013 \001(\r\022"
+      "\026\n\016pack_linger_ms\030\014 \001(\r\022\017\n\007chunked\030\r \001(\010"
+      "\022\022\n\nchunk_size\030\016 \001(\r\022\027\n\017chunk_max_bytes\030"
+      "\023 \001(\r\022\017\n\007offload\030\017 \001(\010\0221\n\010priority\030\020 \001(\016"
+      "2\037.io.rsocket.rpc.RSocketPriority*Y\n\022RSo"
+      "cketCompression\022\024\n\020COMPRESSION_NONE\020\000\022\027\n"
+      "\023COMPRESSION_DEFLATE\020\001\022\024\n\020COMPRESSION_GZ"
+      "IP\020\002*v\n\017RSocketPriority\022\022\n\016PRIORITY_UNSE"
+      "T\020\000\022\025\n\021PRIORITY_CRITICAL\020\001\022\021\n\rPRIORITY_H"
+      "IGH\020\002\022\023\n\017PRIORITY_NORMAL\020\003\022\020\n\014PRIORITY_L"
+      "OW\020\004:V\n\007options\022\036.google.protobuf.Method"
+      "Options\030\241\010 \001(\0132$.io.rsocket.rpc.RSocketM"
+      "ethodOptions:`\n\017service_options\022\037.google"
+      ".protobuf.ServiceOptions\030\241\010 \001(\0132%.io.rso"
+      "cket.rpc.RSocketServiceOptionsB\"\n\016io.rso"
+      "cket.rpcB\016RSocketOptionsP\001b\006proto3"
   };
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-      descriptor, 254);
+      descriptor, 1114);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "rsocket/options.proto", &protobuf_RegisterTypes);
   ::protobuf_google_2fprotobuf_2fdescriptor_2eproto::AddDescriptors();
@@ -120,6 +189,261 @@ struct StaticDescriptorInitializer {
 namespace io {
 namespace rsocket {
 namespace rpc {
+const ::google::protobuf::EnumDescriptor* RSocketCompression_descriptor() {
+  protobuf_rsocket_2foptions_2eproto::protobuf_AssignDescriptorsOnce();
+  return protobuf_rsocket_2foptions_2eproto::file_level_enum_descriptors[0];
+}
+bool RSocketCompression_IsValid(int value) {
+  switch (value) {
+    case 0:
+    case 1:
+    case 2:
+      return true;
+    default:
+      return false;
+  }
+}
+
+const ::google::protobuf::EnumDescriptor* RSocketPriority_descriptor() {
+  protobuf_rsocket_2foptions_2eproto::protobuf_AssignDescriptorsOnce();
+  return protobuf_rsocket_2foptions_2eproto::file_level_enum_descriptors[1];
+}
+bool RSocketPriority_IsValid(int value) {
+  switch (value) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+// ===================================================================
+
+void RSocketServiceOptions::InitAsDefaultInstance() {
+}
+#if !defined(_MSC_VER) || _MSC_VER >= 1900
+const int RSocketServiceOptions::kPriorityFieldNumber;
+#endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
+
+RSocketServiceOptions::RSocketServiceOptions()
+  : ::google::protobuf::Message(), _internal_metadata_(NULL) {
+  ::google::protobuf::internal::InitSCC(
+      &protobuf_rsocket_2foptions_2eproto::scc_info_RSocketServiceOptions.base);
+  SharedCtor();
+  // @@protoc_insertion_point(constructor:io.rsocket.rpc.RSocketServiceOptions)
+}
+RSocketServiceOptions::RSocketServiceOptions(const RSocketServiceOptions& from)
+  : ::google::protobuf::Message(),
+      _internal_metadata_(NULL) {
+  _internal_metadata_.MergeFrom(from._internal_metadata_);
+  priority_ = from.priority_;
+  // @@protoc_insertion_point(copy_constructor:io.rsocket.rpc.RSocketServiceOptions)
+}
+
+void RSocketServiceOptions::SharedCtor() {
+  priority_ = 0;
+}
+
+RSocketServiceOptions::~RSocketServiceOptions() {
+  // @@protoc_insertion_point(destructor:io.rsocket.rpc.RSocketServiceOptions)
+  SharedDtor();
+}
+
+void RSocketServiceOptions::SharedDtor() {
+}
+
+void RSocketServiceOptions::SetCachedSize(int size) const {
+  _cached_size_.Set(size);
+}
+const ::google::protobuf::Descriptor* RSocketServiceOptions::descriptor() {
+  ::protobuf_rsocket_2foptions_2eproto::protobuf_AssignDescriptorsOnce();
+  return ::protobuf_rsocket_2foptions_2eproto::file_level_metadata[kIndexInFileMessages].descriptor;
+}
+
+const RSocketServiceOptions& RSocketServiceOptions::default_instance() {
+  ::google::protobuf::internal::InitSCC(&protobuf_rsocket_2foptions_2eproto::scc_info_RSocketServiceOptions.base);
+  return *internal_default_instance();
+}
+
+
+void RSocketServiceOptions::Clear() {
+// @@protoc_insertion_point(message_clear_start:io.rsocket.rpc.RSocketServiceOptions)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  priority_ = 0;
+  _internal_metadata_.Clear();
+}
+
+bool RSocketServiceOptions::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!GOOGLE_PREDICT_TRUE(EXPRESSION)) goto failure
+  ::google::protobuf::uint32 tag;
+  // @@protoc_insertion_point(parse_start:io.rsocket.rpc.RSocketServiceOptions)
+  for (;;) {
+    ::std::pair<::google::protobuf::uint32, bool> p = input->ReadTagWithCutoffNoLastTag(127u);
+    tag = p.first;
+    if (!p.second) goto handle_unusual;
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // .io.rsocket.rpc.RSocketPriority priority = 1;
+      case 1: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(8u /* 8 & 0xFF */)) {
+          int value;
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(
+                 input, &value)));
+          set_priority(static_cast< ::io::rsocket::rpc::RSocketPriority >(value));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      default: {
+      handle_unusual:
+        if (tag == 0) {
+          goto success;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, _internal_metadata_.mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+success:
+  // @@protoc_insertion_point(parse_success:io.rsocket.rpc.RSocketServiceOptions)
+  return true;
+failure:
+  // @@protoc_insertion_point(parse_failure:io.rsocket.rpc.RSocketServiceOptions)
+  return false;
+#undef DO_
+}
+
+void RSocketServiceOptions::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // @@protoc_insertion_point(serialize_start:io.rsocket.rpc.RSocketServiceOptions)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // .io.rsocket.rpc.RSocketPriority priority = 1;
+  if (this->priority() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteEnum(1, this->priority(), output);
+  }
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), output);
+  }
+  // @@protoc_insertion_point(serialize_end:io.rsocket.rpc.RSocketServiceOptions)
+}
+
+::google::protobuf::uint8* RSocketServiceOptions::InternalSerializeWithCachedSizesToArray(
+    bool deterministic, ::google::protobuf::uint8* target) const {
+  (void)deterministic; // Unused
+  // @@protoc_insertion_point(serialize_to_array_start:io.rsocket.rpc.RSocketServiceOptions)
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // .io.rsocket.rpc.RSocketPriority priority = 1;
+  if (this->priority() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(1, this->priority(), target);
+  }
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), target);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:io.rsocket.rpc.RSocketServiceOptions)
+  return target;
+}
+
+size_t RSocketServiceOptions::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:io.rsocket.rpc.RSocketServiceOptions)
+  size_t total_size = 0;
+
+  if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()));
+  }
+  // .io.rsocket.rpc.RSocketPriority priority = 1;
+  if (this->priority() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::EnumSize(this->priority());
+  }
+
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
+  SetCachedSize(cached_size);
+  return total_size;
+}
+
+void RSocketServiceOptions::MergeFrom(const ::google::protobuf::Message& from) {
+// @@protoc_insertion_point(generalized_merge_from_start:io.rsocket.rpc.RSocketServiceOptions)
+  GOOGLE_DCHECK_NE(&from, this);
+  const RSocketServiceOptions* source =
+      ::google::protobuf::internal::DynamicCastToGenerated<const RSocketServiceOptions>(
+          &from);
+  if (source == NULL) {
+  // @@protoc_insertion_point(generalized_merge_from_cast_fail:io.rsocket.rpc.RSocketServiceOptions)
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+  // @@protoc_insertion_point(generalized_merge_from_cast_success:io.rsocket.rpc.RSocketServiceOptions)
+    MergeFrom(*source);
+  }
+}
+
+void RSocketServiceOptions::MergeFrom(const RSocketServiceOptions& from) {
+// @@protoc_insertion_point(class_specific_merge_from_start:io.rsocket.rpc.RSocketServiceOptions)
+  GOOGLE_DCHECK_NE(&from, this);
+  _internal_metadata_.MergeFrom(from._internal_metadata_);
+  ::google::protobuf::uint32 cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  if (from.priority() != 0) {
+    set_priority(from.priority());
+  }
+}
+
+void RSocketServiceOptions::CopyFrom(const ::google::protobuf::Message& from) {
+// @@protoc_insertion_point(generalized_copy_from_start:io.rsocket.rpc.RSocketServiceOptions)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void RSocketServiceOptions::CopyFrom(const RSocketServiceOptions& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:io.rsocket.rpc.RSocketServiceOptions)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool RSocketServiceOptions::IsInitialized() const {
+  return true;
+}
+
+void RSocketServiceOptions::Swap(RSocketServiceOptions* other) {
+  if (other == this) return;
+  InternalSwap(other);
+}
+void RSocketServiceOptions::InternalSwap(RSocketServiceOptions* other) {
+  using std::swap;
+  swap(priority_, other->priority_);
+  _internal_metadata_.Swap(&other->_internal_metadata_);
+}
+
+::google::protobuf::Metadata RSocketServiceOptions::GetMetadata() const {
+  protobuf_rsocket_2foptions_2eproto::protobuf_AssignDescriptorsOnce();
+  return ::protobuf_rsocket_2foptions_2eproto::file_level_metadata[kIndexInFileMessages];
+}
+
 
 // ===================================================================
 
@@ -127,6 +451,24 @@ void RSocketMethodOptions::InitAsDefaultInstance() {
 }
 #if !defined(_MSC_VER) || _MSC_VER >= 1900
 const int RSocketMethodOptions::kFireAndForgetFieldNumber;
+const int RSocketMethodOptions::kIdempotentFieldNumber;
+const int RSocketMethodOptions::kHedgeAfterMsFieldNumber;
+const int RSocketMethodOptions::kCacheableFieldNumber;
+const int RSocketMethodOptions::kCacheTtlMsFieldNumber;
+const int RSocketMethodOptions::kCacheMaxEntriesFieldNumber;
+const int RSocketMethodOptions::kCacheKeyMetadataFieldNumber;
+const int RSocketMethodOptions::kSingleFlightFieldNumber;
+const int RSocketMethodOptions::kCompressionFieldNumber;
+const int RSocketMethodOptions::kCompressionThresholdFieldNumber;
+const int RSocketMethodOptions::kCompressionMaxBytesFieldNumber;
+const int RSocketMethodOptions::kPackFieldNumber;
+const int RSocketMethodOptions::kPackMaxBytesFieldNumber;
+const int RSocketMethodOptions::kPackLingerMsFieldNumber;
+const int RSocketMethodOptions::kChunkedFieldNumber;
+const int RSocketMethodOptions::kChunkSizeFieldNumber;
+const int RSocketMethodOptions::kChunkMaxBytesFieldNumber;
+const int RSocketMethodOptions::kOffloadFieldNumber;
+const int RSocketMethodOptions::kPriorityFieldNumber;
 #endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
 
 RSocketMethodOptions::RSocketMethodOptions()
@@ -138,14 +480,19 @@ RSocketMethodOptions::RSocketMethodOptions()
 }
 RSocketMethodOptions::RSocketMethodOptions(const RSocketMethodOptions& from)
   : ::google::protobuf::Message(),
-      _internal_metadata_(NULL) {
+      _internal_metadata_(NULL),
+      cache_key_metadata_(from.cache_key_metadata_) {
   _internal_metadata_.MergeFrom(from._internal_metadata_);
-  fire_and_forget_ = from.fire_and_forget_;
+  ::memcpy(&hedge_after_ms_, &from.hedge_after_ms_,
+    static_cast<size_t>(reinterpret_cast<char*>(&offload_) -
+    reinterpret_cast<char*>(&hedge_after_ms_)) + sizeof(offload_));
   // @@protoc_insertion_point(copy_constructor:io.rsocket.rpc.RSocketMethodOptions)
 }
 
 void RSocketMethodOptions::SharedCtor() {
-  fire_and_forget_ = false;
+  ::memset(&hedge_after_ms_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&offload_) -
+      reinterpret_cast<char*>(&hedge_after_ms_)) + sizeof(offload_));
 }
 
 RSocketMethodOptions::~RSocketMethodOptions() {
@@ -176,7 +523,10 @@ void RSocketMethodOptions::Clear() {
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  fire_and_forget_ = false;
+  cache_key_metadata_.Clear();
+  ::memset(&hedge_after_ms_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&offload_) -
+      reinterpret_cast<char*>(&hedge_after_ms_)) + sizeof(offload_));
   _internal_metadata_.Clear();
 }
 
@@ -186,7 +536,7 @@ bool RSocketMethodOptions::MergePartialFromCodedStream(
   ::google::protobuf::uint32 tag;
   // @@protoc_insertion_point(parse_start:io.rsocket.rpc.RSocketMethodOptions)
   for (;;) {
-    ::std::pair<::google::protobuf::uint32, bool> p = input->ReadTagWithCutoffNoLastTag(127u);
+    ::std::pair<::google::protobuf::uint32, bool> p = input->ReadTagWithCutoffNoLastTag(16383u);
     tag = p.first;
     if (!p.second) goto handle_unusual;
     switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
@@ -204,6 +554,263 @@ bool RSocketMethodOptions::MergePartialFromCodedStream(
         break;
       }
 
+      // bool idempotent = 2;
+      case 2: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(16u /* 16 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &idempotent_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 hedge_after_ms = 3;
+      case 3: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(24u /* 24 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &hedge_after_ms_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool cacheable = 4;
+      case 4: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(32u /* 32 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &cacheable_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 cache_ttl_ms = 5;
+      case 5: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(40u /* 40 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &cache_ttl_ms_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 cache_max_entries = 6;
+      case 6: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(48u /* 48 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &cache_max_entries_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool single_flight = 7;
+      case 7: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(56u /* 56 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &single_flight_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // .io.rsocket.rpc.RSocketCompression compression = 8;
+      case 8: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(64u /* 64 & 0xFF */)) {
+          int value;
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(
+                 input, &value)));
+          set_compression(static_cast< ::io::rsocket::rpc::RSocketCompression >(value));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 compression_threshold = 9;
+      case 9: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(72u /* 72 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &compression_threshold_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool pack = 10;
+      case 10: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(80u /* 80 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &pack_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 pack_max_bytes = 11;
+      case 11: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(88u /* 88 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &pack_max_bytes_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 pack_linger_ms = 12;
+      case 12: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(96u /* 96 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &pack_linger_ms_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool chunked = 13;
+      case 13: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(104u /* 104 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &chunked_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 chunk_size = 14;
+      case 14: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(112u /* 112 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &chunk_size_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // bool offload = 15;
+      case 15: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(120u /* 120 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &offload_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // .io.rsocket.rpc.RSocketPriority priority = 16;
+      case 16: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(128u /* 128 & 0xFF */)) {
+          int value;
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(
+                 input, &value)));
+          set_priority(static_cast< ::io::rsocket::rpc::RSocketPriority >(value));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // repeated string cache_key_metadata = 17;
+      case 17: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(138u /* 138 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->add_cache_key_metadata()));
+          DO_(::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
+            this->cache_key_metadata(this->cache_key_metadata_size() - 1).data(),
+            static_cast<int>(this->cache_key_metadata(this->cache_key_metadata_size() - 1).length()),
+            ::google::protobuf::internal::WireFormatLite::PARSE,
+            "io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata"));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 compression_max_bytes = 18;
+      case 18: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(144u /* 144 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &compression_max_bytes_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // uint32 chunk_max_bytes = 19;
+      case 19: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(152u /* 152 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                    ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &chunk_max_bytes_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
       default: {
       handle_unusual:
         if (tag == 0) {
@@ -235,6 +842,101 @@ void RSocketMethodOptions::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteBool(1, this->fire_and_forget(), output);
   }
 
+  // bool idempotent = 2;
+  if (this->idempotent() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(2, this->idempotent(), output);
+  }
+
+  // uint32 hedge_after_ms = 3;
+  if (this->hedge_after_ms() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(3, this->hedge_after_ms(), output);
+  }
+
+  // bool cacheable = 4;
+  if (this->cacheable() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(4, this->cacheable(), output);
+  }
+
+  // uint32 cache_ttl_ms = 5;
+  if (this->cache_ttl_ms() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(5, this->cache_ttl_ms(), output);
+  }
+
+  // uint32 cache_max_entries = 6;
+  if (this->cache_max_entries() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(6, this->cache_max_entries(), output);
+  }
+
+  // bool single_flight = 7;
+  if (this->single_flight() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(7, this->single_flight(), output);
+  }
+
+  // .io.rsocket.rpc.RSocketCompression compression = 8;
+  if (this->compression() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteEnum(8, this->compression(), output);
+  }
+
+  // uint32 compression_threshold = 9;
+  if (this->compression_threshold() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(9, this->compression_threshold(), output);
+  }
+
+  // bool pack = 10;
+  if (this->pack() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(10, this->pack(), output);
+  }
+
+  // uint32 pack_max_bytes = 11;
+  if (this->pack_max_bytes() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(11, this->pack_max_bytes(), output);
+  }
+
+  // uint32 pack_linger_ms = 12;
+  if (this->pack_linger_ms() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(12, this->pack_linger_ms(), output);
+  }
+
+  // bool chunked = 13;
+  if (this->chunked() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(13, this->chunked(), output);
+  }
+
+  // uint32 chunk_size = 14;
+  if (this->chunk_size() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(14, this->chunk_size(), output);
+  }
+
+  // bool offload = 15;
+  if (this->offload() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(15, this->offload(), output);
+  }
+
+  // .io.rsocket.rpc.RSocketPriority priority = 16;
+  if (this->priority() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteEnum(16, this->priority(), output);
+  }
+
+  // repeated string cache_key_metadata = 17;
+  for (int i = 0, n = this->cache_key_metadata_size(); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
+      this->cache_key_metadata(i).data(), static_cast<int>(this->cache_key_metadata(i).length()),
+      ::google::protobuf::internal::WireFormatLite::SERIALIZE,
+      "io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata");
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      17, this->cache_key_metadata(i), output);
+  }
+
+  // uint32 compression_max_bytes = 18;
+  if (this->compression_max_bytes() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(18, this->compression_max_bytes(), output);
+  }
+
+  // uint32 chunk_max_bytes = 19;
+  if (this->chunk_max_bytes() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(19, this->chunk_max_bytes(), output);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), output);
@@ -254,6 +956,101 @@ void RSocketMethodOptions::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(1, this->fire_and_forget(), target);
   }
 
+  // bool idempotent = 2;
+  if (this->idempotent() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(2, this->idempotent(), target);
+  }
+
+  // uint32 hedge_after_ms = 3;
+  if (this->hedge_after_ms() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(3, this->hedge_after_ms(), target);
+  }
+
+  // bool cacheable = 4;
+  if (this->cacheable() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(4, this->cacheable(), target);
+  }
+
+  // uint32 cache_ttl_ms = 5;
+  if (this->cache_ttl_ms() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(5, this->cache_ttl_ms(), target);
+  }
+
+  // uint32 cache_max_entries = 6;
+  if (this->cache_max_entries() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(6, this->cache_max_entries(), target);
+  }
+
+  // bool single_flight = 7;
+  if (this->single_flight() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(7, this->single_flight(), target);
+  }
+
+  // .io.rsocket.rpc.RSocketCompression compression = 8;
+  if (this->compression() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(8, this->compression(), target);
+  }
+
+  // uint32 compression_threshold = 9;
+  if (this->compression_threshold() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(9, this->compression_threshold(), target);
+  }
+
+  // bool pack = 10;
+  if (this->pack() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(10, this->pack(), target);
+  }
+
+  // uint32 pack_max_bytes = 11;
+  if (this->pack_max_bytes() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(11, this->pack_max_bytes(), target);
+  }
+
+  // uint32 pack_linger_ms = 12;
+  if (this->pack_linger_ms() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(12, this->pack_linger_ms(), target);
+  }
+
+  // bool chunked = 13;
+  if (this->chunked() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(13, this->chunked(), target);
+  }
+
+  // uint32 chunk_size = 14;
+  if (this->chunk_size() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(14, this->chunk_size(), target);
+  }
+
+  // bool offload = 15;
+  if (this->offload() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(15, this->offload(), target);
+  }
+
+  // .io.rsocket.rpc.RSocketPriority priority = 16;
+  if (this->priority() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(16, this->priority(), target);
+  }
+
+  // repeated string cache_key_metadata = 17;
+  for (int i = 0, n = this->cache_key_metadata_size(); i < n; i++) {
+    ::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
+      this->cache_key_metadata(i).data(), static_cast<int>(this->cache_key_metadata(i).length()),
+      ::google::protobuf::internal::WireFormatLite::SERIALIZE,
+      "io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata");
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteStringToArray(17, this->cache_key_metadata(i), target);
+  }
+
+  // uint32 compression_max_bytes = 18;
+  if (this->compression_max_bytes() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(18, this->compression_max_bytes(), target);
+  }
+
+  // uint32 chunk_max_bytes = 19;
+  if (this->chunk_max_bytes() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(19, this->chunk_max_bytes(), target);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), target);
@@ -271,11 +1068,124 @@ size_t RSocketMethodOptions::ByteSizeLong() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()));
   }
+  // repeated string cache_key_metadata = 17;
+  total_size += 2 *
+      ::google::protobuf::internal::FromIntSize(this->cache_key_metadata_size());
+  for (int i = 0, n = this->cache_key_metadata_size(); i < n; i++) {
+    total_size += ::google::protobuf::internal::WireFormatLite::StringSize(
+      this->cache_key_metadata(i));
+  }
+
+  // uint32 hedge_after_ms = 3;
+  if (this->hedge_after_ms() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->hedge_after_ms());
+  }
+
+  // uint32 cache_ttl_ms = 5;
+  if (this->cache_ttl_ms() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->cache_ttl_ms());
+  }
+
+  // uint32 cache_max_entries = 6;
+  if (this->cache_max_entries() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->cache_max_entries());
+  }
+
+  // .io.rsocket.rpc.RSocketCompression compression = 8;
+  if (this->compression() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::EnumSize(this->compression());
+  }
+
+  // uint32 compression_threshold = 9;
+  if (this->compression_threshold() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->compression_threshold());
+  }
+
+  // uint32 compression_max_bytes = 18;
+  if (this->compression_max_bytes() != 0) {
+    total_size += 2 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->compression_max_bytes());
+  }
+
+  // uint32 pack_max_bytes = 11;
+  if (this->pack_max_bytes() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->pack_max_bytes());
+  }
+
+  // uint32 pack_linger_ms = 12;
+  if (this->pack_linger_ms() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->pack_linger_ms());
+  }
+
+  // uint32 chunk_size = 14;
+  if (this->chunk_size() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->chunk_size());
+  }
+
+  // uint32 chunk_max_bytes = 19;
+  if (this->chunk_max_bytes() != 0) {
+    total_size += 2 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->chunk_max_bytes());
+  }
+
+  // .io.rsocket.rpc.RSocketPriority priority = 16;
+  if (this->priority() != 0) {
+    total_size += 2 +
+      ::google::protobuf::internal::WireFormatLite::EnumSize(this->priority());
+  }
+
   // bool fire_and_forget = 1;
   if (this->fire_and_forget() != 0) {
     total_size += 1 + 1;
   }
 
+  // bool idempotent = 2;
+  if (this->idempotent() != 0) {
+    total_size += 1 + 1;
+  }
+
+  // bool cacheable = 4;
+  if (this->cacheable() != 0) {
+    total_size += 1 + 1;
+  }
+
+  // bool single_flight = 7;
+  if (this->single_flight() != 0) {
+    total_size += 1 + 1;
+  }
+
+  // bool pack = 10;
+  if (this->pack() != 0) {
+    total_size += 1 + 1;
+  }
+
+  // bool chunked = 13;
+  if (this->chunked() != 0) {
+    total_size += 1 + 1;
+  }
+
+  // bool offload = 15;
+  if (this->offload() != 0) {
+    total_size += 1 + 1;
+  }
+
   int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   SetCachedSize(cached_size);
   return total_size;
@@ -303,9 +1213,61 @@ void RSocketMethodOptions::MergeFrom(const RSocketMethodOptions& from) {
   ::google::protobuf::uint32 cached_has_bits = 0;
   (void) cached_has_bits;
 
+  cache_key_metadata_.MergeFrom(from.cache_key_metadata_);
+  if (from.hedge_after_ms() != 0) {
+    set_hedge_after_ms(from.hedge_after_ms());
+  }
+  if (from.cache_ttl_ms() != 0) {
+    set_cache_ttl_ms(from.cache_ttl_ms());
+  }
+  if (from.cache_max_entries() != 0) {
+    set_cache_max_entries(from.cache_max_entries());
+  }
+  if (from.compression() != 0) {
+    set_compression(from.compression());
+  }
+  if (from.compression_threshold() != 0) {
+    set_compression_threshold(from.compression_threshold());
+  }
+  if (from.compression_max_bytes() != 0) {
+    set_compression_max_bytes(from.compression_max_bytes());
+  }
+  if (from.pack_max_bytes() != 0) {
+    set_pack_max_bytes(from.pack_max_bytes());
+  }
+  if (from.pack_linger_ms() != 0) {
+    set_pack_linger_ms(from.pack_linger_ms());
+  }
+  if (from.chunk_size() != 0) {
+    set_chunk_size(from.chunk_size());
+  }
+  if (from.chunk_max_bytes() != 0) {
+    set_chunk_max_bytes(from.chunk_max_bytes());
+  }
+  if (from.priority() != 0) {
+    set_priority(from.priority());
+  }
   if (from.fire_and_forget() != 0) {
     set_fire_and_forget(from.fire_and_forget());
   }
+  if (from.idempotent() != 0) {
+    set_idempotent(from.idempotent());
+  }
+  if (from.cacheable() != 0) {
+    set_cacheable(from.cacheable());
+  }
+  if (from.single_flight() != 0) {
+    set_single_flight(from.single_flight());
+  }
+  if (from.pack() != 0) {
+    set_pack(from.pack());
+  }
+  if (from.chunked() != 0) {
+    set_chunked(from.chunked());
+  }
+  if (from.offload() != 0) {
+    set_offload(from.offload());
+  }
 }
 
 void RSocketMethodOptions::CopyFrom(const ::google::protobuf::Message& from) {
@@ -332,7 +1294,25 @@ void RSocketMethodOptions::Swap(RSocketMethodOptions* other) {
 }
 void RSocketMethodOptions::InternalSwap(RSocketMethodOptions* other) {
   using std::swap;
+  cache_key_metadata_.InternalSwap(CastToBase(&other->cache_key_metadata_));
+  swap(hedge_after_ms_, other->hedge_after_ms_);
+  swap(cache_ttl_ms_, other->cache_ttl_ms_);
+  swap(cache_max_entries_, other->cache_max_entries_);
+  swap(compression_, other->compression_);
+  swap(compression_threshold_, other->compression_threshold_);
+  swap(compression_max_bytes_, other->compression_max_bytes_);
+  swap(pack_max_bytes_, other->pack_max_bytes_);
+  swap(pack_linger_ms_, other->pack_linger_ms_);
+  swap(chunk_size_, other->chunk_size_);
+  swap(chunk_max_bytes_, other->chunk_max_bytes_);
+  swap(priority_, other->priority_);
   swap(fire_and_forget_, other->fire_and_forget_);
+  swap(idempotent_, other->idempotent_);
+  swap(cacheable_, other->cacheable_);
+  swap(single_flight_, other->single_flight_);
+  swap(pack_, other->pack_);
+  swap(chunked_, other->chunked_);
+  swap(offload_, other->offload_);
   _internal_metadata_.Swap(&other->_internal_metadata_);
 }
 
@@ -344,6 +1324,9 @@ void RSocketMethodOptions::InternalSwap(RSocketMethodOptions* other) {
 ::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::MethodOptions,
     ::google::protobuf::internal::MessageTypeTraits< ::io::rsocket::rpc::RSocketMethodOptions >, 11, false >
   options(kOptionsFieldNumber, *::io::rsocket::rpc::RSocketMethodOptions::internal_default_instance());
+::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::ServiceOptions,
+    ::google::protobuf::internal::MessageTypeTraits< ::io::rsocket::rpc::RSocketServiceOptions >, 11, false >
+  service_options(kServiceOptionsFieldNumber, *::io::rsocket::rpc::RSocketServiceOptions::internal_default_instance());
 
 // @@protoc_insertion_point(namespace_scope)
 }  // namespace rpc
@@ -351,6 +1334,9 @@ void RSocketMethodOptions::InternalSwap(RSocketMethodOptions* other) {
 }  // namespace io
 namespace google {
 namespace protobuf {
+template<> GOOGLE_PROTOBUF_ATTRIBUTE_NOINLINE ::io::rsocket::rpc::RSocketServiceOptions* Arena::CreateMaybeMessage< ::io::rsocket::rpc::RSocketServiceOptions >(Arena* arena) {
+  return Arena::CreateInternal< ::io::rsocket::rpc::RSocketServiceOptions >(arena);
+}
 template<> GOOGLE_PROTOBUF_ATTRIBUTE_NOINLINE ::io::rsocket::rpc::RSocketMethodOptions* Arena::CreateMaybeMessage< ::io::rsocket::rpc::RSocketMethodOptions >(Arena* arena) {
   return Arena::CreateInternal< ::io::rsocket::rpc::RSocketMethodOptions >(arena);
 }
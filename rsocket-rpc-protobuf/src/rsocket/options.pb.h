@@ -18,6 +18,7 @@
 #include <google/protobuf/message.h>
 #include <google/protobuf/repeated_field.h>  // IWYU pragma: export
 #include <google/protobuf/extension_set.h>  // IWYU pragma: export
+#include <google/protobuf/generated_enum_reflection.h>
 #include <google/protobuf/unknown_field_set.h>
 #include <google/protobuf/descriptor.pb.h>
 // @@protoc_insertion_point(includes)
@@ -28,7 +29,7 @@ namespace protobuf_rsocket_2foptions_2eproto {
 struct TableStruct {
   static const ::google::protobuf::internal::ParseTableField entries[];
   static const ::google::protobuf::internal::AuxillaryParseTableField aux[];
-  static const ::google::protobuf::internal::ParseTable schema[1];
+  static const ::google::protobuf::internal::ParseTable schema[2];
   static const ::google::protobuf::internal::FieldMetadata field_metadata[];
   static const ::google::protobuf::internal::SerializationTable serialization_table[];
   static const ::google::protobuf::uint32 offsets[];
@@ -41,20 +42,173 @@ namespace rpc {
 class RSocketMethodOptions;
 class RSocketMethodOptionsDefaultTypeInternal;
 extern RSocketMethodOptionsDefaultTypeInternal _RSocketMethodOptions_default_instance_;
+class RSocketServiceOptions;
+class RSocketServiceOptionsDefaultTypeInternal;
+extern RSocketServiceOptionsDefaultTypeInternal _RSocketServiceOptions_default_instance_;
 }  // namespace rpc
 }  // namespace rsocket
 }  // namespace io
 namespace google {
 namespace protobuf {
 template<> ::io::rsocket::rpc::RSocketMethodOptions* Arena::CreateMaybeMessage<::io::rsocket::rpc::RSocketMethodOptions>(Arena*);
+template<> ::io::rsocket::rpc::RSocketServiceOptions* Arena::CreateMaybeMessage<::io::rsocket::rpc::RSocketServiceOptions>(Arena*);
 }  // namespace protobuf
 }  // namespace google
 namespace io {
 namespace rsocket {
 namespace rpc {
 
+enum RSocketCompression {
+  COMPRESSION_NONE = 0,
+  COMPRESSION_DEFLATE = 1,
+  COMPRESSION_GZIP = 2,
+  RSocketCompression_INT_MIN_SENTINEL_DO_NOT_USE_ = ::google::protobuf::kint32min,
+  RSocketCompression_INT_MAX_SENTINEL_DO_NOT_USE_ = ::google::protobuf::kint32max
+};
+bool RSocketCompression_IsValid(int value);
+const RSocketCompression RSocketCompression_MIN = COMPRESSION_NONE;
+const RSocketCompression RSocketCompression_MAX = COMPRESSION_GZIP;
+const int RSocketCompression_ARRAYSIZE = RSocketCompression_MAX + 1;
+
+const ::google::protobuf::EnumDescriptor* RSocketCompression_descriptor();
+inline const ::std::string& RSocketCompression_Name(RSocketCompression value) {
+  return ::google::protobuf::internal::NameOfEnum(
+    RSocketCompression_descriptor(), value);
+}
+inline bool RSocketCompression_Parse(
+    const ::std::string& name, RSocketCompression* value) {
+  return ::google::protobuf::internal::ParseNamedEnum<RSocketCompression>(
+    RSocketCompression_descriptor(), name, value);
+}
+enum RSocketPriority {
+  PRIORITY_UNSET = 0,
+  PRIORITY_CRITICAL = 1,
+  PRIORITY_HIGH = 2,
+  PRIORITY_NORMAL = 3,
+  PRIORITY_LOW = 4,
+  RSocketPriority_INT_MIN_SENTINEL_DO_NOT_USE_ = ::google::protobuf::kint32min,
+  RSocketPriority_INT_MAX_SENTINEL_DO_NOT_USE_ = ::google::protobuf::kint32max
+};
+bool RSocketPriority_IsValid(int value);
+const RSocketPriority RSocketPriority_MIN = PRIORITY_UNSET;
+const RSocketPriority RSocketPriority_MAX = PRIORITY_LOW;
+const int RSocketPriority_ARRAYSIZE = RSocketPriority_MAX + 1;
+
+const ::google::protobuf::EnumDescriptor* RSocketPriority_descriptor();
+inline const ::std::string& RSocketPriority_Name(RSocketPriority value) {
+  return ::google::protobuf::internal::NameOfEnum(
+    RSocketPriority_descriptor(), value);
+}
+inline bool RSocketPriority_Parse(
+    const ::std::string& name, RSocketPriority* value) {
+  return ::google::protobuf::internal::ParseNamedEnum<RSocketPriority>(
+    RSocketPriority_descriptor(), name, value);
+}
 // ===================================================================
 
+class RSocketServiceOptions : public ::google::protobuf::Message /* @@protoc_insertion_point(class_definition:io.rsocket.rpc.RSocketServiceOptions) */ {
+ public:
+  RSocketServiceOptions();
+  virtual ~RSocketServiceOptions();
+
+  RSocketServiceOptions(const RSocketServiceOptions& from);
+
+  inline RSocketServiceOptions& operator=(const RSocketServiceOptions& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  #if LANG_CXX11
+  RSocketServiceOptions(RSocketServiceOptions&& from) noexcept
+    : RSocketServiceOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline RSocketServiceOptions& operator=(RSocketServiceOptions&& from) noexcept {
+    if (GetArenaNoVirtual() == from.GetArenaNoVirtual()) {
+      if (this != &from) InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+  #endif
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const RSocketServiceOptions& default_instance();
+
+  static void InitAsDefaultInstance();  // FOR INTERNAL USE ONLY
+  static inline const RSocketServiceOptions* internal_default_instance() {
+    return reinterpret_cast<const RSocketServiceOptions*>(
+               &_RSocketServiceOptions_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    0;
+
+  void Swap(RSocketServiceOptions* other);
+  friend void swap(RSocketServiceOptions& a, RSocketServiceOptions& b) {
+    a.Swap(&b);
+  }
+
+  // implements Message ----------------------------------------------
+
+  inline RSocketServiceOptions* New() const final {
+    return CreateMaybeMessage<RSocketServiceOptions>(NULL);
+  }
+
+  RSocketServiceOptions* New(::google::protobuf::Arena* arena) const final {
+    return CreateMaybeMessage<RSocketServiceOptions>(arena);
+  }
+  void CopyFrom(const ::google::protobuf::Message& from) final;
+  void MergeFrom(const ::google::protobuf::Message& from) final;
+  void CopyFrom(const RSocketServiceOptions& from);
+  void MergeFrom(const RSocketServiceOptions& from);
+  void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input) final;
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const final;
+  ::google::protobuf::uint8* InternalSerializeWithCachedSizesToArray(
+      bool deterministic, ::google::protobuf::uint8* target) const final;
+  int GetCachedSize() const final { return _cached_size_.Get(); }
+
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(RSocketServiceOptions* other);
+  private:
+  inline ::google::protobuf::Arena* GetArenaNoVirtual() const {
+    return NULL;
+  }
+  inline void* MaybeArenaPtr() const {
+    return NULL;
+  }
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // .io.rsocket.rpc.RSocketPriority priority = 1;
+  void clear_priority();
+  static const int kPriorityFieldNumber = 1;
+  ::io::rsocket::rpc::RSocketPriority priority() const;
+  void set_priority(::io::rsocket::rpc::RSocketPriority value);
+
+  // @@protoc_insertion_point(class_scope:io.rsocket.rpc.RSocketServiceOptions)
+ private:
+
+  ::google::protobuf::internal::InternalMetadataWithArena _internal_metadata_;
+  int priority_;
+  mutable ::google::protobuf::internal::CachedSize _cached_size_;
+  friend struct ::protobuf_rsocket_2foptions_2eproto::TableStruct;
+};
+// -------------------------------------------------------------------
+
 class RSocketMethodOptions : public ::google::protobuf::Message /* @@protoc_insertion_point(class_definition:io.rsocket.rpc.RSocketMethodOptions) */ {
  public:
   RSocketMethodOptions();
@@ -90,7 +244,7 @@ class RSocketMethodOptions : public ::google::protobuf::Message /* @@protoc_inse
                &_RSocketMethodOptions_default_instance_);
   }
   static constexpr int kIndexInFileMessages =
-    0;
+    1;
 
   void Swap(RSocketMethodOptions* other);
   friend void swap(RSocketMethodOptions& a, RSocketMethodOptions& b) {
@@ -148,11 +302,153 @@ class RSocketMethodOptions : public ::google::protobuf::Message /* @@protoc_inse
   bool fire_and_forget() const;
   void set_fire_and_forget(bool value);
 
+  // bool idempotent = 2;
+  void clear_idempotent();
+  static const int kIdempotentFieldNumber = 2;
+  bool idempotent() const;
+  void set_idempotent(bool value);
+
+  // uint32 hedge_after_ms = 3;
+  void clear_hedge_after_ms();
+  static const int kHedgeAfterMsFieldNumber = 3;
+  ::google::protobuf::uint32 hedge_after_ms() const;
+  void set_hedge_after_ms(::google::protobuf::uint32 value);
+
+  // bool cacheable = 4;
+  void clear_cacheable();
+  static const int kCacheableFieldNumber = 4;
+  bool cacheable() const;
+  void set_cacheable(bool value);
+
+  // uint32 cache_ttl_ms = 5;
+  void clear_cache_ttl_ms();
+  static const int kCacheTtlMsFieldNumber = 5;
+  ::google::protobuf::uint32 cache_ttl_ms() const;
+  void set_cache_ttl_ms(::google::protobuf::uint32 value);
+
+  // uint32 cache_max_entries = 6;
+  void clear_cache_max_entries();
+  static const int kCacheMaxEntriesFieldNumber = 6;
+  ::google::protobuf::uint32 cache_max_entries() const;
+  void set_cache_max_entries(::google::protobuf::uint32 value);
+
+  // repeated string cache_key_metadata = 17;
+  int cache_key_metadata_size() const;
+  void clear_cache_key_metadata();
+  static const int kCacheKeyMetadataFieldNumber = 17;
+  const ::std::string& cache_key_metadata(int index) const;
+  ::std::string* mutable_cache_key_metadata(int index);
+  void set_cache_key_metadata(int index, const ::std::string& value);
+  #if LANG_CXX11
+  void set_cache_key_metadata(int index, ::std::string&& value);
+  #endif
+  void set_cache_key_metadata(int index, const char* value);
+  void set_cache_key_metadata(int index, const char* value, size_t size);
+  ::std::string* add_cache_key_metadata();
+  void add_cache_key_metadata(const ::std::string& value);
+  #if LANG_CXX11
+  void add_cache_key_metadata(::std::string&& value);
+  #endif
+  void add_cache_key_metadata(const char* value);
+  void add_cache_key_metadata(const char* value, size_t size);
+  const ::google::protobuf::RepeatedPtrField< ::std::string>& cache_key_metadata() const;
+  ::google::protobuf::RepeatedPtrField< ::std::string>* mutable_cache_key_metadata();
+
+  // bool single_flight = 7;
+  void clear_single_flight();
+  static const int kSingleFlightFieldNumber = 7;
+  bool single_flight() const;
+  void set_single_flight(bool value);
+
+  // .io.rsocket.rpc.RSocketCompression compression = 8;
+  void clear_compression();
+  static const int kCompressionFieldNumber = 8;
+  ::io::rsocket::rpc::RSocketCompression compression() const;
+  void set_compression(::io::rsocket::rpc::RSocketCompression value);
+
+  // uint32 compression_threshold = 9;
+  void clear_compression_threshold();
+  static const int kCompressionThresholdFieldNumber = 9;
+  ::google::protobuf::uint32 compression_threshold() const;
+  void set_compression_threshold(::google::protobuf::uint32 value);
+
+  // uint32 compression_max_bytes = 18;
+  void clear_compression_max_bytes();
+  static const int kCompressionMaxBytesFieldNumber = 18;
+  ::google::protobuf::uint32 compression_max_bytes() const;
+  void set_compression_max_bytes(::google::protobuf::uint32 value);
+
+  // bool pack = 10;
+  void clear_pack();
+  static const int kPackFieldNumber = 10;
+  bool pack() const;
+  void set_pack(bool value);
+
+  // uint32 pack_max_bytes = 11;
+  void clear_pack_max_bytes();
+  static const int kPackMaxBytesFieldNumber = 11;
+  ::google::protobuf::uint32 pack_max_bytes() const;
+  void set_pack_max_bytes(::google::protobuf::uint32 value);
+
+  // uint32 pack_linger_ms = 12;
+  void clear_pack_linger_ms();
+  static const int kPackLingerMsFieldNumber = 12;
+  ::google::protobuf::uint32 pack_linger_ms() const;
+  void set_pack_linger_ms(::google::protobuf::uint32 value);
+
+  // bool chunked = 13;
+  void clear_chunked();
+  static const int kChunkedFieldNumber = 13;
+  bool chunked() const;
+  void set_chunked(bool value);
+
+  // uint32 chunk_size = 14;
+  void clear_chunk_size();
+  static const int kChunkSizeFieldNumber = 14;
+  ::google::protobuf::uint32 chunk_size() const;
+  void set_chunk_size(::google::protobuf::uint32 value);
+
+  // uint32 chunk_max_bytes = 19;
+  void clear_chunk_max_bytes();
+  static const int kChunkMaxBytesFieldNumber = 19;
+  ::google::protobuf::uint32 chunk_max_bytes() const;
+  void set_chunk_max_bytes(::google::protobuf::uint32 value);
+
+  // bool offload = 15;
+  void clear_offload();
+  static const int kOffloadFieldNumber = 15;
+  bool offload() const;
+  void set_offload(bool value);
+
+  // .io.rsocket.rpc.RSocketPriority priority = 16;
+  void clear_priority();
+  static const int kPriorityFieldNumber = 16;
+  ::io::rsocket::rpc::RSocketPriority priority() const;
+  void set_priority(::io::rsocket::rpc::RSocketPriority value);
+
   // @@protoc_insertion_point(class_scope:io.rsocket.rpc.RSocketMethodOptions)
  private:
 
   ::google::protobuf::internal::InternalMetadataWithArena _internal_metadata_;
+  ::google::protobuf::RepeatedPtrField< ::std::string> cache_key_metadata_;
+  ::google::protobuf::uint32 hedge_after_ms_;
+  ::google::protobuf::uint32 cache_ttl_ms_;
+  ::google::protobuf::uint32 cache_max_entries_;
+  int compression_;
+  ::google::protobuf::uint32 compression_threshold_;
+  ::google::protobuf::uint32 compression_max_bytes_;
+  ::google::protobuf::uint32 pack_max_bytes_;
+  ::google::protobuf::uint32 pack_linger_ms_;
+  ::google::protobuf::uint32 chunk_size_;
+  ::google::protobuf::uint32 chunk_max_bytes_;
+  int priority_;
   bool fire_and_forget_;
+  bool idempotent_;
+  bool cacheable_;
+  bool single_flight_;
+  bool pack_;
+  bool chunked_;
+  bool offload_;
   mutable ::google::protobuf::internal::CachedSize _cached_size_;
   friend struct ::protobuf_rsocket_2foptions_2eproto::TableStruct;
 };
@@ -162,6 +458,10 @@ static const int kOptionsFieldNumber = 1057;
 extern ::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::MethodOptions,
     ::google::protobuf::internal::MessageTypeTraits< ::io::rsocket::rpc::RSocketMethodOptions >, 11, false >
   options;
+static const int kServiceOptionsFieldNumber = 1057;
+extern ::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::ServiceOptions,
+    ::google::protobuf::internal::MessageTypeTraits< ::io::rsocket::rpc::RSocketServiceOptions >, 11, false >
+  service_options;
 
 // ===================================================================
 
@@ -169,6 +469,24 @@ extern ::google::protobuf::internal::ExtensionIdentifier< ::google::protobuf::Me
   #pragma GCC diagnostic push
   #pragma GCC diagnostic ignored "-Wstrict-aliasing"
 #endif  // __GNUC__
+// RSocketServiceOptions
+
+// .io.rsocket.rpc.RSocketPriority priority = 1;
+inline void RSocketServiceOptions::clear_priority() {
+  priority_ = 0;
+}
+inline ::io::rsocket::rpc::RSocketPriority RSocketServiceOptions::priority() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketServiceOptions.priority)
+  return static_cast< ::io::rsocket::rpc::RSocketPriority >(priority_);
+}
+inline void RSocketServiceOptions::set_priority(::io::rsocket::rpc::RSocketPriority value) {
+  
+  priority_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketServiceOptions.priority)
+}
+
+// -------------------------------------------------------------------
+
 // RSocketMethodOptions
 
 // bool fire_and_forget = 1;
@@ -185,9 +503,318 @@ inline void RSocketMethodOptions::set_fire_and_forget(bool value) {
   // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.fire_and_forget)
 }
 
+// bool idempotent = 2;
+inline void RSocketMethodOptions::clear_idempotent() {
+  idempotent_ = false;
+}
+inline bool RSocketMethodOptions::idempotent() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.idempotent)
+  return idempotent_;
+}
+inline void RSocketMethodOptions::set_idempotent(bool value) {
+  
+  idempotent_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.idempotent)
+}
+
+// uint32 hedge_after_ms = 3;
+inline void RSocketMethodOptions::clear_hedge_after_ms() {
+  hedge_after_ms_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::hedge_after_ms() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.hedge_after_ms)
+  return hedge_after_ms_;
+}
+inline void RSocketMethodOptions::set_hedge_after_ms(::google::protobuf::uint32 value) {
+  
+  hedge_after_ms_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.hedge_after_ms)
+}
+
+// bool cacheable = 4;
+inline void RSocketMethodOptions::clear_cacheable() {
+  cacheable_ = false;
+}
+inline bool RSocketMethodOptions::cacheable() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.cacheable)
+  return cacheable_;
+}
+inline void RSocketMethodOptions::set_cacheable(bool value) {
+  
+  cacheable_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.cacheable)
+}
+
+// uint32 cache_ttl_ms = 5;
+inline void RSocketMethodOptions::clear_cache_ttl_ms() {
+  cache_ttl_ms_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::cache_ttl_ms() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.cache_ttl_ms)
+  return cache_ttl_ms_;
+}
+inline void RSocketMethodOptions::set_cache_ttl_ms(::google::protobuf::uint32 value) {
+  
+  cache_ttl_ms_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.cache_ttl_ms)
+}
+
+// uint32 cache_max_entries = 6;
+inline void RSocketMethodOptions::clear_cache_max_entries() {
+  cache_max_entries_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::cache_max_entries() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.cache_max_entries)
+  return cache_max_entries_;
+}
+inline void RSocketMethodOptions::set_cache_max_entries(::google::protobuf::uint32 value) {
+  
+  cache_max_entries_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.cache_max_entries)
+}
+
+// repeated string cache_key_metadata = 17;
+inline int RSocketMethodOptions::cache_key_metadata_size() const {
+  return cache_key_metadata_.size();
+}
+inline void RSocketMethodOptions::clear_cache_key_metadata() {
+  cache_key_metadata_.Clear();
+}
+inline const ::std::string& RSocketMethodOptions::cache_key_metadata(int index) const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+  return cache_key_metadata_.Get(index);
+}
+inline ::std::string* RSocketMethodOptions::mutable_cache_key_metadata(int index) {
+  // @@protoc_insertion_point(field_mutable:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+  return cache_key_metadata_.Mutable(index);
+}
+inline void RSocketMethodOptions::set_cache_key_metadata(int index, const ::std::string& value) {
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+  cache_key_metadata_.Mutable(index)->assign(value);
+}
+#if LANG_CXX11
+inline void RSocketMethodOptions::set_cache_key_metadata(int index, ::std::string&& value) {
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+  cache_key_metadata_.Mutable(index)->assign(std::move(value));
+}
+#endif
+inline void RSocketMethodOptions::set_cache_key_metadata(int index, const char* value) {
+  GOOGLE_DCHECK(value != NULL);
+  cache_key_metadata_.Mutable(index)->assign(value);
+  // @@protoc_insertion_point(field_set_char:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+}
+inline void RSocketMethodOptions::set_cache_key_metadata(int index, const char* value, size_t size) {
+  cache_key_metadata_.Mutable(index)->assign(
+    reinterpret_cast<const char*>(value), size);
+  // @@protoc_insertion_point(field_set_pointer:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+}
+inline ::std::string* RSocketMethodOptions::add_cache_key_metadata() {
+  // @@protoc_insertion_point(field_add_mutable:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+  return cache_key_metadata_.Add();
+}
+inline void RSocketMethodOptions::add_cache_key_metadata(const ::std::string& value) {
+  cache_key_metadata_.Add()->assign(value);
+  // @@protoc_insertion_point(field_add:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+}
+#if LANG_CXX11
+inline void RSocketMethodOptions::add_cache_key_metadata(::std::string&& value) {
+  cache_key_metadata_.Add(std::move(value));
+  // @@protoc_insertion_point(field_add:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+}
+#endif
+inline void RSocketMethodOptions::add_cache_key_metadata(const char* value) {
+  GOOGLE_DCHECK(value != NULL);
+  cache_key_metadata_.Add()->assign(value);
+  // @@protoc_insertion_point(field_add_char:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+}
+inline void RSocketMethodOptions::add_cache_key_metadata(const char* value, size_t size) {
+  cache_key_metadata_.Add()->assign(reinterpret_cast<const char*>(value), size);
+  // @@protoc_insertion_point(field_add_pointer:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+}
+inline const ::google::protobuf::RepeatedPtrField< ::std::string>&
+RSocketMethodOptions::cache_key_metadata() const {
+  // @@protoc_insertion_point(field_list:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+  return cache_key_metadata_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::std::string>*
+RSocketMethodOptions::mutable_cache_key_metadata() {
+  // @@protoc_insertion_point(field_mutable_list:io.rsocket.rpc.RSocketMethodOptions.cache_key_metadata)
+  return &cache_key_metadata_;
+}
+
+// bool single_flight = 7;
+inline void RSocketMethodOptions::clear_single_flight() {
+  single_flight_ = false;
+}
+inline bool RSocketMethodOptions::single_flight() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.single_flight)
+  return single_flight_;
+}
+inline void RSocketMethodOptions::set_single_flight(bool value) {
+  
+  single_flight_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.single_flight)
+}
+
+// .io.rsocket.rpc.RSocketCompression compression = 8;
+inline void RSocketMethodOptions::clear_compression() {
+  compression_ = 0;
+}
+inline ::io::rsocket::rpc::RSocketCompression RSocketMethodOptions::compression() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.compression)
+  return static_cast< ::io::rsocket::rpc::RSocketCompression >(compression_);
+}
+inline void RSocketMethodOptions::set_compression(::io::rsocket::rpc::RSocketCompression value) {
+  
+  compression_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.compression)
+}
+
+// uint32 compression_threshold = 9;
+inline void RSocketMethodOptions::clear_compression_threshold() {
+  compression_threshold_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::compression_threshold() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.compression_threshold)
+  return compression_threshold_;
+}
+inline void RSocketMethodOptions::set_compression_threshold(::google::protobuf::uint32 value) {
+  
+  compression_threshold_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.compression_threshold)
+}
+
+// uint32 compression_max_bytes = 18;
+inline void RSocketMethodOptions::clear_compression_max_bytes() {
+  compression_max_bytes_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::compression_max_bytes() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.compression_max_bytes)
+  return compression_max_bytes_;
+}
+inline void RSocketMethodOptions::set_compression_max_bytes(::google::protobuf::uint32 value) {
+  
+  compression_max_bytes_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.compression_max_bytes)
+}
+
+// bool pack = 10;
+inline void RSocketMethodOptions::clear_pack() {
+  pack_ = false;
+}
+inline bool RSocketMethodOptions::pack() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.pack)
+  return pack_;
+}
+inline void RSocketMethodOptions::set_pack(bool value) {
+  
+  pack_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.pack)
+}
+
+// uint32 pack_max_bytes = 11;
+inline void RSocketMethodOptions::clear_pack_max_bytes() {
+  pack_max_bytes_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::pack_max_bytes() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.pack_max_bytes)
+  return pack_max_bytes_;
+}
+inline void RSocketMethodOptions::set_pack_max_bytes(::google::protobuf::uint32 value) {
+  
+  pack_max_bytes_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.pack_max_bytes)
+}
+
+// uint32 pack_linger_ms = 12;
+inline void RSocketMethodOptions::clear_pack_linger_ms() {
+  pack_linger_ms_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::pack_linger_ms() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.pack_linger_ms)
+  return pack_linger_ms_;
+}
+inline void RSocketMethodOptions::set_pack_linger_ms(::google::protobuf::uint32 value) {
+  
+  pack_linger_ms_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.pack_linger_ms)
+}
+
+// bool chunked = 13;
+inline void RSocketMethodOptions::clear_chunked() {
+  chunked_ = false;
+}
+inline bool RSocketMethodOptions::chunked() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.chunked)
+  return chunked_;
+}
+inline void RSocketMethodOptions::set_chunked(bool value) {
+  
+  chunked_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.chunked)
+}
+
+// uint32 chunk_size = 14;
+inline void RSocketMethodOptions::clear_chunk_size() {
+  chunk_size_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::chunk_size() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.chunk_size)
+  return chunk_size_;
+}
+inline void RSocketMethodOptions::set_chunk_size(::google::protobuf::uint32 value) {
+  
+  chunk_size_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.chunk_size)
+}
+
+// uint32 chunk_max_bytes = 19;
+inline void RSocketMethodOptions::clear_chunk_max_bytes() {
+  chunk_max_bytes_ = 0u;
+}
+inline ::google::protobuf::uint32 RSocketMethodOptions::chunk_max_bytes() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.chunk_max_bytes)
+  return chunk_max_bytes_;
+}
+inline void RSocketMethodOptions::set_chunk_max_bytes(::google::protobuf::uint32 value) {
+  
+  chunk_max_bytes_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.chunk_max_bytes)
+}
+
+// bool offload = 15;
+inline void RSocketMethodOptions::clear_offload() {
+  offload_ = false;
+}
+inline bool RSocketMethodOptions::offload() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.offload)
+  return offload_;
+}
+inline void RSocketMethodOptions::set_offload(bool value) {
+  
+  offload_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.offload)
+}
+
+// .io.rsocket.rpc.RSocketPriority priority = 16;
+inline void RSocketMethodOptions::clear_priority() {
+  priority_ = 0;
+}
+inline ::io::rsocket::rpc::RSocketPriority RSocketMethodOptions::priority() const {
+  // @@protoc_insertion_point(field_get:io.rsocket.rpc.RSocketMethodOptions.priority)
+  return static_cast< ::io::rsocket::rpc::RSocketPriority >(priority_);
+}
+inline void RSocketMethodOptions::set_priority(::io::rsocket::rpc::RSocketPriority value) {
+  
+  priority_ = value;
+  // @@protoc_insertion_point(field_set:io.rsocket.rpc.RSocketMethodOptions.priority)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
+// -------------------------------------------------------------------
+
 
 // @@protoc_insertion_point(namespace_scope)
 
@@ -195,6 +822,23 @@ inline void RSocketMethodOptions::set_fire_and_forget(bool value) {
 }  // namespace rsocket
 }  // namespace io
 
+namespace google {
+namespace protobuf {
+
+template <> struct is_proto_enum< ::io::rsocket::rpc::RSocketCompression> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::io::rsocket::rpc::RSocketCompression>() {
+  return ::io::rsocket::rpc::RSocketCompression_descriptor();
+}
+template <> struct is_proto_enum< ::io::rsocket::rpc::RSocketPriority> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::io::rsocket::rpc::RSocketPriority>() {
+  return ::io::rsocket::rpc::RSocketPriority_descriptor();
+}
+
+}  // namespace protobuf
+}  // namespace google
+
 // @@protoc_insertion_point(global_scope)
 
 #endif  // PROTOBUF_INCLUDED_rsocket_2foptions_2eproto